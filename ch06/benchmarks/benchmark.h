@@ -0,0 +1,339 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "common/logging.h"
+#include "common/macros.h"
+#include "common/perf_counters.h"
+#include "common/perf_utils.h"
+#include "common/time_utils.h"
+
+// Minimal micro-benchmark harness modelled on Google Benchmark - same `for(auto _ : state)` loop and command line flags,
+// and JSON output in the same schema so results from different builds can be diffed with the usual tooling.
+
+namespace Benchmarks
+{
+    // Prevent the compiler from optimizing away a value computed in the benchmark loop
+    template<typename T>
+    inline auto doNotOptimize(const T& value) noexcept {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    inline auto threadCpuNanos() noexcept -> Common::Nanos {
+        timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ts.tv_sec * Common::NANOS_TO_SECS + ts.tv_nsec;
+    }
+
+    inline auto steadyNanos() noexcept -> Common::Nanos {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Disables every Logger while in scope, for benchmarks of components which log each operation
+    struct ScopedLoggingDisabled {
+        ScopedLoggingDisabled() { Common::Logger::setEnabled(false); }
+        ~ScopedLoggingDisabled() { Common::Logger::setEnabled(true); }
+    };
+
+    // Passed to every benchmark function, runs a fixed number of timed iterations and accumulates real time, cpu time and TSC cycles
+    class State final {
+        public:
+            State(size_t iterations, const Common::PerfCounters* hw_counters) : iterations_(iterations), hw_counters_(hw_counters) {}
+
+            // Value of the loop variable in `for(auto _ : state)`, the user-provided destructor keeps unused-variable warnings quiet
+            struct Value {
+                ~Value() {}
+            };
+
+            struct Iterator {
+                State* state_ = nullptr;
+                size_t remaining_ = 0;
+
+                auto operator*() const noexcept { return Value{}; }
+                auto operator++() noexcept -> Iterator& { --remaining_; return *this; }
+                auto operator!=(const Iterator&) const noexcept -> bool {
+                    if(LIKELY(remaining_))
+                        return true;
+                    state_->pauseTiming();
+                    return false;
+                }
+            };
+
+            auto begin() noexcept {
+                resumeTiming();
+                return Iterator{this, iterations_};
+            }
+
+            auto end() noexcept {
+                return Iterator{this, 0};
+            }
+
+            // Loop variable of `for(auto batch : state.batches(batch_size))`, the number of iterations to run back to back in this batch
+            struct BatchIterator {
+                State* state_ = nullptr;
+                size_t remaining_ = 0;
+                size_t batch_size_ = 0;
+
+                auto operator*() const noexcept { return std::min(remaining_, batch_size_); }
+                auto operator++() noexcept -> BatchIterator& { remaining_ -= std::min(remaining_, batch_size_); return *this; }
+                auto operator!=(const BatchIterator&) const noexcept -> bool {
+                    if(LIKELY(remaining_))
+                        return true;
+                    state_->pauseTiming();
+                    return false;
+                }
+            };
+
+            struct Batches {
+                State* state_ = nullptr;
+                size_t batch_size_ = 0;
+
+                auto begin() noexcept {
+                    state_->resumeTiming();
+                    return BatchIterator{state_, state_->iterations_, batch_size_};
+                }
+
+                auto end() noexcept {
+                    return BatchIterator{state_, 0, batch_size_};
+                }
+            };
+
+            // Run the iterations in batches of up to batch_size, so state consumed by the benchmarked operation is restored with one
+            // pauseTiming() / resumeTiming() per batch instead of one per iteration. Results are still reported per iteration.
+            auto batches(size_t batch_size) noexcept {
+                ASSERT(batch_size, "Benchmark batch size cannot be 0.");
+                return Batches{this, batch_size};
+            }
+
+            // Exclude setup work inside the benchmark loop from the measurements. The TSC and the PMU counters are read innermost, next to
+            // each other, so the clock_gettime() calls for the real and cpu time never land inside their windows.
+            auto pauseTiming() noexcept -> void {
+                if(!running_)
+                    return;
+                const auto end_cycles = Common::rdtsc();
+                Common::PerfCounters::Values end_hw_values;
+                if(hw_counters_)
+                    hw_counters_->read(&end_hw_values);
+                const auto end_real_nanos = steadyNanos();
+                const auto end_cpu_nanos = threadCpuNanos();
+                running_ = false;
+
+                cycles_ += end_cycles - start_cycles_;
+                real_nanos_ += end_real_nanos - start_real_nanos_;
+                cpu_nanos_ += end_cpu_nanos - start_cpu_nanos_;
+                if(hw_counters_) {
+                    for(size_t i = 0; i < end_hw_values.size(); ++i)
+                        hw_values_[i] += end_hw_values[i] - start_hw_values_[i];
+                }
+            }
+
+            auto resumeTiming() noexcept -> void {
+                if(running_)
+                    return;
+                running_ = true;
+                start_cpu_nanos_ = threadCpuNanos();
+                start_real_nanos_ = steadyNanos();
+                if(hw_counters_)
+                    hw_counters_->read(&start_hw_values_);
+                start_cycles_ = Common::rdtsc();
+            }
+
+            // Overwrite the measured real time, used by multi-threaded benchmarks that time themselves
+            auto setRealNanos(Common::Nanos real_nanos) noexcept { real_nanos_ = real_nanos; }
+
+            auto skipWithError(const std::string& msg) { error_message_ = msg; }
+
+            auto iterations() const noexcept { return iterations_; }
+
+            // User defined counters reported with the results, per iteration values are the caller's responsibility
+            std::map<std::string, double> counters_;
+
+        private:
+            friend class BenchmarkRunner;
+
+            const size_t iterations_;
+            bool running_ = false;
+            Common::Nanos start_real_nanos_ = 0, start_cpu_nanos_ = 0;
+            uint64_t start_cycles_ = 0;
+            Common::Nanos real_nanos_ = 0, cpu_nanos_ = 0;
+            uint64_t cycles_ = 0;
+            std::string error_message_;
+
+            const Common::PerfCounters* hw_counters_ = nullptr;
+            Common::PerfCounters::Values start_hw_values_ = {}, hw_values_ = {};
+    };
+
+    struct BenchmarkResult {
+        std::string name_;
+        size_t iterations_ = 0;
+        double real_nanos_ = 0, cpu_nanos_ = 0, cycles_ = 0; // per iteration
+        std::map<std::string, double> counters_;
+        std::string error_message_;
+    };
+
+    class BenchmarkRunner final {
+        public:
+            // Register a benchmark to run for a fixed number of iterations. The iteration count is fixed rather than time based because most of the
+            // components measured here (pools, queues, books) have bounded capacity.
+            auto add(const std::string& name, size_t iterations, std::function<void(State&)> func) -> void {
+                benchmarks_.push_back({name, iterations, std::move(func)});
+            }
+
+            // Supports --benchmark_filter=<regex>, --benchmark_format=<console|json|csv> and --benchmark_out=<file> (always JSON)
+            auto run(int argc, char** argv) -> int {
+                std::string filter = ".", format = "console", out_file;
+                for(int i = 1; i < argc; ++i) {
+                    const std::string arg = argv[i];
+                    if(arg.rfind("--benchmark_filter=", 0) == 0)
+                        filter = arg.substr(sizeof("--benchmark_filter=") - 1);
+                    else if(arg.rfind("--benchmark_format=", 0) == 0)
+                        format = arg.substr(sizeof("--benchmark_format=") - 1);
+                    else if(arg.rfind("--benchmark_out=", 0) == 0)
+                        out_file = arg.substr(sizeof("--benchmark_out=") - 1);
+                    else {
+                        std::cerr << "USAGE " << argv[0] << " [--benchmark_filter=<regex>] [--benchmark_format=<console|json|csv>] [--benchmark_out=<file>]" << std::endl;
+                        return EXIT_FAILURE;
+                    }
+                }
+
+                const Common::PerfCounters hw_counters;
+                if(!hw_counters.error().empty())
+                    std::cerr << "Some hardware counters are unavailable and will not be reported: " << hw_counters.error() << std::endl;
+
+                const std::regex filter_re(filter);
+                std::vector<BenchmarkResult> results;
+                for(auto& benchmark: benchmarks_) {
+                    if(!std::regex_search(benchmark.name_, filter_re))
+                        continue;
+
+                    State state(benchmark.iterations_, hw_counters.anyAvailable() ? &hw_counters : nullptr);
+                    benchmark.func_(state);
+                    state.pauseTiming();
+
+                    BenchmarkResult result{benchmark.name_, state.iterations_,
+                                        static_cast<double>(state.real_nanos_) / state.iterations_,
+                                        static_cast<double>(state.cpu_nanos_) / state.iterations_,
+                                        static_cast<double>(state.cycles_) / state.iterations_,
+                                        state.counters_, state.error_message_};
+                    // Prefixed, so the PMU cycle count is not confused with the TSC cycles reported for every benchmark
+                    for(size_t i = 0; i < Common::PerfCounters::NUM_COUNTERS; ++i) {
+                        const auto counter = static_cast<Common::PerfCounters::Counter>(i);
+                        if(hw_counters.available(counter))
+                            result.counters_["hw_" + Common::PerfCounters::counterName(counter)] = static_cast<double>(state.hw_values_[i]) / state.iterations_;
+                    }
+                    if(format == "console")
+                        writeConsole(std::cout, result, results.empty());
+                    results.push_back(result);
+                }
+
+                if(format == "json")
+                    writeJson(std::cout, results);
+                else if(format == "csv")
+                    writeCsv(std::cout, results);
+
+                if(!out_file.empty()) {
+                    std::ofstream out(out_file);
+                    ASSERT(out.is_open(), "Could not open benchmark output file:" + out_file);
+                    writeJson(out, results);
+                }
+
+                return EXIT_SUCCESS;
+            }
+
+        private:
+            struct Benchmark {
+                std::string name_;
+                size_t iterations_ = 0;
+                std::function<void(State&)> func_;
+            };
+            std::vector<Benchmark> benchmarks_;
+
+            static auto writeConsole(std::ostream& os, const BenchmarkResult& result, bool header) -> void {
+                if(header) {
+                    os << std::left << std::setw(72) << "Benchmark" << std::right << std::setw(14) << "Time(ns)" << std::setw(14) << "CPU(ns)"
+                       << std::setw(14) << "Cycles" << std::setw(12) << "Iterations" << std::endl
+                       << std::string(126, '-') << std::endl;
+                }
+
+                os << std::left << std::setw(72) << result.name_ << std::right;
+                if(!result.error_message_.empty()) {
+                    os << " ERROR: " << result.error_message_ << std::endl;
+                    return;
+                }
+                os << std::fixed << std::setprecision(2) << std::setw(14) << result.real_nanos_ << std::setw(14) << result.cpu_nanos_
+                   << std::setw(14) << result.cycles_ << std::setw(12) << result.iterations_;
+                for(const auto& [name, value]: result.counters_)
+                    os << " " << name << "=" << value;
+                os << std::endl;
+            }
+
+            static auto writeJson(std::ostream& os, const std::vector<BenchmarkResult>& results) -> void {
+                char host_name[256] = {'\0'};
+                gethostname(host_name, sizeof(host_name) - 1);
+                std::string time_str;
+
+                os << "{" << std::endl
+                   << "  \"context\": {" << std::endl
+                   << "    \"date\": \"" << Common::getCurrentTimeStr(&time_str).c_str() << "\"," << std::endl
+                   << "    \"host_name\": \"" << host_name << "\"," << std::endl
+                   << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "," << std::endl
+#ifdef NDEBUG
+                   << "    \"library_build_type\": \"release\"" << std::endl
+#else
+                   << "    \"library_build_type\": \"debug\"" << std::endl
+#endif
+                   << "  }," << std::endl
+                   << "  \"benchmarks\": [" << std::endl;
+
+                for(size_t i = 0; i < results.size(); ++i) {
+                    const auto& result = results[i];
+                    os << "    {" << std::endl
+                       << "      \"name\": \"" << result.name_ << "\"," << std::endl
+                       << "      \"run_name\": \"" << result.name_ << "\"," << std::endl
+                       << "      \"run_type\": \"iteration\"," << std::endl;
+                    if(!result.error_message_.empty()) {
+                        os << "      \"error_occurred\": true," << std::endl
+                           << "      \"error_message\": \"" << result.error_message_ << "\"" << std::endl;
+                    } else {
+                        os << std::setprecision(6) << std::fixed
+                           << "      \"iterations\": " << result.iterations_ << "," << std::endl
+                           << "      \"real_time\": " << result.real_nanos_ << "," << std::endl
+                           << "      \"cpu_time\": " << result.cpu_nanos_ << "," << std::endl
+                           << "      \"cycles\": " << result.cycles_ << ",";
+                        for(const auto& [name, value]: result.counters_)
+                            os << std::endl << "      \"" << name << "\": " << value << ",";
+                        os << std::endl << "      \"time_unit\": \"ns\"" << std::endl;
+                    }
+                    os << "    }" << (i + 1 < results.size() ? "," : "") << std::endl;
+                }
+
+                os << "  ]" << std::endl
+                   << "}" << std::endl;
+            }
+
+            static auto writeCsv(std::ostream& os, const std::vector<BenchmarkResult>& results) -> void {
+                os << "name,iterations,real_time,cpu_time,time_unit,cycles,counters,error_message" << std::endl;
+                for(const auto& result: results) {
+                    os << "\"" << result.name_ << "\"," << result.iterations_ << "," << std::fixed << std::setprecision(6)
+                       << result.real_nanos_ << "," << result.cpu_nanos_ << ",ns," << result.cycles_ << ",\"";
+                    for(const auto& [name, value]: result.counters_)
+                        os << name << "=" << value << " ";
+                    os << "\",\"" << result.error_message_ << "\"" << std::endl;
+                }
+            }
+    };
+} // namespace Benchmarks
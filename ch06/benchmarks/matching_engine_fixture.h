@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <thread>
+
+#include "common/lf_queue.h"
+#include "common/logging.h"
+
+#include "exchange/matcher/matching_engine.h"
+
+namespace Benchmarks
+{
+    // Give background logger threads time to flush, so the bounded log queues never overflow between benchmarks
+    inline auto waitForLoggers() {
+        using namespace std::literals::chrono_literals;
+        std::this_thread::sleep_for(200ms);
+    }
+
+    template<typename T>
+    inline auto drainQueue(Common::LFQueue<T>* queue) {
+        while(queue->size())
+            queue->updateReadIndex();
+    }
+
+    // MEOrderBook publishes through a MatchingEngine, which is constructed but never started so the benchmark thread owns its queues
+    struct MatchingEngineFixture {
+        Exchange::ClientRequestLFQueue client_requests_{ME_MAX_CLIENT_UPDATES};
+        Exchange::ClientResponseLFQueue client_responses_{ME_MAX_CLIENT_UPDATES};
+        Exchange::MEMarketUpdateLFQueue market_updates_{ME_MAX_MARKET_UPDATES};
+        Exchange::MatchingEngine matching_engine_{&client_requests_, &client_responses_, &market_updates_};
+        Common::Logger logger_;
+
+        explicit MatchingEngineFixture(const std::string& log_file) : logger_(log_file) {}
+
+        // Nothing consumes the outgoing queues, so benchmarks drain them outside the timed sections
+        auto drainQueues() {
+            drainQueue(&client_responses_);
+            drainQueue(&market_updates_);
+        }
+
+        auto newOrderBook(TickerId ticker_id) {
+            waitForLoggers();
+            drainQueues();
+            return std::make_unique<Exchange::MEOrderBook>(ticker_id, &logger_, &matching_engine_);
+        }
+    };
+}
@@ -0,0 +1,504 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <sstream>
+
+#include "benchmarks/benchmark.h"
+#include "benchmarks/matching_engine_fixture.h"
+
+#include "exchange/matcher/me_order_book.h"
+
+#include "trading/strategy/market_order_book.h"
+
+using namespace Common;
+
+namespace
+{
+    // How resting liquidity is laid out away from the top of the book
+    enum class PriceDistribution : int8_t {
+        DENSE = 0,  // one level on every tick, same queue length everywhere
+        SPARSE = 1, // every level is followed by 0 or 1 empty ticks, so adds also create levels in the middle of the book
+        PYRAMID = 2 // one level on every tick, queue length grows linearly from the top of the book to the last level
+    };
+
+    inline auto priceDistributionToString(PriceDistribution distribution) -> std::string {
+        switch(distribution) {
+            case PriceDistribution::DENSE: return "dense";
+            case PriceDistribution::SPARSE: return "sparse";
+            case PriceDistribution::PYRAMID: return "pyramid";
+        }
+        return "UNKNOWN";
+    }
+
+    inline auto stringToPriceDistribution(const std::string& str) -> PriceDistribution {
+        for(auto distribution: {PriceDistribution::DENSE, PriceDistribution::SPARSE, PriceDistribution::PYRAMID})
+            if(str == priceDistributionToString(distribution))
+                return distribution;
+        FATAL("Unknown price distribution:" + str);
+        return PriceDistribution::DENSE;
+    }
+
+    struct BookShape {
+        size_t levels_ = 0;
+        size_t orders_per_level_ = 0;
+        PriceDistribution distribution_ = PriceDistribution::DENSE;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "levels:" << levels_ << "/orders:" << orders_per_level_ << "/" << priceDistributionToString(distribution_);
+            return ss.str();
+        }
+
+        auto operator==(const BookShape& other) const noexcept {
+            return levels_ == other.levels_ && orders_per_level_ == other.orders_per_level_ && distribution_ == other.distribution_;
+        }
+    };
+
+    // Resting orders of one price level in FIFO order, kept in sync with the books so every benchmark can restore the initial shape
+    struct LevelLayout {
+        Side side_ = Side::INVALID;
+        Price price_ = Price_INVALID;
+        std::vector<std::pair<OrderId, Qty>> orders_;
+        // Orders at the back of orders_ picked by BookLayout::pickMiddle() for the current batch
+        size_t picked_ = 0;
+
+        auto totalQty() const noexcept {
+            Qty qty = 0;
+            for(const auto& order: orders_)
+                qty += order.second;
+            return qty;
+        }
+    };
+
+    // Bids and asks from the top of the book outwards, around an empty tick at MidPrice
+    struct BookLayout {
+        static constexpr Price MidPrice = 1000;
+
+        std::vector<LevelLayout> bids_, asks_;
+        OrderId spare_order_id_ = OrderId_INVALID; // this and the OrderIds after it never rest in the initial book, used for the add benchmarks
+
+        BookLayout(const BookShape& shape, std::mt19937_64* rng) {
+            OrderId order_id = 0;
+            for(auto side: {Side::BUY, Side::SELL}) {
+                auto& levels = (side == Side::BUY ? bids_ : asks_);
+                Price offset = 0;
+                for(size_t level = 0; level < shape.levels_; ++level) {
+                    offset += (shape.distribution_ == PriceDistribution::SPARSE && level ? 1 + (*rng)() % 2 : 1);
+                    LevelLayout level_layout{side, (side == Side::BUY ? MidPrice - offset : MidPrice + offset), {}};
+
+                    const auto num_orders = (shape.distribution_ == PriceDistribution::PYRAMID ?
+                                             std::max<size_t>(1, (shape.orders_per_level_ * (level + 1) + shape.levels_ - 1) / shape.levels_) :
+                                             shape.orders_per_level_);
+                    for(size_t i = 0; i < num_orders; ++i)
+                        level_layout.orders_.push_back({order_id++, static_cast<Qty>(1 + (*rng)() % 100)});
+                    levels.push_back(level_layout);
+                }
+            }
+            spare_order_id_ = order_id;
+        }
+
+        // Both sides share the price level hash map of the order books, which has ME_MAX_PRICE_LEVELS slots indexed by price modulo its size
+        auto fits() const noexcept {
+            const auto span = (bids_.empty() ? 0 : MidPrice - bids_.back().price_) + (asks_.empty() ? 0 : asks_.back().price_ - MidPrice);
+            return span < ME_MAX_PRICE_LEVELS;
+        }
+
+        // Random price between the best and worst price of a side, which may fall on an empty tick for sparse books
+        auto randomPassivePrice(Side side, std::mt19937_64* rng) const noexcept {
+            const auto& levels = (side == Side::BUY ? bids_ : asks_);
+            const auto span = (side == Side::BUY ? levels.front().price_ - levels.back().price_ : levels.back().price_ - levels.front().price_);
+            const auto offset = static_cast<Price>((*rng)() % (span + 1));
+            return (side == Side::BUY ? levels.front().price_ - offset : levels.front().price_ + offset);
+        }
+
+        auto randomLevel(std::mt19937_64* rng) noexcept -> LevelLayout& {
+            auto& levels = ((*rng)() & 1 ? bids_ : asks_);
+            return levels[(*rng)() % levels.size()];
+        }
+
+        // Order in the middle of a random level's queue, among the ones not picked for this batch yet, moved to the back of the queue
+        // as cancelling and re-adding it does. The caller resets picked_ of the level once it has done that to the books.
+        auto pickMiddle(std::mt19937_64* rng) noexcept -> std::pair<LevelLayout*, std::pair<OrderId, Qty>> {
+            while(true) {
+                auto& level = randomLevel(rng);
+                const auto unpicked = level.orders_.size() - level.picked_;
+                if(!unpicked)
+                    continue;
+
+                const auto middle = level.orders_.begin() + unpicked / 2;
+                const auto order = *middle;
+                level.orders_.erase(middle);
+                level.orders_.push_back(order);
+                ++level.picked_;
+                return {&level, order};
+            }
+        }
+    };
+
+    constexpr ClientId RestingClientId = 1;
+    constexpr ClientId BenchmarkClientId = 2;
+    constexpr TickerId BenchmarkTickerId = 0;
+
+    // Exchange and trading side books built from the same layout. Re-created whenever the benchmarked shape changes, since MEOrderBook is far
+    // too large to keep one per shape alive.
+    class BookFixture final {
+        public:
+            explicit BookFixture(const BookShape& shape)
+                : shape_(shape), rng_(1), layout_(shape, &rng_),
+                  trading_logger_("benchmark_order_book_trading.log") {
+                if(!layout_.fits())
+                    return;
+
+                me_order_book_ = exchange()->newOrderBook(BenchmarkTickerId);
+                market_order_book_ = std::make_unique<Trading::MarketOrderBook>(BenchmarkTickerId, &trading_logger_);
+
+                for(const auto* levels: {&layout_.bids_, &layout_.asks_})
+                    for(const auto& level: *levels)
+                        addLevel(level);
+
+                exchange()->drainQueues();
+            }
+
+            auto shape() const noexcept -> const BookShape& { return shape_; }
+
+            // Returns an error message for shapes the books cannot hold, empty otherwise
+            auto error() const -> std::string {
+                return layout_.fits() ? "" : "book shape spans more than ME_MAX_PRICE_LEVELS ticks";
+            }
+
+            auto rng() noexcept { return &rng_; }
+            auto layout() noexcept { return &layout_; }
+            auto meOrderBook() noexcept { return me_order_book_.get(); }
+            auto marketOrderBook() noexcept { return market_order_book_.get(); }
+
+            // Add the orders of a level to both books in FIFO order
+            auto addLevel(const LevelLayout& level) -> void {
+                for(const auto& [order_id, qty]: level.orders_) {
+                    me_order_book_->add(RestingClientId, order_id, BenchmarkTickerId, level.side_, level.price_, qty);
+                    onMarketUpdate(Exchange::MarketUpdateType::ADD, order_id, level.side_, level.price_, qty);
+                }
+            }
+
+            auto onMarketUpdate(Exchange::MarketUpdateType type, OrderId order_id, Side side, Price price, Qty qty) noexcept -> void {
+                market_update_ = {type, order_id, BenchmarkTickerId, side, price, qty, Priority_INVALID};
+                market_order_book_->onMarketUpdate(&market_update_);
+            }
+
+            static auto exchange() -> Benchmarks::MatchingEngineFixture* {
+                static auto fixture = new Benchmarks::MatchingEngineFixture("benchmark_order_book_exchange.log");
+                return fixture;
+            }
+
+            // deleted copy & move constructors and assignment-operators
+            BookFixture() = delete;
+            BookFixture(const BookFixture&) = delete;
+            BookFixture(const BookFixture&&) = delete;
+            BookFixture &operator=(const BookFixture&) = delete;
+            BookFixture &operator=(const BookFixture&&) = delete;
+
+        private:
+            const BookShape shape_;
+            std::mt19937_64 rng_;
+            BookLayout layout_;
+            Logger trading_logger_;
+            std::unique_ptr<Exchange::MEOrderBook> me_order_book_;
+            std::unique_ptr<Trading::MarketOrderBook> market_order_book_;
+            Exchange::MEMarketUpdate market_update_;
+    };
+
+    auto fixtureFor(const BookShape& shape, Benchmarks::State& state) -> BookFixture* {
+        static std::unique_ptr<BookFixture> fixture;
+        if(!fixture || !(fixture->shape() == shape)) {
+            fixture.reset();
+            fixture = std::make_unique<BookFixture>(shape);
+        }
+
+        const auto error = fixture->error();
+        if(!error.empty()) {
+            state.skipWithError(error);
+            return nullptr;
+        }
+        return fixture.get();
+    }
+
+    // Operations timed back to back before the book is restored. At most a quarter of one side's resting orders, so the book stays close
+    // to its shape, and as many as that allows to amortize the pauseTiming() / resumeTiming() around every restore.
+    auto batchSizeFor(const BookShape& shape) -> size_t {
+        return std::clamp<size_t>(shape.levels_ * shape.orders_per_level_ / 4, 1, 256);
+    }
+
+    // Random side and passive price for every order of the next batch
+    auto drawPassiveOrders(BookLayout* layout, std::mt19937_64* rng, std::vector<std::pair<Side, Price>>* orders) {
+        for(auto& [side, price]: *orders) {
+            side = ((*rng)() & 1 ? Side::BUY : Side::SELL);
+            price = layout->randomPassivePrice(side, rng);
+        }
+    }
+
+    // Orders picked from the middle of their levels for the next batch
+    using MiddlePicks = std::vector<std::pair<LevelLayout*, std::pair<OrderId, Qty>>>;
+
+    auto drawMiddlePicks(BookLayout* layout, std::mt19937_64* rng, MiddlePicks* picks) {
+        for(auto& pick: *picks)
+            pick = layout->pickMiddle(rng);
+    }
+
+    // Passive orders at random prices inside the book, the level walk in addOrdersAtPrice() dominates when a price has no level yet
+    auto meAddPassive(Benchmarks::State& state, const BookShape& shape) {
+        auto fixture = fixtureFor(shape, state);
+        if(!fixture)
+            return;
+
+        auto layout = fixture->layout();
+        const auto spare_order_id = layout->spare_order_id_;
+        std::vector<std::pair<Side, Price>> orders(batchSizeFor(shape));
+        drawPassiveOrders(layout, fixture->rng(), &orders);
+        for(auto batch : state.batches(orders.size())) {
+            for(size_t i = 0; i < batch; ++i)
+                fixture->meOrderBook()->add(BenchmarkClientId, spare_order_id + i, BenchmarkTickerId, orders[i].first, orders[i].second, 10);
+
+            state.pauseTiming();
+            for(size_t i = 0; i < batch; ++i)
+                fixture->meOrderBook()->cancel(BenchmarkClientId, spare_order_id + i, BenchmarkTickerId);
+            BookFixture::exchange()->drainQueues();
+            drawPassiveOrders(layout, fixture->rng(), &orders);
+            state.resumeTiming();
+        }
+    }
+
+    // Aggressive buy for exactly the quantity resting on the first sweep_levels ask levels. It consumes them, so the book is restored
+    // after every sweep, which is long enough for the pause around it not to matter.
+    auto meAddAggressive(Benchmarks::State& state, const BookShape& shape, size_t sweep_levels) {
+        auto fixture = fixtureFor(shape, state);
+        if(!fixture)
+            return;
+        if(sweep_levels > shape.levels_) {
+            state.skipWithError("cannot sweep more levels than the book has");
+            return;
+        }
+
+        auto layout = fixture->layout();
+        Qty sweep_qty = 0;
+        size_t sweep_orders = 0;
+        for(size_t level = 0; level < sweep_levels; ++level) {
+            sweep_qty += layout->asks_[level].totalQty();
+            sweep_orders += layout->asks_[level].orders_.size();
+        }
+        const auto sweep_price = layout->asks_[sweep_levels - 1].price_;
+
+        for(auto _ : state) {
+            fixture->meOrderBook()->add(BenchmarkClientId, layout->spare_order_id_, BenchmarkTickerId, Side::BUY, sweep_price, sweep_qty);
+
+            state.pauseTiming();
+            for(size_t level = 0; level < sweep_levels; ++level) {
+                for(const auto& [order_id, qty]: layout->asks_[level].orders_) {
+                    fixture->meOrderBook()->add(RestingClientId, order_id, BenchmarkTickerId, Side::SELL, layout->asks_[level].price_, qty);
+                }
+            }
+            BookFixture::exchange()->drainQueues();
+            state.resumeTiming();
+        }
+        state.counters_["orders_filled"] = sweep_orders;
+    }
+
+    // Cancel orders in the middle of random levels' queues, then re-add them at the back of their queues. Picks the last batch did
+    // not use are cancelled and re-added as well, so the books stay in sync with the layout.
+    auto meCancelMiddle(Benchmarks::State& state, const BookShape& shape) {
+        auto fixture = fixtureFor(shape, state);
+        if(!fixture)
+            return;
+
+        MiddlePicks picks(batchSizeFor(shape));
+        drawMiddlePicks(fixture->layout(), fixture->rng(), &picks);
+        for(auto batch : state.batches(picks.size())) {
+            for(size_t i = 0; i < batch; ++i)
+                fixture->meOrderBook()->cancel(RestingClientId, picks[i].second.first, BenchmarkTickerId);
+
+            state.pauseTiming();
+            for(size_t i = 0; i < picks.size(); ++i) {
+                const auto& [level, order] = picks[i];
+                if(i >= batch)
+                    fixture->meOrderBook()->cancel(RestingClientId, order.first, BenchmarkTickerId);
+                fixture->meOrderBook()->add(RestingClientId, order.first, BenchmarkTickerId, level->side_, level->price_, order.second);
+                level->picked_ = 0;
+            }
+            BookFixture::exchange()->drainQueues();
+            drawMiddlePicks(fixture->layout(), fixture->rng(), &picks);
+            state.resumeTiming();
+        }
+        for(const auto& [level, order]: picks) { // drawn for a batch which never ran, put them back at the back of their levels
+            fixture->meOrderBook()->cancel(RestingClientId, order.first, BenchmarkTickerId);
+            fixture->meOrderBook()->add(RestingClientId, order.first, BenchmarkTickerId, level->side_, level->price_, order.second);
+            level->picked_ = 0;
+        }
+        BookFixture::exchange()->drainQueues();
+    }
+
+    auto mktAddPassive(Benchmarks::State& state, const BookShape& shape) {
+        auto fixture = fixtureFor(shape, state);
+        if(!fixture)
+            return;
+
+        auto layout = fixture->layout();
+        const auto spare_order_id = layout->spare_order_id_;
+        std::vector<std::pair<Side, Price>> orders(batchSizeFor(shape));
+        drawPassiveOrders(layout, fixture->rng(), &orders);
+        for(auto batch : state.batches(orders.size())) {
+            for(size_t i = 0; i < batch; ++i)
+                fixture->onMarketUpdate(Exchange::MarketUpdateType::ADD, spare_order_id + i, orders[i].first, orders[i].second, 10);
+
+            state.pauseTiming();
+            for(size_t i = 0; i < batch; ++i)
+                fixture->onMarketUpdate(Exchange::MarketUpdateType::CANCEL, spare_order_id + i, orders[i].first, orders[i].second, 10);
+            drawPassiveOrders(layout, fixture->rng(), &orders);
+            state.resumeTiming();
+        }
+    }
+
+    // Replays the TRADE + CANCEL updates the exchange publishes for an aggressive order sweeping sweep_levels ask levels, restored
+    // after every sweep like meAddAggressive()
+    auto mktSweep(Benchmarks::State& state, const BookShape& shape, size_t sweep_levels) {
+        auto fixture = fixtureFor(shape, state);
+        if(!fixture)
+            return;
+        if(sweep_levels > shape.levels_) {
+            state.skipWithError("cannot sweep more levels than the book has");
+            return;
+        }
+
+        auto layout = fixture->layout();
+        size_t sweep_orders = 0;
+        for(auto _ : state) {
+            sweep_orders = 0;
+            for(size_t level = 0; level < sweep_levels; ++level) {
+                const auto& level_layout = layout->asks_[level];
+                for(const auto& [order_id, qty]: level_layout.orders_) {
+                    fixture->onMarketUpdate(Exchange::MarketUpdateType::TRADE, OrderId_INVALID, Side::BUY, level_layout.price_, qty);
+                    fixture->onMarketUpdate(Exchange::MarketUpdateType::CANCEL, order_id, Side::SELL, level_layout.price_, qty);
+                    ++sweep_orders;
+                }
+            }
+
+            state.pauseTiming();
+            for(size_t level = 0; level < sweep_levels; ++level) {
+                const auto& level_layout = layout->asks_[level];
+                for(const auto& [order_id, qty]: level_layout.orders_) {
+                    fixture->onMarketUpdate(Exchange::MarketUpdateType::ADD, order_id, Side::SELL, level_layout.price_, qty);
+                }
+            }
+            state.resumeTiming();
+        }
+        state.counters_["updates_per_op"] = 2.0 * sweep_orders;
+    }
+
+    // Same as meCancelMiddle() on the trading side book
+    auto mktCancelMiddle(Benchmarks::State& state, const BookShape& shape) {
+        auto fixture = fixtureFor(shape, state);
+        if(!fixture)
+            return;
+
+        MiddlePicks picks(batchSizeFor(shape));
+        drawMiddlePicks(fixture->layout(), fixture->rng(), &picks);
+        for(auto batch : state.batches(picks.size())) {
+            for(size_t i = 0; i < batch; ++i) {
+                const auto& [level, order] = picks[i];
+                fixture->onMarketUpdate(Exchange::MarketUpdateType::CANCEL, order.first, level->side_, level->price_, order.second);
+            }
+
+            state.pauseTiming();
+            for(size_t i = 0; i < picks.size(); ++i) {
+                const auto& [level, order] = picks[i];
+                if(i >= batch)
+                    fixture->onMarketUpdate(Exchange::MarketUpdateType::CANCEL, order.first, level->side_, level->price_, order.second);
+                fixture->onMarketUpdate(Exchange::MarketUpdateType::ADD, order.first, level->side_, level->price_, order.second);
+                level->picked_ = 0;
+            }
+            drawMiddlePicks(fixture->layout(), fixture->rng(), &picks);
+            state.resumeTiming();
+        }
+        for(const auto& [level, order]: picks) { // drawn for a batch which never ran, put them back at the back of their levels
+            fixture->onMarketUpdate(Exchange::MarketUpdateType::CANCEL, order.first, level->side_, level->price_, order.second);
+            fixture->onMarketUpdate(Exchange::MarketUpdateType::ADD, order.first, level->side_, level->price_, order.second);
+            level->picked_ = 0;
+        }
+    }
+
+    // Recomputing both sides of the BBO walks the full order queue at the best bid and the best ask
+    auto mktUpdateBBO(Benchmarks::State& state, const BookShape& shape) {
+        auto fixture = fixtureFor(shape, state);
+        if(!fixture)
+            return;
+
+        for(auto _ : state) {
+            fixture->marketOrderBook()->updateBBO(true, true);
+            Benchmarks::doNotOptimize(fixture->marketOrderBook()->getBBO()->bid_qty_);
+        }
+        state.counters_["queue_length"] = fixture->layout()->bids_.front().orders_.size() + fixture->layout()->asks_.front().orders_.size();
+    }
+
+    // Splits a comma separated list of values
+    auto splitList(const std::string& list) {
+        std::vector<std::string> values;
+        std::stringstream ss(list);
+        for(std::string value; std::getline(ss, value, ',');)
+            values.push_back(value);
+        return values;
+    }
+
+    // Operations per benchmark, the sweeps restore the book after every operation and take much longer per operation
+    constexpr size_t BookOpIterations = 200'000;
+    constexpr size_t SweepIterations = 5'000;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> levels_list = {"10", "50"}, orders_list = {"1", "20"}, distribution_list = {"dense", "sparse"}, sweep_list = {"1", "5"};
+
+    // Book shape flags are consumed here, everything else is passed on to the benchmark runner
+    std::vector<char*> runner_args = {argv[0]};
+    for(int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if(arg.rfind("--levels=", 0) == 0)
+            levels_list = splitList(arg.substr(sizeof("--levels=") - 1));
+        else if(arg.rfind("--orders-per-level=", 0) == 0)
+            orders_list = splitList(arg.substr(sizeof("--orders-per-level=") - 1));
+        else if(arg.rfind("--distribution=", 0) == 0)
+            distribution_list = splitList(arg.substr(sizeof("--distribution=") - 1));
+        else if(arg.rfind("--sweep-levels=", 0) == 0)
+            sweep_list = splitList(arg.substr(sizeof("--sweep-levels=") - 1));
+        else
+            runner_args.push_back(argv[i]);
+    }
+
+    // The books and the MatchingEngine log every operation, which would otherwise be timed along with it
+    const Benchmarks::ScopedLoggingDisabled logging_disabled;
+
+    Benchmarks::BenchmarkRunner runner;
+    for(const auto& levels: levels_list) {
+        for(const auto& orders: orders_list) {
+            for(const auto& distribution: distribution_list) {
+                const BookShape shape{std::stoul(levels), std::stoul(orders), stringToPriceDistribution(distribution)};
+                ASSERT(shape.levels_ && shape.orders_per_level_, "Book shape needs at least one level and one order per level:" + shape.toString());
+                const auto name = [&shape](const std::string& benchmark) { return benchmark + "/" + shape.toString(); };
+
+                runner.add(name("MEOrderBook/add_passive"), BookOpIterations, [shape](auto& state) { meAddPassive(state, shape); });
+                runner.add(name("MEOrderBook/cancel_middle"), BookOpIterations, [shape](auto& state) { meCancelMiddle(state, shape); });
+                for(const auto& sweep: sweep_list) {
+                    const auto sweep_levels = std::stoul(sweep);
+                    runner.add(name("MEOrderBook/add_aggressive/sweep:" + sweep), SweepIterations,
+                               [shape, sweep_levels](auto& state) { meAddAggressive(state, shape, sweep_levels); });
+                }
+
+                runner.add(name("MarketOrderBook/add_passive"), BookOpIterations, [shape](auto& state) { mktAddPassive(state, shape); });
+                runner.add(name("MarketOrderBook/cancel_middle"), BookOpIterations, [shape](auto& state) { mktCancelMiddle(state, shape); });
+                for(const auto& sweep: sweep_list) {
+                    const auto sweep_levels = std::stoul(sweep);
+                    runner.add(name("MarketOrderBook/sweep:" + sweep), SweepIterations,
+                               [shape, sweep_levels](auto& state) { mktSweep(state, shape, sweep_levels); });
+                }
+                runner.add(name("MarketOrderBook/update_bbo"), BookOpIterations, [shape](auto& state) { mktUpdateBBO(state, shape); });
+            }
+        }
+    }
+
+    return runner.run(static_cast<int>(runner_args.size()), runner_args.data());
+}
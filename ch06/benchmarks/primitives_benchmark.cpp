@@ -0,0 +1,371 @@
+#include <algorithm>
+#include <map>
+#include <random>
+
+#include "benchmarks/benchmark.h"
+#include "benchmarks/matching_engine_fixture.h"
+
+#include "common/lf_queue.h"
+#include "common/mem_pool.h"
+#include "common/logging.h"
+#include "common/recv_buffer.h"
+#include "common/thread_utils.h"
+#include "common/time_utils.h"
+#include "trading/market_data/queued_market_updates.h"
+#include "exchange/market_data/mdp_sbe.h"
+#include "exchange/market_data/mdp_delta.h"
+#include "exchange/order_server/om_sbe.h"
+#include "trading/strategy/feature_engine.h"
+
+using namespace Common;
+using Benchmarks::waitForLoggers;
+
+namespace
+{
+    auto lfQueueSameCore(Benchmarks::State& state) {
+        LFQueue<Exchange::MEMarketUpdate> queue(1024);
+        Exchange::MEMarketUpdate update;
+
+        for(auto _ : state) {
+            *queue.getNextToWriteTo() = update;
+            queue.updateWriteIndex();
+
+            Benchmarks::doNotOptimize(*queue.getNextToRead());
+            queue.updateReadIndex();
+        }
+    }
+
+    // The calling thread consumes on one core while a producer thread writes from another
+    auto lfQueueCrossCore(Benchmarks::State& state) {
+        if(std::thread::hardware_concurrency() < 2) {
+            state.skipWithError("needs at least 2 cores");
+            return;
+        }
+
+        constexpr size_t capacity = 1024;
+        LFQueue<Exchange::MEMarketUpdate> queue(capacity);
+        std::atomic<bool> go(false);
+        const auto iterations = state.iterations();
+
+        cpu_set_t original_cpuset;
+        pthread_getaffinity_np(pthread_self(), sizeof(original_cpuset), &original_cpuset);
+        ASSERT(setThreadCore(0), "Failed to pin benchmark thread to core 0");
+
+        auto produce = [&]() {
+            Exchange::MEMarketUpdate update;
+            while(!go);
+            for(size_t i = 0; i < iterations; ++i) {
+                while(queue.size() >= capacity);
+                update.order_id_ = i;
+                *queue.getNextToWriteTo() = update;
+                queue.updateWriteIndex();
+            }
+        };
+        auto producer = createAndStartThread(1, "Benchmarks/LFQueueProducer", produce);
+
+        const auto start = Benchmarks::steadyNanos();
+        go = true;
+        for(auto _ : state) {
+            const Exchange::MEMarketUpdate* update = nullptr;
+            while(!(update = queue.getNextToRead()));
+            Benchmarks::doNotOptimize(update->order_id_);
+            queue.updateReadIndex();
+        }
+        state.setRealNanos(Benchmarks::steadyNanos() - start);
+
+        producer->join();
+        delete producer;
+        pthread_setaffinity_np(pthread_self(), sizeof(original_cpuset), &original_cpuset);
+    }
+
+    // Keep the pool at a constant occupancy with randomly placed free slots, so every allocate() scans past live blocks for the next free one
+    auto memPoolFragmented(Benchmarks::State& state, double fill_ratio) {
+        constexpr size_t pool_size = 64 * 1024;
+        MemPool<Exchange::MEOrder> pool(pool_size);
+        std::mt19937_64 rng(1);
+
+        // MemPool asserts as soon as it is full, so at least one block always stays free
+        std::vector<Exchange::MEOrder*> live;
+        for(size_t i = 0; i + 1 < pool_size; ++i)
+            live.push_back(pool.allocate());
+        std::shuffle(live.begin(), live.end(), rng);
+        while(live.size() > fill_ratio * pool_size) {
+            pool.deallocate(live.back());
+            live.pop_back();
+        }
+
+        std::vector<size_t> victims(state.iterations());
+        for(auto& victim: victims)
+            victim = live.empty() ? 0 : rng() % live.size();
+
+        size_t i = 0;
+        for(auto _ : state) {
+            auto order = pool.allocate();
+            if(LIKELY(!live.empty())) {
+                std::swap(order, live[victims[i++]]);
+            }
+            pool.deallocate(order);
+        }
+        state.counters_["fill_ratio"] = fill_ratio;
+    }
+
+    auto loggerLog(Benchmarks::State& state, Logger* logger) {
+        waitForLoggers();
+        size_t value = 0;
+        for(auto _ : state) {
+            logger->log("%:% %() Processing seq:% qty:% px:%\n", __FILE__, __LINE__, __FUNCTION__, ++value, 100u, 12.5);
+        }
+        waitForLoggers();
+    }
+
+    auto loggerLogWithTimeStr(Benchmarks::State& state, Logger* logger) {
+        waitForLoggers();
+        std::string time_str;
+        size_t value = 0;
+        for(auto _ : state) {
+            logger->log("%:% %() % Processing seq:% qty:% px:%\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str), ++value, 100u, 12.5);
+        }
+        waitForLoggers();
+    }
+
+    auto timeStr(Benchmarks::State& state) {
+        std::string time_str;
+        for(auto _ : state) {
+            Benchmarks::doNotOptimize(getCurrentTimeStr(&time_str).data());
+        }
+    }
+
+    auto currentNanos(Benchmarks::State& state) {
+        for(auto _ : state) {
+            Benchmarks::doNotOptimize(getCurrentNanos());
+        }
+    }
+
+    // Every read delivers 3.5 messages, as when segments split messages, and every whole message is parsed before the next read
+    constexpr size_t RECV_CHUNK_SIZE = 7 * sizeof(Exchange::MDPMarketUpdate) / 2;
+
+    auto recvBufferParse(Benchmarks::State& state) {
+        RecvBuffer buffer(64 * 1024);
+        const std::vector<char> chunk(RECV_CHUNK_SIZE, 1);
+
+        for(auto _ : state) {
+            memcpy(buffer.writePtr(), chunk.data(), chunk.size());
+            buffer.commit(chunk.size());
+            for(; buffer.readable() >= sizeof(Exchange::MDPMarketUpdate); buffer.consume(sizeof(Exchange::MDPMarketUpdate)))
+                Benchmarks::doNotOptimize(reinterpret_cast<const Exchange::MDPMarketUpdate*>(buffer.readPtr())->seq_num_);
+        }
+    }
+
+    // The linear buffer the receive paths used before RecvBuffer, moving the trailing partial message to the front after every parse
+    auto vectorCompactionParse(Benchmarks::State& state) {
+        std::vector<char> buffer(64 * 1024);
+        size_t valid = 0;
+        const std::vector<char> chunk(RECV_CHUNK_SIZE, 1);
+
+        for(auto _ : state) {
+            memcpy(buffer.data() + valid, chunk.data(), chunk.size());
+            valid += chunk.size();
+            size_t i = 0;
+            for(; i + sizeof(Exchange::MDPMarketUpdate) <= valid; i += sizeof(Exchange::MDPMarketUpdate))
+                Benchmarks::doNotOptimize(reinterpret_cast<const Exchange::MDPMarketUpdate*>(buffer.data() + i)->seq_num_);
+            memcpy(buffer.data(), buffer.data() + i, valid - i);
+            valid -= i;
+        }
+    }
+
+    // Incremental updates queued during a recovery of 4096 updates, with the check for a gap free run the consumer makes per update
+    constexpr size_t QUEUED_RECOVERY_UPDATES = 4096;
+
+    auto queuedMarketUpdates(Benchmarks::State& state) {
+        Trading::QueuedMarketUpdates queued(ME_MAX_MARKET_UPDATES);
+        const Exchange::MEMarketUpdate update;
+        size_t seq_num = 0;
+
+        for(auto _ : state) {
+            if(++seq_num % QUEUED_RECOVERY_UPDATES == 0)
+                queued.clear();
+            queued.insert(seq_num, update);
+            Benchmarks::doNotOptimize(queued.contiguousFrom());
+        }
+    }
+
+    // The std::map the consumer queued updates in before QueuedMarketUpdates, allocating per update and walking the map for gaps
+    auto queuedMarketUpdatesMapBaseline(Benchmarks::State& state) {
+        std::map<size_t, Exchange::MEMarketUpdate> queued;
+        const Exchange::MEMarketUpdate update;
+        size_t seq_num = 0;
+
+        for(auto _ : state) {
+            if(++seq_num % QUEUED_RECOVERY_UPDATES == 0)
+                queued.clear();
+            queued[seq_num] = update;
+            size_t next_seq_num = queued.begin()->first;
+            for(const auto& itr: queued) {
+                if(itr.first != next_seq_num++)
+                    break;
+            }
+            Benchmarks::doNotOptimize(next_seq_num);
+        }
+    }
+
+    // A packet's worth of ADDs without publish stamps, encoded back to back the way the packetizer lays them out
+    constexpr size_t SBE_PACKET_UPDATES = 32;
+
+    auto sbeMarketUpdates() {
+        std::vector<Exchange::MDPStampedMarketUpdate> updates(SBE_PACKET_UPDATES);
+        for(size_t i = 0; i < updates.size(); ++i)
+            updates[i] = {{i, {Exchange::MarketUpdateType::ADD, i, static_cast<TickerId>(i % 8), Side::BUY, 100 + i, 10, i}}};
+        return updates;
+    }
+
+    auto mdpSBEEncodeDecode(Benchmarks::State& state) {
+        const auto updates = sbeMarketUpdates();
+        std::vector<char> packet(SBE_PACKET_UPDATES * Exchange::MDPSBESchema::MAX_LENGTH);
+        Exchange::MDPStampedMarketUpdate decoded;
+
+        for(auto _ : state) {
+            size_t len = 0;
+            for(const auto& update: updates)
+                len += Exchange::sbeEncode(update, packet.data() + len);
+            for(size_t i = 0; i < len; i += Exchange::sbeDecode(packet.data() + i, len - i, &decoded))
+                Benchmarks::doNotOptimize(decoded.mdp_market_update_.seq_num_);
+        }
+    }
+
+    auto mdpDeltaEncodeDecode(Benchmarks::State& state) {
+        const auto updates = sbeMarketUpdates();
+        std::vector<char> packet(SBE_PACKET_UPDATES * Exchange::MDPDeltaCodec::MAX_LENGTH);
+        Exchange::MDPDeltaCodec encoder, decoder;
+        Exchange::MDPStampedMarketUpdate decoded;
+
+        for(auto _ : state) {
+            size_t len = 0;
+            encoder.reset();
+            for(const auto& update: updates)
+                len += encoder.encode(update, packet.data() + len);
+            decoder.reset();
+            for(size_t i = 0; i < len; i += decoder.decode(packet.data() + i, len - i, &decoded))
+                Benchmarks::doNotOptimize(decoded.mdp_market_update_.seq_num_);
+        }
+    }
+
+    // The raw structs memcpy'd in and read in place, what the RAW encoding does
+    auto mdpRawCopyBaseline(Benchmarks::State& state) {
+        std::vector<Exchange::MDPMarketUpdate> updates;
+        for(const auto& update: sbeMarketUpdates())
+            updates.push_back(update.mdp_market_update_);
+        std::vector<char> packet(SBE_PACKET_UPDATES * sizeof(Exchange::MDPMarketUpdate));
+
+        for(auto _ : state) {
+            memcpy(packet.data(), updates.data(), packet.size());
+            for(size_t i = 0; i < packet.size(); i += sizeof(Exchange::MDPMarketUpdate))
+                Benchmarks::doNotOptimize(reinterpret_cast<const Exchange::MDPMarketUpdate*>(packet.data() + i)->seq_num_);
+        }
+    }
+
+    // One BBO change and one trade per iteration, alternating the aggressor side so the trade flow features keep moving
+    auto featureEngineUpdate(Benchmarks::State& state) {
+        auto feature_engine = std::make_unique<Trading::FeatureEngine>();
+        Trading::BBO bbo{99, 101, 50, 70};
+        Exchange::MEMarketUpdate trade{Exchange::MarketUpdateType::TRADE, OrderId_INVALID, 0, Side::BUY, 101, 10, Priority_INVALID};
+
+        for(auto _ : state) {
+            bbo.bid_qty_ = 50 + (trade.qty_ & 15);
+            feature_engine->onOrderBookUpdate(trade.ticker_id_, &bbo);
+            trade.side_ = (trade.side_ == Side::BUY ? Side::SELL : Side::BUY);
+            trade.qty_ = 1 + (trade.qty_ * 7) % 31;
+            feature_engine->onTradeUpdate(&trade, &bbo);
+            Benchmarks::doNotOptimize(feature_engine->features(trade.ticker_id_)->vwap_);
+        }
+    }
+
+    auto omSBEEncodeDecode(Benchmarks::State& state) {
+        const Exchange::OMClientRequest request{1, {Exchange::ClientRequestType::NEW, 1, 2, 3, Side::SELL, 100, 10}, 0, 0, 12345};
+        char buffer[Exchange::OMSBESchema::MAX_LENGTH];
+        Exchange::OMClientRequest decoded;
+
+        for(auto _ : state) {
+            const auto len = Exchange::sbeEncode(request, buffer);
+            Benchmarks::doNotOptimize(Exchange::sbeDecode(buffer, len, &decoded));
+            Benchmarks::doNotOptimize(decoded.send_time_);
+        }
+    }
+
+    // Never destroyed, which keeps the teardown of the ME_MAX_TICKERS order books owned by the MatchingEngine out of the run
+    auto fixture() -> Benchmarks::MatchingEngineFixture* {
+        static auto fixture = new Benchmarks::MatchingEngineFixture("benchmark_me_order_book.log");
+        return fixture;
+    }
+
+    // Passive orders on both sides, spread over 50 price levels per side so adds hit both new and existing levels
+    auto addPassive(Exchange::MEOrderBook* order_book, OrderId order_id) {
+        const auto side = (order_id & 1 ? Side::BUY : Side::SELL);
+        const Price price = (side == Side::BUY ? 100 - order_id % 50 : 101 + order_id % 50);
+        order_book->add(1, order_id, 0, side, price, 10);
+    }
+
+    auto meOrderBookAdd(Benchmarks::State& state) {
+        const Benchmarks::ScopedLoggingDisabled logging_disabled;
+        auto order_book = fixture()->newOrderBook(0);
+        OrderId order_id = 0;
+        for(auto _ : state) {
+            addPassive(order_book.get(), ++order_id);
+        }
+    }
+
+    auto meOrderBookCancel(Benchmarks::State& state) {
+        const Benchmarks::ScopedLoggingDisabled logging_disabled;
+        auto order_book = fixture()->newOrderBook(0);
+        for(OrderId order_id = 1; order_id <= state.iterations(); ++order_id)
+            addPassive(order_book.get(), order_id);
+
+        OrderId order_id = 0;
+        for(auto _ : state) {
+            order_book->cancel(1, ++order_id, 0);
+        }
+    }
+
+    // Every aggressive order fully fills the order at the front of a deep single price level
+    auto meOrderBookMatch(Benchmarks::State& state) {
+        const Benchmarks::ScopedLoggingDisabled logging_disabled;
+        auto order_book = fixture()->newOrderBook(0);
+        for(OrderId order_id = 1; order_id <= state.iterations(); ++order_id)
+            order_book->add(1, order_id, 0, Side::SELL, 100, 1);
+
+        OrderId order_id = 0;
+        for(auto _ : state) {
+            order_book->add(2, ++order_id, 0, Side::BUY, 100, 1);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Logger logger("benchmark_logger.log");
+
+    Benchmarks::BenchmarkRunner runner;
+    runner.add("LFQueue/write_read/same_core", 10'000'000, lfQueueSameCore);
+    runner.add("LFQueue/write_read/cross_core", 10'000'000, lfQueueCrossCore);
+    runner.add("MemPool/allocate_deallocate/fill:0", 1'000'000, [](auto& state) { memPoolFragmented(state, 0.0); });
+    runner.add("MemPool/allocate_deallocate/fill:50", 1'000'000, [](auto& state) { memPoolFragmented(state, 0.5); });
+    runner.add("MemPool/allocate_deallocate/fill:90", 1'000'000, [](auto& state) { memPoolFragmented(state, 0.9); });
+    runner.add("MemPool/allocate_deallocate/fill:99", 100'000, [](auto& state) { memPoolFragmented(state, 0.99); });
+    // Iterations are bounded so the log lines produced never exceed LOG_QUEUE_SIZE before the logger thread drains them
+    runner.add("Logger/log", 20'000, [&logger](auto& state) { loggerLog(state, &logger); });
+    runner.add("Logger/log_with_time_str", 20'000, [&logger](auto& state) { loggerLogWithTimeStr(state, &logger); });
+    runner.add("RecvBuffer/recv_parse", 10'000'000, recvBufferParse);
+    runner.add("RecvBuffer/recv_parse_compaction_baseline", 10'000'000, vectorCompactionParse);
+    runner.add("QueuedMarketUpdates/queue_check", 1'000'000, queuedMarketUpdates);
+    runner.add("QueuedMarketUpdates/queue_check_map_baseline", 100'000, queuedMarketUpdatesMapBaseline);
+    runner.add("SBE/mdp_packet_encode_decode", 1'000'000, mdpSBEEncodeDecode);
+    runner.add("Delta/mdp_packet_encode_decode", 1'000'000, mdpDeltaEncodeDecode);
+    runner.add("SBE/mdp_packet_raw_copy_baseline", 1'000'000, mdpRawCopyBaseline);
+    runner.add("SBE/om_request_encode_decode", 10'000'000, omSBEEncodeDecode);
+    runner.add("FeatureEngine/book_and_trade_update", 10'000'000, featureEngineUpdate);
+    runner.add("Time/getCurrentTimeStr", 1'000'000, timeStr);
+    runner.add("Time/getCurrentNanos", 10'000'000, currentNanos);
+    runner.add("MEOrderBook/add_passive", 5'000, meOrderBookAdd);
+    runner.add("MEOrderBook/cancel", 5'000, meOrderBookCancel);
+    runner.add("MEOrderBook/match", 2'000, meOrderBookMatch);
+
+    return runner.run(argc, argv);
+}
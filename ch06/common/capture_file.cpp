@@ -0,0 +1,148 @@
+#include "capture_file.h"
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+
+namespace Common
+{
+    CaptureWriter::CaptureWriter(const std::string& path, size_t max_bytes) : max_bytes_(max_bytes) {
+        ASSERT(max_bytes_ >= sizeof(PcapFileHeader), "Capture of " + std::to_string(max_bytes_) + " bytes cannot hold the file header.");
+        fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        ASSERT(fd_ >= 0, "open() of capture file " + path + " failed. error:" + std::string(std::strerror(errno)));
+        // File blocks are allocated and the mapping populated up front, so writes never fault into the filesystem
+        ASSERT(posix_fallocate(fd_, 0, max_bytes_) == 0, "posix_fallocate() of capture file " + path + " failed.");
+        base_ = static_cast<char*>(mmap(nullptr, max_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, 0));
+        ASSERT(base_ != MAP_FAILED, "mmap() of capture file " + path + " failed. error:" + std::string(std::strerror(errno)));
+
+        const PcapFileHeader header;
+        memcpy(base_, &header, sizeof(header));
+        len_ = sizeof(header);
+    }
+
+    CaptureWriter::~CaptureWriter() {
+        close();
+    }
+
+    auto CaptureWriter::write(Nanos recv_time, in_addr_t group, in_port_t port, const void* data, size_t len) noexcept -> bool {
+        const auto record_len = sizeof(PcapRecordHeader) + CAPTURE_IP_UDP_HEADER_SIZE + len;
+        if(UNLIKELY(!base_ || len_ + record_len > max_bytes_ || CAPTURE_IP_UDP_HEADER_SIZE + len > 0xffff)) {
+            ++num_dropped_;
+            return false;
+        }
+
+        auto dst = base_ + len_;
+        const PcapRecordHeader record{static_cast<uint32_t>(recv_time / NANOS_TO_SECS), static_cast<uint32_t>(recv_time % NANOS_TO_SECS),
+                                      static_cast<uint32_t>(CAPTURE_IP_UDP_HEADER_SIZE + len), static_cast<uint32_t>(CAPTURE_IP_UDP_HEADER_SIZE + len)};
+        memcpy(dst, &record, sizeof(record));
+        dst += sizeof(record);
+
+        // The receiving socket does not see the source, the headers only carry what replay needs: the destination group and port
+        iphdr ip{};
+        ip.version = 4;
+        ip.ihl = 5;
+        ip.tot_len = htons(static_cast<uint16_t>(CAPTURE_IP_UDP_HEADER_SIZE + len));
+        ip.ttl = 1;
+        ip.protocol = IPPROTO_UDP;
+        ip.daddr = group;
+        uint32_t sum = 0;
+        uint16_t words[sizeof(ip) / 2];
+        memcpy(words, &ip, sizeof(ip));
+        for(auto word: words)
+            sum += word;
+        sum = (sum & 0xffff) + (sum >> 16);
+        ip.check = static_cast<uint16_t>(~(sum + (sum >> 16)));
+        memcpy(dst, &ip, sizeof(ip));
+        dst += sizeof(ip);
+
+        udphdr udp{};
+        udp.dest = port;
+        udp.len = htons(static_cast<uint16_t>(sizeof(udp) + len));
+        memcpy(dst, &udp, sizeof(udp));
+        dst += sizeof(udp);
+
+        memcpy(dst, data, len);
+        len_ += record_len;
+        ++num_records_;
+        return true;
+    }
+
+    auto CaptureWriter::close() -> void {
+        if(!base_)
+            return;
+        msync(base_, len_, MS_SYNC);
+        munmap(base_, max_bytes_);
+        base_ = nullptr;
+        ASSERT(ftruncate(fd_, len_) == 0, "ftruncate() of capture file failed. error:" + std::string(std::strerror(errno)));
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    CaptureReader::CaptureReader(const std::string& path) {
+        const auto fd = open(path.c_str(), O_RDONLY);
+        ASSERT(fd >= 0, "open() of capture file " + path + " failed. error:" + std::string(std::strerror(errno)));
+        struct stat st{};
+        ASSERT(fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(PcapFileHeader), "Capture file " + path + " has no pcap header.");
+        len_ = st.st_size;
+        base_ = static_cast<const char*>(mmap(nullptr, len_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0));
+        ASSERT(base_ != MAP_FAILED, "mmap() of capture file " + path + " failed. error:" + std::string(std::strerror(errno)));
+        ::close(fd);
+
+        PcapFileHeader header;
+        memcpy(&header, base_, sizeof(header));
+        ASSERT(header.magic_ == PCAP_MAGIC_NANOS || header.magic_ == PCAP_MAGIC_MICROS,
+            "Capture file " + path + " is not a little-endian pcap file, magic:" + std::to_string(header.magic_));
+        ASSERT(header.linktype_ == PCAP_LINKTYPE_IPV4 || header.linktype_ == PCAP_LINKTYPE_ETHERNET,
+            "Capture file " + path + " has unsupported linktype:" + std::to_string(header.linktype_));
+        frac_to_nanos_ = (header.magic_ == PCAP_MAGIC_NANOS ? 1 : NANOS_TO_MICROS);
+        link_header_size_ = (header.linktype_ == PCAP_LINKTYPE_ETHERNET ? 14 : 0);
+    }
+
+    CaptureReader::~CaptureReader() {
+        munmap(const_cast<char*>(base_), len_);
+    }
+
+    auto CaptureReader::next(CaptureRecord* record) noexcept -> bool {
+        while(offset_ + sizeof(PcapRecordHeader) <= len_) {
+            PcapRecordHeader header;
+            memcpy(&header, base_ + offset_, sizeof(header));
+            const auto frame = base_ + offset_ + sizeof(header);
+            offset_ += sizeof(header) + header.incl_len_;
+            if(UNLIKELY(offset_ > len_)) // truncated by a capture which did not close
+                break;
+
+            // Only complete UDP over IPv4 datagrams are replayed, anything else on the link is skipped
+            iphdr ip;
+            if(header.incl_len_ < link_header_size_ + sizeof(ip) + sizeof(udphdr)) {
+                ++num_skipped_;
+                continue;
+            }
+            memcpy(&ip, frame + link_header_size_, sizeof(ip));
+            const auto udp_offset = link_header_size_ + ip.ihl * 4;
+            udphdr udp;
+            if(ip.version != 4 || ip.protocol != IPPROTO_UDP || udp_offset + sizeof(udp) > header.incl_len_) {
+                ++num_skipped_;
+                continue;
+            }
+            memcpy(&udp, frame + udp_offset, sizeof(udp));
+            const size_t payload_len = ntohs(udp.len) - sizeof(udp);
+            if(ntohs(udp.len) < sizeof(udp) || udp_offset + sizeof(udp) + payload_len > header.incl_len_) {
+                ++num_skipped_;
+                continue;
+            }
+
+            record->time_ = static_cast<Nanos>(header.ts_sec_) * NANOS_TO_SECS + static_cast<Nanos>(header.ts_frac_) * frac_to_nanos_;
+            record->dst_addr_ = ip.daddr;
+            record->dst_port_ = udp.dest;
+            record->payload_ = frame + udp_offset + sizeof(udp);
+            record->len_ = payload_len;
+            return true;
+        }
+        return false;
+    }
+} // namespace Common
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <string>
+
+#include <netinet/in.h>
+
+#include "common/macros.h"
+#include "common/time_utils.h"
+
+namespace Common
+{
+    // Capture files are pcap files with nanosecond timestamps, so tcpdump and Wireshark read them as they are and captures taken
+    // with tcpdump -j adapter_unsynced --time-stamp-precision=nano in production replay like our own.
+    // CaptureWriter writes raw IPv4 (LINKTYPE_IPV4) records, CaptureReader also reads Ethernet (LINKTYPE_ETHERNET) and microsecond files.
+    constexpr uint32_t PCAP_MAGIC_NANOS = 0xa1b23c4d;
+    constexpr uint32_t PCAP_MAGIC_MICROS = 0xa1b2c3d4;
+    constexpr uint32_t PCAP_LINKTYPE_ETHERNET = 1;
+    constexpr uint32_t PCAP_LINKTYPE_IPV4 = 228;
+
+    #pragma pack(push, 1)
+    struct PcapFileHeader {
+        uint32_t magic_ = PCAP_MAGIC_NANOS;
+        uint16_t version_major_ = 2;
+        uint16_t version_minor_ = 4;
+        int32_t thiszone_ = 0;
+        uint32_t sigfigs_ = 0;
+        uint32_t snaplen_ = 64 * 1024;
+        uint32_t linktype_ = PCAP_LINKTYPE_IPV4;
+    };
+
+    struct PcapRecordHeader {
+        uint32_t ts_sec_ = 0;
+        uint32_t ts_frac_ = 0; // nanoseconds, or microseconds in a PCAP_MAGIC_MICROS file
+        uint32_t incl_len_ = 0;
+        uint32_t orig_len_ = 0;
+    };
+    #pragma pack(pop)
+
+    // Size of the IPv4 and UDP headers written in front of every captured datagram
+    constexpr size_t CAPTURE_IP_UDP_HEADER_SIZE = 20 + 8;
+
+    // Appends datagrams to a capture file through a shared mapping of its maximum size, so a write is a memcpy and never a syscall.
+    // The file is sparse until written and truncated to what was captured on close. Datagrams which no longer fit are counted and dropped.
+    class CaptureWriter final {
+        public:
+            CaptureWriter(const std::string& path, size_t max_bytes);
+            ~CaptureWriter();
+
+            // Record the UDP payload data of len bytes received at recv_time on group:port, both in network byte order
+            auto write(Nanos recv_time, in_addr_t group, in_port_t port, const void* data, size_t len) noexcept -> bool;
+
+            // Sync the mapping and truncate the file to the bytes written, further writes are dropped
+            auto close() -> void;
+
+            auto bytesWritten() const noexcept { return len_; }
+            auto numRecords() const noexcept { return num_records_; }
+            auto numDropped() const noexcept { return num_dropped_; }
+
+            // deleted default, copy & move constructors and assignment-operators
+            CaptureWriter() = delete;
+            CaptureWriter(const CaptureWriter&) = delete;
+            CaptureWriter(const CaptureWriter&&) = delete;
+            CaptureWriter &operator=(const CaptureWriter&) = delete;
+            CaptureWriter &operator=(const CaptureWriter&&) = delete;
+
+        private:
+            int fd_ = -1;
+            char* base_ = nullptr;
+            size_t max_bytes_ = 0;
+            size_t len_ = 0;
+            size_t num_records_ = 0;
+            size_t num_dropped_ = 0;
+    };
+
+    // UDP datagram read from a capture file, payload_ points into the file's mapping
+    struct CaptureRecord {
+        Nanos time_ = 0;
+        in_addr_t dst_addr_ = 0; // network byte order
+        in_port_t dst_port_ = 0; // network byte order
+        const char* payload_ = nullptr;
+        size_t len_ = 0;
+    };
+
+    // Reads the UDP over IPv4 datagrams of a capture file in order, skipping every other record
+    class CaptureReader final {
+        public:
+            explicit CaptureReader(const std::string& path);
+            ~CaptureReader();
+
+            // Read the next UDP datagram into record, false at the end of the file
+            auto next(CaptureRecord* record) noexcept -> bool;
+
+            // Start over from the first record
+            auto rewind() noexcept -> void { offset_ = sizeof(PcapFileHeader); }
+
+            auto numSkipped() const noexcept { return num_skipped_; }
+
+            // deleted default, copy & move constructors and assignment-operators
+            CaptureReader() = delete;
+            CaptureReader(const CaptureReader&) = delete;
+            CaptureReader(const CaptureReader&&) = delete;
+            CaptureReader &operator=(const CaptureReader&) = delete;
+            CaptureReader &operator=(const CaptureReader&&) = delete;
+
+        private:
+            const char* base_ = nullptr;
+            size_t len_ = 0;
+            size_t offset_ = sizeof(PcapFileHeader);
+            Nanos frac_to_nanos_ = 1;
+            size_t link_header_size_ = 0;
+            size_t num_skipped_ = 0;
+    };
+} // namespace Common
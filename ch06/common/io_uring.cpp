@@ -0,0 +1,109 @@
+#include "io_uring.h"
+
+namespace Common {
+    IOUring::IOUring(const IOUringCfg& cfg) : cfg_(cfg) {
+        ASSERT(cfg_.num_recv_buffers_ && cfg_.num_recv_buffers_ <= 32768,
+            "IOUring receive buffer count must be between 1 and 32768:" + std::to_string(cfg_.num_recv_buffers_));
+
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = 4 * cfg_.entries_;
+        if(cfg_.sqpoll_) {
+            params.flags |= IORING_SETUP_SQPOLL;
+            params.sq_thread_idle = cfg_.sqpoll_idle_ms_;
+            if(cfg_.sqpoll_cpu_ >= 0) {
+                params.flags |= IORING_SETUP_SQ_AFF;
+                params.sq_thread_cpu = cfg_.sqpoll_cpu_;
+            }
+        }
+
+        ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, cfg_.entries_, &params));
+        ASSERT(ring_fd_ >= 0, "io_uring_setup() failed. " + cfg_.toString() + " error:" + std::string(std::strerror(errno)));
+
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const auto single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP);
+        if(single_mmap)
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+
+        sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+        ASSERT(sq_ring_ != MAP_FAILED, "mmap() of io_uring SQ ring failed. error:" + std::string(std::strerror(errno)));
+        cq_ring_ = sq_ring_;
+        if(!single_mmap) {
+            cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+            ASSERT(cq_ring_ != MAP_FAILED, "mmap() of io_uring CQ ring failed. error:" + std::string(std::strerror(errno)));
+        }
+
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+        ASSERT(sqes_ != MAP_FAILED, "mmap() of io_uring SQEs failed. error:" + std::string(std::strerror(errno)));
+
+        auto sq_ptr = static_cast<char*>(sq_ring_);
+        sq_khead_ = reinterpret_cast<unsigned*>(sq_ptr + params.sq_off.head);
+        sq_ktail_ = reinterpret_cast<unsigned*>(sq_ptr + params.sq_off.tail);
+        sq_kflags_ = reinterpret_cast<unsigned*>(sq_ptr + params.sq_off.flags);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq_ptr + params.sq_off.ring_mask);
+        sq_entries_ = *reinterpret_cast<unsigned*>(sq_ptr + params.sq_off.ring_entries);
+        sq_tail_ = sq_submitted_ = *sq_ktail_;
+        // SQEs are always consumed in order, so the indirection array is set up once as the identity mapping
+        auto sq_array = reinterpret_cast<unsigned*>(sq_ptr + params.sq_off.array);
+        for(unsigned i = 0; i < sq_entries_; ++i)
+            sq_array[i] = i;
+
+        auto cq_ptr = static_cast<char*>(cq_ring_);
+        cq_khead_ = reinterpret_cast<unsigned*>(cq_ptr + params.cq_off.head);
+        cq_ktail_ = reinterpret_cast<unsigned*>(cq_ptr + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq_ptr + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq_ptr + params.cq_off.cqes);
+
+        // Sparse registered file table, sockets are installed as they are attached
+        std::vector<int> fds(cfg_.max_files_, -1);
+        ASSERT(registerOp(IORING_REGISTER_FILES, fds.data(), fds.size()) == 0,
+            "io_uring register files failed. error:" + std::string(std::strerror(errno)));
+        for(int i = static_cast<int>(cfg_.max_files_) - 1; i >= 0; --i)
+            free_files_.push_back(i);
+
+        // Provided buffers for multishot receives, the kernel picks one per completion and we hand it back once consumed.
+        // Handed over with IORING_OP_PROVIDE_BUFFERS rather than a registered buffer ring, which is not delivered on every kernel.
+        recv_buffers_size_ = static_cast<size_t>(cfg_.num_recv_buffers_) * cfg_.recv_buffer_size_;
+        recv_buffers_ = static_cast<char*>(mmap(nullptr, recv_buffers_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0));
+        ASSERT(recv_buffers_ != MAP_FAILED, "mmap() of io_uring receive buffers failed. error:" + std::string(std::strerror(errno)));
+
+        provideBuffers(0, cfg_.num_recv_buffers_);
+        submit();
+    }
+
+    IOUring::~IOUring() {
+        if(recv_buffers_ && recv_buffers_ != MAP_FAILED)
+            munmap(recv_buffers_, recv_buffers_size_);
+        if(sqes_ && sqes_ != MAP_FAILED)
+            munmap(sqes_, sqes_size_);
+        if(cq_ring_ && cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_)
+            munmap(cq_ring_, cq_ring_size_);
+        if(sq_ring_ && sq_ring_ != MAP_FAILED)
+            munmap(sq_ring_, sq_ring_size_);
+        if(ring_fd_ >= 0)
+            close(ring_fd_);
+    }
+
+    auto IOUring::registerFile(int fd) -> int {
+        if(UNLIKELY(free_files_.empty()))
+            return -1;
+
+        const auto index = free_files_.back();
+        io_uring_files_update update{static_cast<uint32_t>(index), 0, reinterpret_cast<uint64_t>(&fd)};
+        if(registerOp(IORING_REGISTER_FILES_UPDATE, &update, 1) != 1)
+            return -1;
+
+        free_files_.pop_back();
+        return index;
+    }
+
+    auto IOUring::unregisterFile(int index) -> void {
+        int fd = -1;
+        io_uring_files_update update{static_cast<uint32_t>(index), 0, reinterpret_cast<uint64_t>(&fd)};
+        if(registerOp(IORING_REGISTER_FILES_UPDATE, &update, 1) == 1)
+            free_files_.push_back(index);
+    }
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "macros.h"
+
+namespace Common {
+    struct IOUringCfg {
+        // Submission queue depth, the completion queue is sized at 4x since multishot requests post many completions per submission
+        unsigned entries_ = 1024;
+
+        // Let a kernel thread poll the submission queue so submitting needs no syscall while it is busy, optionally pinned to a core
+        bool sqpoll_ = false;
+        int sqpoll_cpu_ = -1;
+        unsigned sqpoll_idle_ms_ = 1000;
+
+        // Buffers the kernel picks from for multishot receives
+        unsigned num_recv_buffers_ = 256;
+        unsigned recv_buffer_size_ = 16 * 1024;
+
+        // Size of the registered file table, i.e. maximum number of sockets attached to the ring
+        unsigned max_files_ = 1024;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "IOUringCfg[entries:" << entries_
+               << " sqpoll:" << sqpoll_
+               << " sqpoll_cpu:" << sqpoll_cpu_
+               << " sqpoll_idle_ms:" << sqpoll_idle_ms_
+               << " recv_buffers:" << num_recv_buffers_
+               << " recv_buffer_size:" << recv_buffer_size_
+               << " max_files:" << max_files_
+               << "]";
+            return ss.str();
+        }
+    };
+
+    // Minimal io_uring instance driven directly through the raw syscalls and the mmap-ed rings.
+    // Owns a registered file table for the sockets attached to it and a pool of provided buffers for multishot receives,
+    // and only enters the kernel when there are new submissions (or never, with SQPOLL, while the kernel poller is awake).
+    // Completions are reaped from user space. Not thread safe, a ring is owned by the single thread driving its sockets.
+    class IOUring final {
+        public:
+            // Buffer group the provided receive buffers are registered under
+            static constexpr uint16_t RECV_BUFFER_GROUP = 0;
+
+            explicit IOUring(const IOUringCfg& cfg);
+            ~IOUring();
+
+            // Install fd in the registered file table, returns its fixed file index or -1 if the table is full
+            auto registerFile(int fd) -> int;
+            auto unregisterFile(int index) -> void;
+
+            // Next free submission queue entry, zeroed. Submits pending entries first if the queue is full.
+            auto getSqe() noexcept -> io_uring_sqe* {
+                while(UNLIKELY(sq_tail_ - __atomic_load_n(sq_khead_, __ATOMIC_ACQUIRE) >= sq_entries_))
+                    submit();
+
+                auto sqe = &sqes_[sq_tail_ & sq_mask_];
+                memset(sqe, 0, sizeof(*sqe));
+                ++sq_tail_;
+                return sqe;
+            }
+
+            // Publish the entries returned by getSqe() to the kernel, only makes a syscall if the kernel has to be told about them
+            auto submit() noexcept -> void {
+                const auto to_submit = sq_tail_ - sq_submitted_;
+                if(to_submit)
+                    __atomic_store_n(sq_ktail_, sq_tail_, __ATOMIC_RELEASE);
+                sq_submitted_ = sq_tail_;
+
+                if(cfg_.sqpoll_) {
+                    if(!to_submit)
+                        return;
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if(UNLIKELY(__atomic_load_n(sq_kflags_, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP))
+                        enter(0, IORING_ENTER_SQ_WAKEUP);
+                } else if(to_submit) {
+                    enter(to_submit, 0);
+                }
+            }
+
+            // Invoke f(const io_uring_cqe*) on every completion available, returns the number of completions seen.
+            // user_data 0 is reserved for the ring's own requests, which are consumed here.
+            template<typename F>
+            auto forEachCompletion(F&& f) noexcept {
+                if(UNLIKELY(__atomic_load_n(sq_kflags_, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW)) // completions are backed up in the kernel, flush them to the ring
+                    enter(0, IORING_ENTER_GETEVENTS);
+
+                auto head = *cq_khead_;
+                const auto tail = __atomic_load_n(cq_ktail_, __ATOMIC_ACQUIRE);
+                const size_t n = tail - head;
+                for(; head != tail; ++head) {
+                    const auto cqe = &cqes_[head & cq_mask_];
+                    if(LIKELY(cqe->user_data)) {
+                        f(cqe);
+                    } else if(UNLIKELY(cqe->res < 0)) {
+                        FATAL("io_uring provide buffers failed. error:" + std::string(std::strerror(-cqe->res)));
+                    }
+                }
+                __atomic_store_n(cq_khead_, head, __ATOMIC_RELEASE);
+                return n;
+            }
+
+            // Provided buffer the kernel filled for a receive completion, must be recycled once its contents have been consumed
+            auto recvBuffer(uint16_t buffer_id) const noexcept -> const char* {
+                return recv_buffers_ + static_cast<size_t>(buffer_id) * cfg_.recv_buffer_size_;
+            }
+
+            // Hand a consumed buffer back to the kernel, goes out with the next submit()
+            auto recycleRecvBuffer(uint16_t buffer_id) noexcept -> void {
+                provideBuffers(buffer_id, 1);
+            }
+
+            auto cfg() const noexcept -> const IOUringCfg& { return cfg_; }
+
+            // deleted default, copy & move constructors and assignment-operators
+            IOUring() = delete;
+            IOUring(const IOUring&) = delete;
+            IOUring(const IOUring&&) = delete;
+            IOUring &operator=(const IOUring&) = delete;
+            IOUring &operator=(const IOUring&&) = delete;
+
+        private:
+            const IOUringCfg cfg_;
+            int ring_fd_ = -1;
+
+            // Submission queue, sq_tail_ is our local tail and sq_submitted_ the part of it already published to the kernel
+            void* sq_ring_ = nullptr;
+            size_t sq_ring_size_ = 0;
+            unsigned* sq_khead_ = nullptr;
+            unsigned* sq_ktail_ = nullptr;
+            unsigned* sq_kflags_ = nullptr;
+            unsigned sq_mask_ = 0, sq_entries_ = 0;
+            unsigned sq_tail_ = 0, sq_submitted_ = 0;
+            io_uring_sqe* sqes_ = nullptr;
+            size_t sqes_size_ = 0;
+
+            // Completion queue, shares the sq mapping when the kernel supports IORING_FEAT_SINGLE_MMAP
+            void* cq_ring_ = nullptr;
+            size_t cq_ring_size_ = 0;
+            unsigned* cq_khead_ = nullptr;
+            unsigned* cq_ktail_ = nullptr;
+            unsigned cq_mask_ = 0;
+            io_uring_cqe* cqes_ = nullptr;
+
+            // Provided buffers for multishot receives
+            char* recv_buffers_ = nullptr;
+            size_t recv_buffers_size_ = 0;
+
+            // Unused slots of the registered file table
+            std::vector<int> free_files_;
+
+            auto enter(unsigned to_submit, unsigned flags) noexcept -> void {
+                syscall(__NR_io_uring_enter, ring_fd_, to_submit, 0, flags, nullptr, 0);
+            }
+
+            // Add count consecutive receive buffers starting at buffer_id to the buffer group
+            auto provideBuffers(uint16_t buffer_id, unsigned count) noexcept -> void {
+                auto sqe = getSqe();
+                sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+                sqe->fd = static_cast<int>(count);
+                sqe->addr = reinterpret_cast<uint64_t>(recvBuffer(buffer_id));
+                sqe->len = cfg_.recv_buffer_size_;
+                sqe->off = buffer_id;
+                sqe->buf_group = RECV_BUFFER_GROUP;
+                sqe->user_data = 0;
+            }
+
+            auto registerOp(unsigned opcode, void* arg, unsigned nr_args) noexcept -> int {
+                return static_cast<int>(syscall(__NR_io_uring_register, ring_fd_, opcode, arg, nr_args));
+            }
+    };
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "macros.h"
+#include "time_utils.h"
+
+namespace Common {
+    // Log-linear histogram of latencies in nanoseconds.
+    // Values are bucketed on their most significant bit plus the next SubBucketBits bits, so recording is O(1) and allocation free,
+    // and every reported percentile is within 1 / 2^SubBucketBits of the true value.
+    class LatencyHistogram final {
+        public:
+            static constexpr size_t SubBucketBits = 5;
+            static constexpr size_t NumSubBuckets = 1 << SubBucketBits;
+            static constexpr size_t NumBuckets = (64 - SubBucketBits + 1) * NumSubBuckets;
+
+            LatencyHistogram() {
+                reset();
+            }
+
+            auto reset() noexcept -> void {
+                counts_.fill(0);
+                count_ = 0;
+                sum_ = 0;
+                min_ = std::numeric_limits<Nanos>::max();
+                max_ = 0;
+            }
+
+            auto record(Nanos value) noexcept {
+                value = std::max<Nanos>(value, 0);
+                ++counts_[valueToIndex(value)];
+                ++count_;
+                sum_ += value;
+                min_ = std::min(min_, value);
+                max_ = std::max(max_, value);
+            }
+
+            // Fold the samples of another histogram into this one, used to aggregate per-thread / per-session histograms
+            auto merge(const LatencyHistogram& other) noexcept {
+                for(size_t i = 0; i < NumBuckets; ++i)
+                    counts_[i] += other.counts_[i];
+                count_ += other.count_;
+                sum_ += other.sum_;
+                min_ = std::min(min_, other.min_);
+                max_ = std::max(max_, other.max_);
+            }
+
+            // Returns the upper bound of the bucket holding the requested percentile (0 - 100)
+            auto percentile(double pct) const noexcept -> Nanos {
+                if(UNLIKELY(!count_))
+                    return 0;
+
+                const auto target = std::max<size_t>(1, static_cast<size_t>(pct / 100.0 * count_ + 0.5));
+                size_t seen = 0;
+                for(size_t i = 0; i < NumBuckets; ++i) {
+                    seen += counts_[i];
+                    if(seen >= target)
+                        return std::min(indexToValue(i), max_);
+                }
+                return max_;
+            }
+
+            auto count() const noexcept { return count_; }
+            auto min() const noexcept { return count_ ? min_ : 0; }
+            auto max() const noexcept { return max_; }
+            auto mean() const noexcept { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+
+            auto toString() const {
+                std::stringstream ss;
+                ss << "LatencyHistogram[count:" << count_
+                   << " min:" << min()
+                   << " mean:" << static_cast<Nanos>(mean())
+                   << " p50:" << percentile(50)
+                   << " p90:" << percentile(90)
+                   << " p99:" << percentile(99)
+                   << " p99.9:" << percentile(99.9)
+                   << " p99.99:" << percentile(99.99)
+                   << " max:" << max_
+                   << "]";
+                return ss.str();
+            }
+
+        private:
+            std::array<size_t, NumBuckets> counts_;
+            size_t count_ = 0;
+            Nanos sum_ = 0;
+            Nanos min_ = std::numeric_limits<Nanos>::max();
+            Nanos max_ = 0;
+
+            static auto valueToIndex(Nanos value) noexcept -> size_t {
+                const auto v = static_cast<uint64_t>(value);
+                if(v < NumSubBuckets)
+                    return v;
+
+                const size_t shift = (63 - __builtin_clzll(v)) - SubBucketBits;
+                return (shift + 1) * NumSubBuckets + ((v >> shift) - NumSubBuckets);
+            }
+
+            static auto indexToValue(size_t index) noexcept -> Nanos {
+                if(index < NumSubBuckets)
+                    return index;
+
+                const size_t shift = index / NumSubBuckets - 1;
+                const uint64_t mantissa = NumSubBuckets + index % NumSubBuckets;
+                return static_cast<Nanos>(((mantissa + 1) << shift) - 1);
+            }
+    };
+}
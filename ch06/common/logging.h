@@ -42,6 +42,9 @@ namespace Common {
             LFQueue<LogElement> queue_;
             std::atomic<bool> running_ = {true};
             std::thread* logger_thread_ = nullptr;
+
+            // Shared by every Logger in the process, see setEnabled()
+            static inline bool enabled_ = true;
         
         public:
             auto flushQueue() noexcept {
@@ -125,6 +128,10 @@ namespace Common {
                 std::cerr << Common::getCurrentTimeStr(&time_str) << " - Logger for " << file_name_ << " exiting." << std::endl;
             }
 
+            // Drop everything logged by any Logger while false, so benchmarks can time components without their logging.
+            // Only meant to be flipped while no other thread is logging.
+            static auto setEnabled(bool enabled) noexcept { enabled_ = enabled; }
+
             auto pushValue(const LogElement& log_element) noexcept {
                 *(queue_.getNextToWriteTo()) = log_element;
                 queue_.updateWriteIndex();
@@ -180,6 +187,8 @@ namespace Common {
 
             template<typename T, typename... A>
             auto log(const char* s, const T& value, A... args) noexcept {
+                if(UNLIKELY(!enabled_))
+                    return;
                 while (*s)
                 {
                     if (*s == '%')
@@ -198,6 +207,8 @@ namespace Common {
             }
 
             auto log(const char* s) noexcept {
+                if(UNLIKELY(!enabled_))
+                    return;
                 while (*s)
                 {
                     if (*s == '%')
@@ -18,28 +18,87 @@ namespace Common
     }
 
     auto McastSocket::sendAndRecv() noexcept -> bool {
-        // Read data and dispatch callbacks if data is available - non blocking
-        const ssize_t n_rcv = recv(socket_fd_, inbound_data_.data() + next_rcv_valid_index_, McastBufferSize - next_rcv_valid_index_, MSG_DONTWAIT);
-        if(n_rcv > 0) {
-            next_rcv_valid_index_ += n_rcv;
-            logger_.log("%:% %() % read socket:% len:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), socket_fd_, next_rcv_valid_index_);
-            recv_callback_(this);
+        const auto received = recvBatch();
+        sendBatches();
+        return received;
+    }
+
+    // Read a batch of datagrams - non blocking - each into its own slot of the receive ring, and dispatch callbacks on them in place
+    auto McastSocket::recvBatch() noexcept -> bool {
+        const auto batch = std::min(McastBatchSize, inbound_data_.writable() / McastMaxDatagramSize);
+        auto slot = inbound_data_.writePtr();
+        for(size_t i = 0; i < batch; ++i, slot += McastMaxDatagramSize) {
+            iovs_[i] = {slot, McastMaxDatagramSize};
+            msgs_[i] = {};
+            msgs_[i].msg_hdr.msg_iov = &iovs_[i];
+            msgs_[i].msg_hdr.msg_iovlen = 1;
         }
 
-        // Publish market data in the send buffer to the multicast stream
-        if(next_send_valid_index_ > 0) {
-            ssize_t n = ::send(socket_fd_, outbound_data_.data(), next_rcv_valid_index_, MSG_DONTWAIT | MSG_NOSIGNAL);
-            logger_.log("%:% %() % send socket:% len:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), socket_fd_, n);
+        const auto n_rcv = recvmmsg(socket_fd_, msgs_.data(), batch, MSG_DONTWAIT, nullptr);
+        for(int i = 0; i < n_rcv; ++i) {
+            const auto len = msgs_[i].msg_len;
+            inbound_data_.commit(len);
+            logger_.log("%:% %() % read socket:% len:% datagram:%/%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                socket_fd_, len, i + 1, n_rcv);
+            recv_callback_(this);
+
+            // Messages never span datagrams, anything the callback left is a truncated message
+            if(UNLIKELY(inbound_data_.readable())) {
+                logger_.log("%:% %() % socket:% dropping % trailing bytes of datagram len:%\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getCurrentTimeStr(&time_str_), socket_fd_, inbound_data_.readable(), len);
+                inbound_data_.clear();
+            }
+            inbound_data_.skip(McastMaxDatagramSize - len);
         }
-        next_send_valid_index_ = 0;
 
         return (n_rcv > 0);
     }
 
+    // Publish the datagrams in the send buffer to the multicast stream
+    auto McastSocket::sendBatches() noexcept -> void {
+        endPacket();
+
+        auto data = outbound_data_.data();
+        for(size_t sent = 0; sent < send_packet_lens_.size();) {
+            const auto batch = std::min(McastBatchSize, send_packet_lens_.size() - sent);
+            auto packet = data;
+            for(size_t i = 0; i < batch; ++i) {
+                iovs_[i] = {packet, send_packet_lens_[sent + i]};
+                msgs_[i] = {};
+                msgs_[i].msg_hdr.msg_iov = &iovs_[i];
+                msgs_[i].msg_hdr.msg_iovlen = 1;
+                packet += send_packet_lens_[sent + i];
+            }
+
+            const auto n = sendmmsg(socket_fd_, msgs_.data(), batch, MSG_DONTWAIT | MSG_NOSIGNAL);
+            logger_.log("%:% %() % send socket:% datagrams:%/% error:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                socket_fd_, n, batch, (n < 0 ? std::strerror(errno) : "none"));
+            if(UNLIKELY(n <= 0)) // multicast is best effort, drop what the kernel will not take
+                break;
+
+            for(int i = 0; i < n; ++i)
+                data += send_packet_lens_[sent + i];
+            sent += n;
+        }
+
+        next_send_valid_index_ = send_packet_start_ = 0;
+        send_packet_lens_.clear();
+    }
+
+    auto McastSocket::endPacket() noexcept -> void {
+        if(next_send_valid_index_ > send_packet_start_) {
+            send_packet_lens_.push_back(next_send_valid_index_ - send_packet_start_);
+            send_packet_start_ = next_send_valid_index_;
+        }
+    }
+
     auto McastSocket::send(const void* data, size_t len) noexcept -> void {
+        // Close the datagram being filled if this data would take it over the packet size
+        if(next_send_valid_index_ - send_packet_start_ + len > McastPacketSize)
+            endPacket();
+
         memcpy(outbound_data_.data() + next_send_valid_index_, data, len);
         next_send_valid_index_ += len;
         ASSERT(next_send_valid_index_ < McastBufferSize, "Mcast socket buffer filled up and sendAndRecv() not called.");
     }
 } // namespace Common
-
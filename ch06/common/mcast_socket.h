@@ -1,19 +1,30 @@
 #pragma once
 
+#include <array>
 #include <functional>
 
+#include <sys/uio.h>
+
 #include "socket_utils.h"
 #include "logging.h"
+#include "recv_buffer.h"
 
 namespace Common
 {
     constexpr size_t McastBufferSize = 64 * 1024 * 1024;
 
+    // Largest UDP payload sent per datagram, an Ethernet MTU less the IP and UDP headers, so datagrams are never fragmented
+    constexpr size_t McastPacketSize = 1500 - 20 - 8;
+    // Receive slot per datagram, large enough for any UDP payload so nothing is ever truncated
+    constexpr size_t McastMaxDatagramSize = 64 * 1024;
+    // Datagrams moved per recvmmsg() / sendmmsg() call
+    constexpr size_t McastBatchSize = 64;
+
     struct McastSocket {
         McastSocket(Logger& logger)
-            : logger_(logger) {
+            : inbound_data_(McastBufferSize), logger_(logger) {
                 outbound_data_.resize(McastBufferSize);
-                inbound_data_.resize(McastBufferSize);
+                send_packet_lens_.reserve(McastBufferSize / McastPacketSize + 1);
             }
 
             // Init multicast socket to read from/publish to a stream
@@ -26,24 +37,38 @@ namespace Common
             // Remove / leave membership / sub to a multicast stream
             auto leave(const std::string& ip, int port) -> void;
 
-            // Publish outgoing data and read incoming data
+            // Publish outgoing data and read incoming data, up to McastBatchSize datagrams per syscall each way.
+            // recv_callback_ is invoked once per datagram received, with exactly that datagram readable in inbound_data_.
             auto sendAndRecv() noexcept -> bool;
 
-            // Copy data to send buffers - does not send them out yet
+            // Copy data to send buffers - does not send them out yet.
+            // Data is packed into datagrams of up to McastPacketSize bytes and a single send() is never split across two datagrams.
             auto send(const void* data, size_t len) noexcept -> void;
+
+            // Close the datagram being filled, data sent after this goes into a new one
+            auto endPacket() noexcept -> void;
         
             int socket_fd_ = -1;
 
-            // Send and receive buffers, typically only one or the other is needed not both
+            // Send and receive buffers, typically only one or the other is needed not both.
+            // Outgoing datagrams are laid out back to back in outbound_data_, send_packet_lens_ holds the length of all but the one being filled.
             std::vector<char> outbound_data_;
             size_t next_send_valid_index_ = 0;
-            std::vector<char> inbound_data_;
-            size_t next_rcv_valid_index_ = 0;
+            size_t send_packet_start_ = 0;
+            std::vector<uint32_t> send_packet_lens_;
+            RecvBuffer inbound_data_;
 
             // Function wrapper for the method to call when data is read
             std::function<void(McastSocket* s)> recv_callback_ = nullptr;
 
             std::string time_str_;
             Logger& logger_;
+
+        private:
+            std::array<mmsghdr, McastBatchSize> msgs_;
+            std::array<iovec, McastBatchSize> iovs_;
+
+            auto recvBatch() noexcept -> bool;
+            auto sendBatches() noexcept -> void;
     };
 } // namespace Common
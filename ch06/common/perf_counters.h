@@ -0,0 +1,269 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "macros.h"
+#include "logging.h"
+#include "perf_utils.h"
+
+namespace Common {
+    // Default number of sampled iterations aggregated in every PerfCounterSampler report
+    constexpr size_t PERF_COUNTERS_REPORT_EVERY = 100 * 1000;
+
+    // Hardware performance counters of the calling thread, opened as a single perf_event_open group.
+    // Reads go through rdpmc on the mmap-ed counter pages when the kernel allows it and fall back to a read() of the whole group otherwise.
+    // Counters the kernel / hypervisor does not expose are skipped, so this degrades to reading zeros instead of failing.
+    class PerfCounters final {
+        public:
+            enum Counter : size_t {
+                CYCLES = 0, INSTRUCTIONS = 1, L1D_MISSES = 2, LLC_MISSES = 3, BRANCH_MISSES = 4, DTLB_MISSES = 5, NUM_COUNTERS = 6
+            };
+            typedef std::array<uint64_t, NUM_COUNTERS> Values;
+
+            // Counts only the calling thread, so this must be constructed on the thread running the code to measure
+            PerfCounters() {
+                constexpr auto cacheMiss = [](uint64_t cache) {
+                    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                };
+                constexpr std::array<std::pair<uint32_t, uint64_t>, NUM_COUNTERS> events = {{
+                    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+                    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+                    {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D)},
+                    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+                    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+                    {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_DTLB)}
+                }};
+
+                fds_.fill(-1);
+                pages_.fill(nullptr);
+                const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+                for(size_t i = 0; i < NUM_COUNTERS; ++i) {
+                    perf_event_attr attr;
+                    memset(&attr, 0, sizeof(attr));
+                    attr.size = sizeof(attr);
+                    attr.type = events[i].first;
+                    attr.config = events[i].second;
+                    attr.disabled = (leader_fd_ == -1);
+                    attr.exclude_kernel = 1;
+                    attr.exclude_hv = 1;
+                    attr.read_format = PERF_FORMAT_GROUP;
+
+                    const auto fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader_fd_, 0));
+                    if(fd == -1) {
+                        if(error_.empty())
+                            error_ = counterName(static_cast<Counter>(i)) + ": " + std::strerror(errno);
+                        continue;
+                    }
+
+                    if(leader_fd_ == -1)
+                        leader_fd_ = fd;
+                    fds_[i] = fd;
+                    group_index_[i] = num_open_++;
+
+                    auto page = mmap(nullptr, page_size, PROT_READ, MAP_SHARED, fd, 0);
+                    if(page != MAP_FAILED)
+                        pages_[i] = static_cast<const perf_event_mmap_page*>(page);
+                }
+
+                if(leader_fd_ != -1)
+                    ioctl(leader_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+
+            ~PerfCounters() {
+                const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+                for(size_t i = 0; i < NUM_COUNTERS; ++i) {
+                    if(pages_[i])
+                        munmap(const_cast<perf_event_mmap_page*>(pages_[i]), page_size);
+                    if(fds_[i] != -1)
+                        close(fds_[i]);
+                }
+            }
+
+            auto available(Counter counter) const noexcept { return fds_[counter] != -1; }
+            auto anyAvailable() const noexcept { return leader_fd_ != -1; }
+
+            // Reason the first counter that could not be opened failed, empty if all are available
+            auto error() const noexcept -> const std::string& { return error_; }
+
+            // Snapshot of all the counters, unavailable counters read as 0
+            auto read(Values* values) const noexcept {
+                values->fill(0);
+                if(UNLIKELY(leader_fd_ == -1))
+                    return;
+
+                bool fast_read = true;
+                for(size_t i = 0; i < NUM_COUNTERS && fast_read; ++i)
+                    fast_read = (fds_[i] == -1 || rdpmcRead(i, &(*values)[i]));
+                if(LIKELY(fast_read))
+                    return;
+
+                std::array<uint64_t, NUM_COUNTERS + 1> buffer; // PERF_FORMAT_GROUP layout is { nr, values[nr] }
+                if(::read(leader_fd_, buffer.data(), sizeof(buffer)) <= 0)
+                    return;
+                for(size_t i = 0; i < NUM_COUNTERS; ++i)
+                    (*values)[i] = (fds_[i] != -1 ? buffer[1 + group_index_[i]] : 0);
+            }
+
+            static auto counterName(Counter counter) -> std::string {
+                switch(counter) {
+                    case CYCLES: return "cycles";
+                    case INSTRUCTIONS: return "instructions";
+                    case L1D_MISSES: return "l1d_misses";
+                    case LLC_MISSES: return "llc_misses";
+                    case BRANCH_MISSES: return "branch_misses";
+                    case DTLB_MISSES: return "dtlb_misses";
+                    case NUM_COUNTERS: break;
+                }
+                return "UNKNOWN";
+            }
+
+            // deleted copy & move constructors and assignment-operators
+            PerfCounters(const PerfCounters&) = delete;
+            PerfCounters(const PerfCounters&&) = delete;
+            PerfCounters &operator=(const PerfCounters&) = delete;
+            PerfCounters &operator=(const PerfCounters&&) = delete;
+
+        private:
+            int leader_fd_ = -1;
+            std::array<int, NUM_COUNTERS> fds_;
+            std::array<const perf_event_mmap_page*, NUM_COUNTERS> pages_;
+            std::array<size_t, NUM_COUNTERS> group_index_ = {};
+            size_t num_open_ = 0;
+            std::string error_;
+
+            // User space read of one counter following the seqlock protocol documented in linux/perf_event.h.
+            // Returns false if rdpmc is not allowed or the counter is not currently scheduled on the PMU.
+            auto rdpmcRead(size_t i, uint64_t* value) const noexcept -> bool {
+                const volatile perf_event_mmap_page* page = pages_[i];
+                if(UNLIKELY(!page))
+                    return false;
+
+                uint32_t seq;
+                uint64_t count;
+                do {
+                    seq = page->lock;
+                    std::atomic_signal_fence(std::memory_order_seq_cst);
+
+                    const uint32_t index = page->index;
+                    if(UNLIKELY(!page->cap_user_rdpmc || !index))
+                        return false;
+
+                    const auto width = page->pmc_width;
+                    auto pmc = static_cast<int64_t>(rdpmc(index - 1) << (64 - width));
+                    pmc >>= (64 - width); // sign extend the counter width to 64 bits
+                    count = page->offset + pmc;
+
+                    std::atomic_signal_fence(std::memory_order_seq_cst);
+                } while(page->lock != seq);
+
+                *value = count;
+                return true;
+            }
+    };
+
+    // Accumulates PerfCounters deltas over a section of code which runs repeatedly, such as one iteration of a hot loop,
+    // and logs the per-iteration averages every report_every iterations.
+    class PerfCounterSampler final {
+        public:
+            PerfCounterSampler(const std::string& name, Logger* logger, size_t report_every)
+                : name_(name), logger_(logger), report_every_(report_every) {}
+
+            // Opens the counters, must be called from the thread running the sampled code
+            auto open() -> void {
+                counters_ = std::make_unique<PerfCounters>();
+                enabled_ = (counters_->anyAvailable() && report_every_);
+                logger_->log("%:% %() % PerfCounters[%] enabled:% report_every:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                             name_, (enabled_ ? "true" : "false"), report_every_, (counters_->error().empty() ? "" : "unavailable " + counters_->error()));
+            }
+
+            auto start() noexcept {
+                if(UNLIKELY(!enabled_))
+                    return;
+                counters_->read(&start_values_);
+            }
+
+            auto stop() noexcept {
+                if(UNLIKELY(!enabled_))
+                    return;
+
+                PerfCounters::Values end_values;
+                counters_->read(&end_values);
+                for(size_t i = 0; i < PerfCounters::NUM_COUNTERS; ++i)
+                    totals_[i] += end_values[i] - start_values_[i];
+
+                if(UNLIKELY(++iterations_ == report_every_))
+                    report();
+            }
+
+            // deleted copy & move constructors and assignment-operators
+            PerfCounterSampler() = delete;
+            PerfCounterSampler(const PerfCounterSampler&) = delete;
+            PerfCounterSampler(const PerfCounterSampler&&) = delete;
+            PerfCounterSampler &operator=(const PerfCounterSampler&) = delete;
+            PerfCounterSampler &operator=(const PerfCounterSampler&&) = delete;
+
+        private:
+            const std::string name_;
+            Logger* logger_ = nullptr;
+            const size_t report_every_;
+            std::unique_ptr<PerfCounters> counters_;
+            bool enabled_ = false;
+
+            size_t iterations_ = 0;
+            PerfCounters::Values start_values_ = {}, totals_ = {};
+            std::string time_str_;
+
+            auto report() noexcept -> void {
+                std::stringstream ss;
+                ss << std::fixed;
+                ss.precision(2);
+                for(size_t i = 0; i < PerfCounters::NUM_COUNTERS; ++i) {
+                    const auto counter = static_cast<PerfCounters::Counter>(i);
+                    if(counters_->available(counter))
+                        ss << " " << PerfCounters::counterName(counter) << ":" << static_cast<double>(totals_[i]) / iterations_;
+                }
+                if(counters_->available(PerfCounters::CYCLES) && counters_->available(PerfCounters::INSTRUCTIONS) && totals_[PerfCounters::CYCLES])
+                    ss << " ipc:" << static_cast<double>(totals_[PerfCounters::INSTRUCTIONS]) / totals_[PerfCounters::CYCLES];
+
+                logger_->log("%:% %() % PerfCounters[%] per iteration over % iterations%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                             name_, iterations_, ss.str());
+
+                iterations_ = 0;
+                totals_.fill(0);
+            }
+    };
+
+    // Samples the counters over the lifetime of the enclosing scope
+    class PerfCounterScope final {
+        public:
+            explicit PerfCounterScope(PerfCounterSampler* sampler) noexcept : sampler_(sampler) {
+                sampler_->start();
+            }
+
+            ~PerfCounterScope() {
+                sampler_->stop();
+            }
+
+            // deleted copy & move constructors and assignment-operators
+            PerfCounterScope() = delete;
+            PerfCounterScope(const PerfCounterScope&) = delete;
+            PerfCounterScope(const PerfCounterScope&&) = delete;
+            PerfCounterScope &operator=(const PerfCounterScope&) = delete;
+            PerfCounterScope &operator=(const PerfCounterScope&&) = delete;
+
+        private:
+            PerfCounterSampler* sampler_ = nullptr;
+    };
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Common {
+    // Read from the TSC register and return the elapsed CPU clock cycles
+    inline auto rdtsc() noexcept {
+        unsigned int lo, hi;
+        __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+        return (static_cast<uint64_t>(hi) << 32) | lo;
+    }
+
+    // Read the raw value of a hardware performance counter from user space, only valid for counters the kernel has enabled rdpmc on
+    inline auto rdpmc(uint32_t counter) noexcept {
+        unsigned int lo, hi;
+        __asm__ __volatile__("rdpmc" : "=a"(lo), "=d"(hi) : "c"(counter));
+        return (static_cast<uint64_t>(hi) << 32) | lo;
+    }
+}
@@ -0,0 +1,57 @@
+#include "recv_buffer.h"
+
+namespace Common {
+    namespace {
+        // Smallest power of two number of pages holding at least len bytes, so positions wrap with a mask
+        auto roundCapacity(size_t len) {
+            size_t capacity = sysconf(_SC_PAGESIZE);
+            while(capacity < len)
+                capacity *= 2;
+            return capacity;
+        }
+    }
+
+    RecvBuffer::RecvBuffer(size_t capacity) {
+        capacity_ = roundCapacity(capacity);
+        base_ = mapMirrored(capacity_);
+    }
+
+    RecvBuffer::~RecvBuffer() {
+        if(base_)
+            munmap(base_, 2 * capacity_);
+    }
+
+    auto RecvBuffer::grow(size_t new_capacity) -> void {
+        new_capacity = roundCapacity(new_capacity);
+        if(new_capacity <= capacity_)
+            return;
+
+        auto grown = mapMirrored(new_capacity);
+        const auto len = readable();
+        memcpy(grown, readPtr(), len);
+        munmap(base_, 2 * capacity_);
+
+        base_ = grown;
+        capacity_ = new_capacity;
+        head_ = 0;
+        tail_ = len;
+    }
+
+    auto RecvBuffer::mapMirrored(size_t capacity) -> char* {
+        const auto fd = memfd_create("RecvBuffer", MFD_CLOEXEC);
+        ASSERT(fd >= 0, "memfd_create() failed. error:" + std::string(std::strerror(errno)));
+        ASSERT(!ftruncate(fd, capacity), "ftruncate() failed. capacity:" + std::to_string(capacity) + " error:" + std::string(std::strerror(errno)));
+
+        // Reserve the address range for both halves, then map the same pages over each half. Populated up front so the
+        // first receives do not fault.
+        auto base = static_cast<char*>(mmap(nullptr, 2 * capacity, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        ASSERT(base != MAP_FAILED, "mmap() of RecvBuffer address range failed. error:" + std::string(std::strerror(errno)));
+        for(auto half: {base, base + capacity}) {
+            ASSERT(mmap(half, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED | MAP_POPULATE, fd, 0) == half,
+                "mmap() of RecvBuffer mirror failed. error:" + std::string(std::strerror(errno)));
+        }
+        close(fd);
+
+        return base;
+    }
+}
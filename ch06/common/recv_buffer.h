@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstring>
+#include <string>
+
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "macros.h"
+
+namespace Common {
+    // Receive buffer the sockets read into and the protocol parsers read whole messages out of, in place.
+    // A ring whose pages are mapped twice back to back, so the free space after the write position and the unread data after the
+    // read position are always contiguous in memory, however they wrap. Parsers consume() what they decoded and leave a trailing
+    // partial message where it is, no compaction copy is ever needed.
+    class RecvBuffer final {
+        public:
+            // Capacity is rounded up to a whole number of pages
+            explicit RecvBuffer(size_t capacity);
+            ~RecvBuffer();
+
+            // Contiguous unread data and the number of bytes in it
+            auto readPtr() const noexcept -> const char* { return base_ + (head_ & (capacity_ - 1)); }
+            auto readable() const noexcept { return tail_ - head_; }
+            // Mark len bytes from readPtr() as parsed
+            auto consume(size_t len) noexcept -> void { head_ += len; }
+            auto clear() noexcept -> void { head_ = tail_; }
+
+            // Contiguous free space to receive into and the number of bytes in it
+            auto writePtr() noexcept -> char* { return base_ + (tail_ & (capacity_ - 1)); }
+            auto writable() const noexcept { return capacity_ - readable(); }
+            // Mark len bytes at writePtr() as received
+            auto commit(size_t len) noexcept -> void { tail_ += len; }
+            // Step over len bytes of free space without receiving into them, only while there is no unread data
+            auto skip(size_t len) noexcept -> void { head_ = (tail_ += len); }
+
+            auto capacity() const noexcept { return capacity_; }
+
+            // Remap at a capacity of at least new_capacity, keeping the unread data
+            auto grow(size_t new_capacity) -> void;
+
+            // deleted default, copy & move constructors and assignment-operators
+            RecvBuffer() = delete;
+            RecvBuffer(const RecvBuffer&) = delete;
+            RecvBuffer(const RecvBuffer&&) = delete;
+            RecvBuffer &operator=(const RecvBuffer&) = delete;
+            RecvBuffer &operator=(const RecvBuffer&&) = delete;
+
+        private:
+            // First of the two mappings, each capacity_ bytes, and the byte counts read and received since the last remap
+            char* base_ = nullptr;
+            size_t capacity_ = 0;
+            size_t head_ = 0;
+            size_t tail_ = 0;
+
+            // Map capacity bytes twice back to back, capacity must be a power of two multiple of the page size
+            static auto mapMirrored(size_t capacity) -> char*;
+    };
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace Common {
+    // Binary encoding in the style of Simple Binary Encoding: every message is an SBEMessageHeader followed by a block of little-endian
+    // fields at fixed offsets, laid out per message template. Layouts are lists of field types, so encoders and decoders are generated at
+    // compile time down to a store or load per field, with no per-message interpretation of a schema.
+
+    #pragma pack(push, 1)
+    // Leads every encoded message. block_length_ is the length of the block that follows, so decoders skip messages of templates they do
+    // not know and fields appended by newer versions, and read fields past the end of a shorter block as absent.
+    struct SBEMessageHeader {
+        uint16_t block_length_ = 0;
+        uint8_t template_id_ = 0;
+        uint8_t version_ = 0;
+    };
+    #pragma pack(pop)
+
+    template<typename T>
+    inline auto sbeStore(char* dst, T value) noexcept -> void {
+        static_assert(std::is_integral_v<T>, "SBE fields are fixed width integers.");
+        if constexpr(std::endian::native == std::endian::big && sizeof(T) > 1) {
+            if constexpr(sizeof(T) == 2) value = static_cast<T>(__builtin_bswap16(static_cast<uint16_t>(value)));
+            if constexpr(sizeof(T) == 4) value = static_cast<T>(__builtin_bswap32(static_cast<uint32_t>(value)));
+            if constexpr(sizeof(T) == 8) value = static_cast<T>(__builtin_bswap64(static_cast<uint64_t>(value)));
+        }
+        memcpy(dst, &value, sizeof(T));
+    }
+
+    template<typename T>
+    inline auto sbeLoad(const char* src) noexcept -> T {
+        static_assert(std::is_integral_v<T>, "SBE fields are fixed width integers.");
+        T value;
+        memcpy(&value, src, sizeof(T));
+        if constexpr(std::endian::native == std::endian::big && sizeof(T) > 1) {
+            if constexpr(sizeof(T) == 2) value = static_cast<T>(__builtin_bswap16(static_cast<uint16_t>(value)));
+            if constexpr(sizeof(T) == 4) value = static_cast<T>(__builtin_bswap32(static_cast<uint32_t>(value)));
+            if constexpr(sizeof(T) == 8) value = static_cast<T>(__builtin_bswap64(static_cast<uint64_t>(value)));
+        }
+        return value;
+    }
+
+    // Member reached through Path, a chain of pointers to members, encoded as the integer Wire.
+    // A Wire narrower than the member carries the member's INVALID value, its max, as the max of Wire. Every other value must fit.
+    template<typename Wire, auto... Path>
+    struct SBEField {
+        static constexpr size_t SIZE = sizeof(Wire);
+        static constexpr bool OPTIONAL = false;
+
+        template<typename Message>
+        static auto member(Message& message) noexcept -> auto& { return (message .* ... .* Path); }
+
+        template<typename Message>
+        static auto present(const Message&) noexcept { return true; }
+
+        template<typename Message>
+        static auto encode(const Message& message, char* dst) noexcept -> void {
+            const auto value = member(message);
+            using Member = std::remove_cvref_t<decltype(value)>;
+            if constexpr(std::is_integral_v<Member> && sizeof(Wire) < sizeof(Member))
+                sbeStore<Wire>(dst, value == std::numeric_limits<Member>::max() ? std::numeric_limits<Wire>::max() : static_cast<Wire>(value));
+            else
+                sbeStore<Wire>(dst, static_cast<Wire>(value));
+        }
+
+        template<typename Message>
+        static auto decode(const char* src, Message& message) noexcept -> void {
+            auto& value = member(message);
+            using Member = std::remove_cvref_t<decltype(value)>;
+            const auto wire = sbeLoad<Wire>(src);
+            if constexpr(std::is_integral_v<Member> && sizeof(Wire) < sizeof(Member))
+                value = (wire == std::numeric_limits<Wire>::max() ? std::numeric_limits<Member>::max() : static_cast<Member>(wire));
+            else
+                value = static_cast<Member>(wire);
+        }
+    };
+
+    // Field absent while the member is 0, only allowed at the end of a layout. Trailing absent optional fields are left out of the block.
+    template<typename Wire, auto... Path>
+    struct SBEOptionalField : SBEField<Wire, Path...> {
+        static constexpr bool OPTIONAL = true;
+
+        template<typename Message>
+        static auto present(const Message& message) noexcept { return SBEField<Wire, Path...>::member(message) != 0; }
+    };
+
+    // Layout of the message template TemplateId, each of Fields at the sum of the sizes of the fields before it
+    template<uint8_t TemplateId, uint8_t Version, typename... Fields>
+    struct SBEMessage {
+        static constexpr uint8_t TEMPLATE_ID = TemplateId;
+        static constexpr uint8_t VERSION = Version;
+        static constexpr size_t BLOCK_LENGTH = (Fields::SIZE + ... + 0);
+        static constexpr size_t MAX_LENGTH = sizeof(SBEMessageHeader) + BLOCK_LENGTH;
+
+        static constexpr auto OFFSETS = []() {
+            std::array<size_t, sizeof...(Fields)> offsets{};
+            size_t offset = 0, i = 0;
+            ((offsets[i++] = offset, offset += Fields::SIZE), ...);
+            return offsets;
+        }();
+
+        static_assert(TemplateId, "Template id 0 is reserved for unknown templates.");
+        static_assert(BLOCK_LENGTH <= std::numeric_limits<uint16_t>::max(), "Block too long for SBEMessageHeader.");
+        static_assert([]() {
+            bool optional = false, trailing = true;
+            ((trailing = trailing && (!optional || Fields::OPTIONAL), optional = optional || Fields::OPTIONAL), ...);
+            return trailing;
+        }(), "Optional fields must come after all required fields.");
+
+        // Encode message to dst, which must hold MAX_LENGTH bytes, and return the length written
+        template<typename Message>
+        static auto encode(const Message& message, char* dst) noexcept -> size_t {
+            return encode(message, dst, std::index_sequence_for<Fields...>{});
+        }
+
+        // Decode the block_length bytes at block into message, fields past the end of the block are left as they are
+        template<typename Message>
+        static auto decodeBlock(const char* block, size_t block_length, Message* message) noexcept -> void {
+            decodeBlock(block, block_length, message, std::index_sequence_for<Fields...>{});
+        }
+
+    private:
+        template<typename Message, size_t... I>
+        static auto encode(const Message& message, char* dst, std::index_sequence<I...>) noexcept -> size_t {
+            const auto block = dst + sizeof(SBEMessageHeader);
+            size_t block_length = 0;
+            ((Fields::encode(message, block + OFFSETS[I]), block_length = (Fields::present(message) ? OFFSETS[I] + Fields::SIZE : block_length)), ...);
+
+            sbeStore<uint16_t>(dst, static_cast<uint16_t>(block_length));
+            dst[offsetof(SBEMessageHeader, template_id_)] = static_cast<char>(TemplateId);
+            dst[offsetof(SBEMessageHeader, version_)] = static_cast<char>(Version);
+            return sizeof(SBEMessageHeader) + block_length;
+        }
+
+        template<typename Message, size_t... I>
+        static auto decodeBlock(const char* block, size_t block_length, Message* message, std::index_sequence<I...>) noexcept -> void {
+            ((OFFSETS[I] + Fields::SIZE <= block_length ? Fields::decode(block + OFFSETS[I], *message) : void()), ...);
+        }
+    };
+
+    // Set of SBEMessages sharing a Message type, dispatching on the template id
+    template<typename... Messages>
+    struct SBESchema {
+        static constexpr size_t MAX_LENGTH = std::max({Messages::MAX_LENGTH...});
+
+        // Encode message to dst, which must hold MAX_LENGTH bytes, as template_id. Returns the length written, 0 for a template not in the schema.
+        template<typename Message>
+        static auto encode(uint8_t template_id, const Message& message, char* dst) noexcept -> size_t {
+            size_t len = 0;
+            ((template_id == Messages::TEMPLATE_ID && (len = Messages::encode(message, dst), true)) || ...);
+            return len;
+        }
+
+        // Decode the message at src, of which len bytes are readable, into message, which is reset first. Returns the length of the message,
+        // 0 if it is not all readable yet. *template_id is set to the template decoded, 0 for one not in the schema, which is skipped.
+        template<typename Message>
+        static auto decode(const char* src, size_t len, Message* message, uint8_t* template_id) noexcept -> size_t {
+            if(len < sizeof(SBEMessageHeader))
+                return 0;
+            const auto block_length = sbeLoad<uint16_t>(src);
+            if(len < sizeof(SBEMessageHeader) + block_length)
+                return 0;
+
+            *template_id = static_cast<uint8_t>(src[offsetof(SBEMessageHeader, template_id_)]);
+            const auto block = src + sizeof(SBEMessageHeader);
+            const auto known = ((*template_id == Messages::TEMPLATE_ID && (*message = Message{}, Messages::decodeBlock(block, block_length, message), true)) || ...);
+            if(!known)
+                *template_id = 0;
+            return sizeof(SBEMessageHeader) + block_length;
+        }
+    };
+}
@@ -1,6 +1,18 @@
 #include "tcp_server.h"
 
 namespace Common {
+    TCPServer::TCPServer(Logger& logger, TCPBackend backend, const IOUringCfg& uring_cfg, const TCPSocketPoolCfg& pool_cfg)
+    : listener_socket_(logger), logger_(logger), backend_(backend), uring_cfg_(uring_cfg), pool_cfg_(pool_cfg) {
+        socket_pool_.reserve(pool_cfg_.num_sockets_);
+        free_sockets_.reserve(pool_cfg_.num_sockets_);
+        for(size_t i = 0; i < pool_cfg_.num_sockets_; ++i) {
+            socket_pool_.push_back(std::make_unique<TCPSocket>(logger_, TCPBackend::EPOLL, IOUringCfg{}, pool_cfg_.buffer_cfg_));
+            free_sockets_.push_back(socket_pool_.back().get());
+        }
+        // Hand sockets out in construction order
+        std::reverse(free_sockets_.begin(), free_sockets_.end());
+    }
+
     // Add and remove socket file descriptors to and from the EPOOL list
     auto TCPServer::addToEpollList(TCPSocket* socket){
         epoll_event ev{EPOLLET | EPOLLIN, {reinterpret_cast<void*>(socket)}};
@@ -9,17 +21,27 @@ namespace Common {
 
     // Start listening for connections on the provided interface and port
     auto TCPServer::listen(const std::string& iface, int port) -> void {
-        epoll_fd_ = epoll_create(1);
-        ASSERT(epoll_fd_ >= 0, "epoll_create() failed error:" + std::string(std::strerror(errno)));
+        logger_.log("%:% %() % backend:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), tcpBackendToString(backend_));
         ASSERT(listener_socket_.connect("", iface, port, true) >= 0,
         "Listener socket failed to connect. iface:" + iface + " port:" + std::to_string(port) + " error:"
         + std::string(std::strerror(errno)));
 
+        if(backend_ == TCPBackend::IO_URING) {
+            uring_ = std::make_unique<IOUring>(uring_cfg_);
+            armAccept();
+            uring_->submit();
+            return;
+        }
+
+        epoll_fd_ = epoll_create(1);
+        ASSERT(epoll_fd_ >= 0, "epoll_create() failed error:" + std::string(std::strerror(errno)));
         ASSERT(addToEpollList(&listener_socket_), "epoll_ctl() failed. error" + std::string(std::strerror(errno)));
     }
 
     // Publish outgoing data from the send buffer and read incoming data from the receive buffer
     auto TCPServer::sendAndRecv() noexcept -> void {
+        releaseSockets();
+
         auto recv = false;
 
         std::for_each(receive_sockets_.begin(), receive_sockets_.end(), [&recv](auto socket){
@@ -29,13 +51,114 @@ namespace Common {
         if (recv)
             recev_finished_callback_();
         
+        // Sockets the epoll loop reported writable again after the kernel refused part of their backlog
         std::for_each(send_sockets_.begin(), send_sockets_.end(), [](auto socket) {
-            socket->sendAndRecv();
+            socket->flushSend();
+        });
+        send_sockets_.clear();
+
+        if(uring_)
+            uring_->submit();
+    }
+
+    // Multishot accept, the kernel posts a completion with the new file descriptor for every incoming connection
+    auto TCPServer::armAccept() noexcept -> void {
+        auto sqe = uring_->getSqe();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = listener_socket_.socket_fd_;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->user_data = reinterpret_cast<uint64_t>(&listener_socket_) | static_cast<uint64_t>(TCPUringOp::ACCEPT);
+    }
+
+    auto TCPServer::acquireSocket() -> TCPSocket* {
+        if(LIKELY(!free_sockets_.empty())) {
+            auto socket = free_sockets_.back();
+            free_sockets_.pop_back();
+            socket->reset();
+            return socket;
+        }
+
+        if(!pool_cfg_.grow_)
+            return nullptr;
+
+        logger_.log("%:% %() % socket pool of % exhausted, allocating another %\n", __FILE__, __LINE__, __FUNCTION__,
+            Common::getCurrentTimeStr(&time_str_), socket_pool_.size(), pool_cfg_.toString());
+        socket_pool_.push_back(std::make_unique<TCPSocket>(logger_, TCPBackend::EPOLL, IOUringCfg{}, pool_cfg_.buffer_cfg_));
+        return socket_pool_.back().get();
+    }
+
+    auto TCPServer::releaseSockets() noexcept -> void {
+        for(size_t i = 0; i < receive_sockets_.size();) {
+            auto socket = receive_sockets_[i];
+            if(LIKELY(!socket->disconnected_) || !socket->closeConnection()) {
+                ++i;
+                continue;
+            }
+
+            receive_sockets_.erase(receive_sockets_.begin() + i);
+            send_sockets_.erase(std::remove(send_sockets_.begin(), send_sockets_.end(), socket), send_sockets_.end());
+            if(disconnect_callback_)
+                disconnect_callback_(socket);
+
+            socket->reset();
+            free_sockets_.push_back(socket);
+            logger_.log("%:% %() % released socket, free sockets:%\n", __FILE__, __LINE__, __FUNCTION__,
+                Common::getCurrentTimeStr(&time_str_), free_sockets_.size());
+        }
+    }
+
+    // Take a pooled TCPSocket for an accepted connection and add it to our containers
+    auto TCPServer::addSocket(int fd) -> void {
+        auto socket = acquireSocket();
+        if(UNLIKELY(!socket)) {
+            logger_.log("%:% %() % refusing socket:%, socket pool of % exhausted\n", __FILE__, __LINE__, __FUNCTION__,
+                Common::getCurrentTimeStr(&time_str_), fd, socket_pool_.size());
+            close(fd);
+            return;
+        }
+
+        ASSERT(setNonBlocking(fd) && setNoDelay(fd), 
+            "Failed to set non-blocking or no-delay on socket:" + std::to_string(fd));
+        logger_.log("%:% %() % accepted socket:%\n", __FILE__, __LINE__, __FUNCTION__,
+            Common::getCurrentTimeStr(&time_str_), fd);
+
+        socket->socket_fd_ = fd;
+        socket->recv_callback_ = recv_callback_;
+        if(uring_)
+            socket->attach(uring_.get());
+        else {
+            ASSERT(addToEpollList(socket), "Unable to add socket. error:"+std::string(std::strerror(errno)));
+            socket->epoll_fd_ = epoll_fd_;
+        }
+        if (std::find(receive_sockets_.begin(), receive_sockets_.end(), socket) == receive_sockets_.end())
+                receive_sockets_.push_back(socket);
+    }
+
+    // Reap completions for the listener and every accepted socket. Received data is buffered on its socket and dispatched in sendAndRecv().
+    auto TCPServer::uringPoll() noexcept -> void {
+        uring_->forEachCompletion([this](auto cqe) {
+            const auto op = static_cast<TCPUringOp>(cqe->user_data & TCPUringOpMask);
+            if(op != TCPUringOp::ACCEPT) {
+                reinterpret_cast<TCPSocket*>(cqe->user_data & ~TCPUringOpMask)->onCompletion(cqe);
+                return;
+            }
+
+            if(cqe->res >= 0)
+                addSocket(cqe->res);
+            else
+                logger_.log("%:% %() % accept failed error:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), std::strerror(-cqe->res));
+            if(!(cqe->flags & IORING_CQE_F_MORE))
+                armAccept();
         });
     }
 
     // Check for new connections or dead connections and update containers that tracks the sockets
     auto TCPServer::poll() noexcept -> void {
+        if(uring_) {
+            uringPoll();
+            return;
+        }
+
         const int max_events = 1 + send_sockets_.size() +  receive_sockets_.size();
 
         const int n = epoll_wait(epoll_fd_, events_, max_events, 0);
@@ -65,6 +188,7 @@ namespace Common {
             {
                 logger_.log("%:% %() % EPOLLOUT socket:%\n", __FILE__, __LINE__, __FUNCTION__,
                 Common::getCurrentTimeStr(&time_str_), socket->socket_fd_);
+                socket->send_blocked_ = false;
                 if (std::find(send_sockets_.begin(), send_sockets_.end(), socket) == send_sockets_.end())
                     send_sockets_.push_back(socket);
             }   
@@ -89,17 +213,7 @@ namespace Common {
             if (fd == -1)
                 break;
 
-            ASSERT(setNonBlocking(fd) && setNoDelay(fd), 
-                "Failed to set non-blocking or no-delay on socket:" + std::to_string(fd));
-            logger_.log("%:% %() % accepted socket:%\n", __FILE__, __LINE__, __FUNCTION__,
-                Common::getCurrentTimeStr(&time_str_), fd);
-
-            auto socket = new TCPSocket(logger_);
-            socket->socket_fd_ = fd;
-            socket->recv_callback_ = recv_callback_;
-            ASSERT(addToEpollList(socket), "Unable to add socket. error:"+std::string(std::strerror(errno)));
-            if (std::find(receive_sockets_.begin(), receive_sockets_.end(), socket) == receive_sockets_.end())
-                    receive_sockets_.push_back(socket);
+            addSocket(fd);
         }
     }
 }
\ No newline at end of file
@@ -4,11 +4,29 @@
 #include <sys/epoll.h>
 
 namespace Common {
-    struct TCPServer {
-        explicit TCPServer(Logger& logger)
-        : listener_socket_(logger), logger_(logger) {
+    // Number of TCPSockets a TCPServer preallocates for the connections it accepts
+    constexpr size_t TCPServerPoolSize = 64;
+
+    struct TCPSocketPoolCfg {
+        size_t num_sockets_ = TCPServerPoolSize;
+        // Allocate another socket when the pool is exhausted, stalling that accept, instead of refusing the connection
+        bool grow_ = true;
+        TCPBufferCfg buffer_cfg_;
 
+        auto toString() const {
+            std::stringstream ss;
+            ss << "TCPSocketPoolCfg[num_sockets:" << num_sockets_
+               << " grow:" << grow_
+               << " " << buffer_cfg_.toString()
+               << "]";
+            return ss.str();
         }
+    };
+
+    struct TCPServer {
+        // Sockets and their buffers for accepted connections are all allocated here, so accepting never allocates on the poll loop
+        explicit TCPServer(Logger& logger, TCPBackend backend = TCPBackend::EPOLL, const IOUringCfg& uring_cfg = {},
+                            const TCPSocketPoolCfg& pool_cfg = {});
 
         // Start listening for connections on the provided interface and port.
         auto listen(const std::string& iface, int port) -> void;
@@ -23,6 +41,16 @@ namespace Common {
             // Add and remove socket file descriptors to and from the EPOLL list
             auto addToEpollList(TCPSocket* socket);
 
+            // io_uring backend, accepts through a multishot accept on the listener and reaps completions for all accepted sockets
+            auto armAccept() noexcept -> void;
+            auto uringPoll() noexcept -> void;
+            auto addSocket(int fd) -> void;
+
+            // Next pooled socket for an accepted connection, nullptr if the pool is exhausted and not allowed to grow
+            auto acquireSocket() -> TCPSocket*;
+            // Close the sockets of connections which are gone and return them to the pool once nothing is in flight on them
+            auto releaseSockets() noexcept -> void;
+
         public:
             // Socket on which this server is listening for new connections
             int epoll_fd_ = -1;
@@ -37,8 +65,19 @@ namespace Common {
             std::function<void(TCPSocket* s, Nanos rx_time)> recv_callback_ = nullptr;
             // Function wrapper to call back when all data accross all TCPSockets has been read and dispatched this round
             std::function<void()> recev_finished_callback_ = nullptr;
+            // Function wrapper to call back when a connection is gone, right before its socket is reset and returned to the pool
+            std::function<void(TCPSocket* s)> disconnect_callback_ = nullptr;
 
             std::string time_str_;
             Logger& logger_;
+
+            const TCPBackend backend_;
+            const IOUringCfg uring_cfg_;
+            std::unique_ptr<IOUring> uring_;
+
+            // Owns every socket handed out to a connection, free_sockets_ are the ones not handed out to a live connection
+            const TCPSocketPoolCfg pool_cfg_;
+            std::vector<std::unique_ptr<TCPSocket>> socket_pool_;
+            std::vector<TCPSocket*> free_sockets_;
     };
 }
\ No newline at end of file
@@ -9,21 +9,159 @@ namespace Common {
         socket_attrib_.sin_port = htons(port);
         socket_attrib_.sin_family = AF_INET;
 
+        if(backend_ == TCPBackend::IO_URING && !is_listening && socket_fd_ >= 0) {
+            owned_uring_ = std::make_unique<IOUring>(uring_cfg_);
+            attach(owned_uring_.get());
+            owned_uring_->submit();
+        }
+
         return socket_fd_;
     }
 
+    auto TCPSocket::attach(IOUring* uring) -> void {
+        uring_ = uring;
+        fixed_file_ = uring_->registerFile(socket_fd_);
+        ASSERT(fixed_file_ >= 0, "Unable to register socket:" + std::to_string(socket_fd_) + " with io_uring, registered file table full or error:"
+            + std::string(std::strerror(errno)));
+
+        logger_.log("%:% %() % socket:% fixed_file:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            socket_fd_, fixed_file_, uring_->cfg().toString());
+        armRecv();
+    }
+
+    // Multishot receive, the kernel posts a completion with one of the ring's provided buffers every time data arrives
+    auto TCPSocket::armRecv() noexcept -> void {
+        auto sqe = uring_->getSqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = fixed_file_;
+        sqe->flags = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->buf_group = IOUring::RECV_BUFFER_GROUP;
+        sqe->user_data = reinterpret_cast<uint64_t>(this) | static_cast<uint64_t>(TCPUringOp::RECV);
+        recv_armed_ = true;
+    }
+
+    // Asynchronous send of the contiguous part of the backlog starting at send_head_, the rest follows once it completes
+    auto TCPSocket::submitSend() noexcept -> void {
+        const auto head = send_head_ % outbound_data_.size();
+        inflight_len_ = std::min(sendBacklog(), outbound_data_.size() - head);
+
+        auto sqe = uring_->getSqe();
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = fixed_file_;
+        sqe->flags = IOSQE_FIXED_FILE;
+        sqe->addr = reinterpret_cast<uint64_t>(outbound_data_.data() + head);
+        sqe->len = static_cast<uint32_t>(inflight_len_);
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = reinterpret_cast<uint64_t>(this) | static_cast<uint64_t>(TCPUringOp::SEND);
+    }
+
+    // Account for the result of handing offered bytes of the backlog to the kernel
+    auto TCPSocket::onSent(ssize_t n, size_t offered) noexcept -> void {
+        if(LIKELY(n > 0)) {
+            send_head_ += n;
+            send_stats_.bytes_sent_ += n;
+            if(static_cast<size_t>(n) < offered)
+                ++send_stats_.partial_sends_;
+            return;
+        }
+
+        const auto error = (n < 0 ? static_cast<int>(-n) : EAGAIN);
+        if(error == EAGAIN || error == EWOULDBLOCK || error == ENOTCONN) { // send buffer full or still connecting, keep the backlog
+            ++send_stats_.would_block_;
+            return;
+        }
+
+        // The connection is broken, nothing buffered will ever be delivered
+        logger_.log("%:% %() % socket:% send failed, dropping backlog:% error:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            socket_fd_, sendBacklog(), std::strerror(error));
+        send_head_ = send_tail_;
+        disconnected_ = true;
+    }
+
+    auto TCPSocket::onCompletion(const io_uring_cqe* cqe) noexcept -> void {
+        const auto op = static_cast<TCPUringOp>(cqe->user_data & TCPUringOpMask);
+
+        if(op == TCPUringOp::RECV) {
+            if(cqe->res > 0) {
+                const auto buffer_id = static_cast<uint16_t>(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+                if(UNLIKELY(static_cast<size_t>(cqe->res) > inbound_data_.writable() && !growRecvBuffer(cqe->res)))
+                    FATAL("Receive buffer overflow on socket:" + std::to_string(socket_fd_) + " " + buffer_cfg_.toString());
+                memcpy(inbound_data_.writePtr(), uring_->recvBuffer(buffer_id), cqe->res);
+                uring_->recycleRecvBuffer(buffer_id);
+                inbound_data_.commit(cqe->res);
+                if(!pending_rx_time_)
+                    pending_rx_time_ = getCurrentNanos();
+            }
+
+            if(!(cqe->flags & IORING_CQE_F_MORE)) { // multishot receive terminated, re-arm unless the connection is gone
+                recv_armed_ = false;
+                if(cqe->res == -ENOBUFS && !disconnected_) {
+                    armRecv();
+                } else {
+                    logger_.log("%:% %() % socket:% receive ended res:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                        socket_fd_, cqe->res, (cqe->res < 0 ? std::strerror(-cqe->res) : "connection closed"));
+                    disconnected_ = true;
+                }
+            }
+            return;
+        }
+
+        if(op == TCPUringOp::SEND) {
+            const auto offered = inflight_len_;
+            inflight_len_ = 0;
+            onSent(cqe->res, offered);
+        }
+    }
+
+    auto TCPSocket::uringSendAndRecv() noexcept -> bool {
+        if(owned_uring_)
+            owned_uring_->forEachCompletion([this](auto cqe) { onCompletion(cqe); });
+
+        const auto rx_time = pending_rx_time_;
+        if(rx_time) {
+            pending_rx_time_ = 0;
+            logger_.log("%:% %() % read socket:% len:% utime:%\n", __FILE__, __LINE__, __FUNCTION__,
+                Common::getCurrentTimeStr(&time_str_), socket_fd_, inbound_data_.readable(), rx_time);
+            recv_callback_(this, rx_time);
+        }
+
+        if(!inflight_len_ && sendBacklog() && !disconnected_)
+            submitSend();
+
+        if(owned_uring_)
+            owned_uring_->submit();
+
+        return rx_time != 0;
+    }
+
     // Called to publish outgoing data from the buffers as well as check for and callback if data is available in the read buffers
     auto TCPSocket::sendAndRecv() noexcept -> bool {
+        if(uring_)
+            return uringSendAndRecv();
+
         char ctrl[CMSG_SPACE(sizeof(struct timeval))];
         auto cmsg = reinterpret_cast<struct cmsghdr*>(&ctrl);
 
-        iovec iov{inbound_data_.data() + next_rcv_valid_index_, TCPBufferSize - next_rcv_valid_index_};
+        // The receive callback left the buffer full of partial data, make room to read the rest of it. Past max_buffer_size_ the data is
+        // left in the kernel, a zero-length read would return 0 and look like the peer closing the connection.
+        if(UNLIKELY(!inbound_data_.writable()) && !growRecvBuffer(1)) {
+            if(!recv_full_)
+                logger_.log("%:% %() % ERROR socket:% receive buffer full at:%, reads paused\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getCurrentTimeStr(&time_str_), socket_fd_, inbound_data_.capacity());
+            recv_full_ = true;
+            flushSend();
+            return false;
+        }
+        recv_full_ = false;
+
+        iovec iov{inbound_data_.writePtr(), inbound_data_.writable()};
         msghdr msg{&socket_attrib_, sizeof(socket_attrib_), &iov, 1, ctrl, sizeof(ctrl), 0};
 
         // Non-blocking call to read available data
         const auto read_size = recvmsg(socket_fd_, &msg, MSG_DONTWAIT);
         if(read_size > 0) {
-            next_rcv_valid_index_ += read_size;
+            inbound_data_.commit(read_size);
 
             Nanos kernel_time = 0;
             timeval time_kernel;
@@ -37,26 +175,160 @@ namespace Common {
             
             const auto user_time = getCurrentNanos();
             logger_.log("%:% %() % read socket:% len:% utime:% ktime:% diff:%\n", __FILE__, __LINE__, __FUNCTION__,
-            Common::getCurrentTimeStr(&time_str_), socket_fd_, next_rcv_valid_index_, user_time, kernel_time, (user_time-kernel_time));
+            Common::getCurrentTimeStr(&time_str_), socket_fd_, inbound_data_.readable(), user_time, kernel_time, (user_time-kernel_time));
             recv_callback_(this, kernel_time);
+        } else if(read_size == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) { // orderly shutdown by the peer or a broken connection
+            if(!disconnected_)
+                logger_.log("%:% %() % socket:% receive ended res:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                    socket_fd_, read_size, (read_size < 0 ? std::strerror(errno) : "connection closed"));
+            disconnected_ = true;
         }
 
-        if (next_send_valid_index_ > 0)
-        {
-            // Non-blocking call to send the data
-            const auto n = ::send(socket_fd_, outbound_data_.data(), next_send_valid_index_, MSG_DONTWAIT | MSG_NOSIGNAL);
-            logger_.log("%:% %() % send socket:% len:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), socket_fd_, n);  
-        }
-        next_send_valid_index_ = 0;
+        flushSend();
 
         return read_size > 0;
     }
 
-    // Write outgoind data to the send buffers
-    auto TCPSocket::send(const void* data, size_t len) noexcept -> void {
-        if(len > 0) {
-            memcpy(outbound_data_.data() + next_send_valid_index_, data, len);
-            next_send_valid_index_ += len;
+    auto TCPSocket::flushSend() noexcept -> void {
+        const auto backlog = sendBacklog();
+        if(!backlog || send_blocked_ || disconnected_)
+            return;
+
+        // The backlog wraps around the end of the ring at most once, so it goes out straight from the ring in up to two iovecs
+        const auto head = send_head_ % outbound_data_.size();
+        const auto first_len = std::min(backlog, outbound_data_.size() - head);
+        iovec iov[2] = {{outbound_data_.data() + head, first_len}, {outbound_data_.data(), backlog - first_len}};
+        msghdr msg{nullptr, 0, iov, static_cast<size_t>(first_len < backlog ? 2 : 1), nullptr, 0, 0};
+
+        // Non-blocking call to send the data
+        const auto n = ::sendmsg(socket_fd_, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        logger_.log("%:% %() % send socket:% len:% backlog:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), socket_fd_, n, backlog);
+        onSent(n < 0 ? -errno : n, backlog);
+
+        send_blocked_ = (sendBacklog() && epoll_fd_ >= 0);
+        updateSendInterest();
+    }
+
+    // Keep EPOLLOUT armed exactly while sending is blocked, so writable notifications only arrive when there is a backlog to flush
+    auto TCPSocket::updateSendInterest() noexcept -> void {
+        if(epoll_fd_ < 0 || epollout_armed_ == send_blocked_)
+            return;
+
+        epoll_event ev{EPOLLET | EPOLLIN, {reinterpret_cast<void*>(this)}};
+        if(send_blocked_)
+            ev.events |= EPOLLOUT;
+        if(LIKELY(!epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, socket_fd_, &ev)))
+            epollout_armed_ = send_blocked_;
+    }
+
+    // Append outgoing data to the outbound ring
+    auto TCPSocket::send(const void* data, size_t len) noexcept -> bool {
+        if(UNLIKELY(!reserveSend(len))) {
+            ++send_stats_.overflows_;
+            logger_.log("%:% %() % socket:% outbound ring full, dropping len:% backlog:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                socket_fd_, len, sendBacklog());
+            return false;
         }
+
+        const auto tail = send_tail_ % outbound_data_.size();
+        const auto first_len = std::min(len, outbound_data_.size() - tail);
+        memcpy(outbound_data_.data() + tail, data, first_len);
+        memcpy(outbound_data_.data(), static_cast<const char*>(data) + first_len, len - first_len);
+        send_tail_ += len;
+        send_stats_.max_backlog_ = std::max(send_stats_.max_backlog_, sendBacklog());
+
+        return true;
+    }
+
+    auto TCPSocket::reserveSend(size_t len) noexcept -> bool {
+        return LIKELY(len <= sendSpace()) || growSendBuffer(len);
+    }
+
+    auto TCPSocket::growSendBuffer(size_t len) noexcept -> bool {
+        // An asynchronous send still points into the current buffer, it cannot move until that completes
+        const auto backlog = sendBacklog();
+        if(backlog + len > buffer_cfg_.max_buffer_size_ || inflight_len_)
+            return false;
+
+        auto new_size = outbound_data_.size();
+        while(new_size < backlog + len)
+            new_size = std::min(2 * new_size, buffer_cfg_.max_buffer_size_);
+
+        // Unwrap the backlog to the start of the new ring
+        std::vector<char> grown(new_size);
+        const auto head = send_head_ % outbound_data_.size();
+        const auto first_len = std::min(backlog, outbound_data_.size() - head);
+        memcpy(grown.data(), outbound_data_.data() + head, first_len);
+        memcpy(grown.data() + first_len, outbound_data_.data(), backlog - first_len);
+        outbound_data_.swap(grown);
+        send_head_ = 0;
+        send_tail_ = backlog;
+        ++send_stats_.grows_;
+
+        logger_.log("%:% %() % socket:% outbound ring grown to:% backlog:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            socket_fd_, new_size, backlog);
+        return true;
+    }
+
+    auto TCPSocket::growRecvBuffer(size_t len) noexcept -> bool {
+        const auto pending = inbound_data_.readable();
+        if(pending + len > buffer_cfg_.max_buffer_size_)
+            return false;
+
+        inbound_data_.grow(pending + len);
+
+        logger_.log("%:% %() % socket:% receive buffer grown to:% pending:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            socket_fd_, inbound_data_.capacity(), pending);
+        return true;
+    }
+
+    // Cancel an io_uring request of this socket, identified by the user_data it was submitted with
+    auto TCPSocket::cancel(TCPUringOp op) noexcept -> void {
+        auto sqe = uring_->getSqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = reinterpret_cast<uint64_t>(this) | static_cast<uint64_t>(op);
+        sqe->user_data = reinterpret_cast<uint64_t>(this) | static_cast<uint64_t>(TCPUringOp::CANCEL);
+    }
+
+    auto TCPSocket::closeConnection() noexcept -> bool {
+        if(uring_) {
+            // The kernel may still write into this socket's buffers and post completions for it, wait for the cancelled requests to end
+            if(recv_armed_ || inflight_len_) {
+                if(!cancel_pending_) {
+                    if(recv_armed_)
+                        cancel(TCPUringOp::RECV);
+                    if(inflight_len_)
+                        cancel(TCPUringOp::SEND);
+                    cancel_pending_ = true;
+                }
+                return false;
+            }
+            uring_->unregisterFile(fixed_file_);
+        } else if(epoll_fd_ >= 0) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, socket_fd_, nullptr);
+        }
+
+        logger_.log("%:% %() % closing socket:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            socket_fd_, send_stats_.toString());
+        ::close(socket_fd_);
+        return true;
+    }
+
+    auto TCPSocket::reset() noexcept -> void {
+        socket_fd_ = -1;
+        disconnected_ = false;
+        send_head_ = send_tail_ = 0;
+        send_stats_ = {};
+        epoll_fd_ = -1;
+        send_blocked_ = epollout_armed_ = false;
+        inbound_data_.clear();
+        socket_attrib_ = {};
+        recv_callback_ = nullptr;
+        owned_uring_.reset();
+        uring_ = nullptr;
+        fixed_file_ = -1;
+        recv_armed_ = cancel_pending_ = false;
+        pending_rx_time_ = 0;
+        inflight_len_ = 0;
     }
-}
\ No newline at end of file
+}
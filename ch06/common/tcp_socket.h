@@ -1,29 +1,128 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+
+#include <sys/epoll.h>
+#include <sys/uio.h>
 
 #include "socket_utils.h"
 #include "logging.h"
+#include "io_uring.h"
+#include "recv_buffer.h"
 
 namespace Common {
-    // Size of send  and receive buffers in bytes.
-    constexpr size_t TCPBufferSize  = 64 * 1024 * 1024;
+    // Initial size of send and receive buffers in bytes, and the size they may grow to on demand.
+    constexpr size_t TCPBufferSize  = 256 * 1024;
+    constexpr size_t TCPMaxBufferSize = 64 * 1024 * 1024;
+
+    struct TCPBufferCfg {
+        size_t send_buffer_size_ = TCPBufferSize;
+        size_t recv_buffer_size_ = TCPBufferSize;
+        // Buffers double when data does not fit, up to this size. Set it to the initial sizes to never grow.
+        size_t max_buffer_size_ = TCPMaxBufferSize;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "TCPBufferCfg[send:" << send_buffer_size_
+               << " recv:" << recv_buffer_size_
+               << " max:" << max_buffer_size_
+               << "]";
+            return ss.str();
+        }
+    };
+
+    // Kernel interface used to move data on TCPSockets and to accept connections in TCPServer
+    enum class TCPBackend : uint8_t {
+        EPOLL = 0,   // epoll readiness and a non-blocking recvmsg() + send() per socket on every sendAndRecv()
+        IO_URING = 1 // multishot receives and asynchronous sends on an io_uring, no syscalls on idle sockets
+    };
+
+    inline std::string tcpBackendToString(TCPBackend backend) {
+        switch (backend)
+        {
+        case TCPBackend::EPOLL:
+            return "EPOLL";
+        case TCPBackend::IO_URING:
+            return "IO_URING";
+        default:
+            return "UNKNOWN";
+        }
+    }
+
+    // Operation an io_uring completion belongs to, encoded in the low bits of its user_data next to the TCPSocket pointer
+    enum class TCPUringOp : uint64_t {
+        RECV = 1,
+        SEND = 2,
+        ACCEPT = 3,
+        CANCEL = 4
+    };
+    constexpr uint64_t TCPUringOpMask = 0x7;
+
+    // Counters for the outbound path of a TCPSocket
+    struct TCPSendStats {
+        size_t bytes_sent_ = 0;
+        size_t partial_sends_ = 0; // the kernel accepted only part of the backlog
+        size_t would_block_ = 0;   // the kernel send buffer was full and accepted nothing
+        size_t overflows_ = 0;     // send() calls rejected because the outbound ring was full
+        size_t max_backlog_ = 0;
+        size_t grows_ = 0;         // the outbound ring was reallocated larger to take a send()
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "TCPSendStats[bytes_sent:" << bytes_sent_
+               << " partial_sends:" << partial_sends_
+               << " would_block:" << would_block_
+               << " overflows:" << overflows_
+               << " max_backlog:" << max_backlog_
+               << " grows:" << grows_
+               << "]";
+            return ss.str();
+        }
+    };
 
     struct TCPSocket {
-        explicit TCPSocket(Logger& logger)
-        : logger_(logger) {
-            outbound_data_.resize(TCPBufferSize);
-            inbound_data_.resize(TCPBufferSize);
+        explicit TCPSocket(Logger& logger, TCPBackend backend = TCPBackend::EPOLL, const IOUringCfg& uring_cfg = {}, const TCPBufferCfg& buffer_cfg = {})
+        : logger_(logger), buffer_cfg_(buffer_cfg), inbound_data_(buffer_cfg.recv_buffer_size_), backend_(backend), uring_cfg_(uring_cfg) {
+            ASSERT(buffer_cfg_.send_buffer_size_, "TCPSocket send buffer cannot be empty. " + buffer_cfg_.toString());
+            // Sized and zero filled, i.e. faulted in, up front so the first messages do not pay for it
+            outbound_data_.resize(buffer_cfg_.send_buffer_size_);
         }
 
+        // Return a socket to its freshly constructed state, keeping its buffers, so TCPServer can hand it to the next connection
+        auto reset() noexcept -> void;
+
         // Create TCPSocket with provided attributes to either listen on / connect to
         auto connect(const std::string& ip, const std::string& iface, int port, bool is_listening) -> int;
 
         // Called to publish outgoing data from the buffers as well as check and callback if data is available in the read buffers
         auto sendAndRecv() noexcept -> bool;
 
-        // Write outgoing data to the send buffers
-        auto send(const void* data, size_t len) noexcept -> void;
+        // Append outgoing data to the outbound ring, all or nothing. Returns false, dropping the data, if the ring cannot hold all of it,
+        // so callers that must not lose data check sendSpace() for a whole message first and hold it back otherwise.
+        auto send(const void* data, size_t len) noexcept -> bool;
+
+        // Hand as much of the outbound ring to the kernel as it accepts, called from sendAndRecv()
+        auto flushSend() noexcept -> void;
+
+        // Bytes buffered but not yet accepted by the kernel, and room left in the outbound ring
+        auto sendBacklog() const noexcept { return send_tail_ - send_head_; }
+        auto sendSpace() const noexcept { return outbound_data_.size() - sendBacklog(); }
+
+        // Make room for len more bytes in the outbound ring, growing it if the buffer configuration allows.
+        // False if the ring cannot take them now, callers holding back whole messages check this before send().
+        auto reserveSend(size_t len) noexcept -> bool;
+
+        // Switch this socket to the io_uring backend on a ring owned by someone else, i.e. the TCPServer which accepted it.
+        // Registers the socket with the ring and arms a multishot receive on it.
+        auto attach(IOUring* uring) -> void;
+
+        // Handle a completion for this socket reaped from the ring it is attached to
+        auto onCompletion(const io_uring_cqe* cqe) noexcept -> void;
+
+        // Stop all I/O on a socket whose connection is gone and close its file descriptor. False while io_uring requests on it are
+        // still in flight, they are cancelled and it has to be called again until they completed.
+        auto closeConnection() noexcept -> bool;
 
         TCPSocket() = delete;
         TCPSocket(const TCPSocket&) = delete;
@@ -33,14 +132,29 @@ namespace Common {
 
         // File descriptor for the socket
         int socket_fd_ = -1;
+        // The peer closed the connection or it failed, nothing more is sent or received on it
+        bool disconnected_ = false;
 
         Logger& logger_;
+        const TCPBufferCfg buffer_cfg_;
 
-        // Send and receive buffers and trackers for read/write indices
+        // Outbound ring, send() appends at send_tail_ and everything before send_head_ has been accepted by the kernel.
+        // Both count bytes since the socket was created and are wrapped into outbound_data_ on access.
         std::vector<char> outbound_data_;
-        size_t next_send_valid_index_ = 0;
-        std::vector<char> inbound_data_;
-        size_t next_rcv_valid_index_ = 0;
+        size_t send_head_ = 0;
+        size_t send_tail_ = 0;
+        TCPSendStats send_stats_;
+
+        // Set by TCPServer for the sockets it accepts. EPOLLOUT is only armed while the kernel has refused part of the backlog,
+        // and flushSend() makes no further attempts until the epoll loop reports the socket writable again.
+        int epoll_fd_ = -1;
+        bool send_blocked_ = false;
+        bool epollout_armed_ = false;
+
+        // Receive buffer, recv_callback_ parses messages in place and consumes them
+        RecvBuffer inbound_data_;
+        // inbound_data_ is full at max_buffer_size_, reads are skipped until recv_callback_ has consumed some of it
+        bool recv_full_ = false;
 
         // Socket attributes
         struct sockaddr_in socket_attrib_{};
@@ -49,5 +163,30 @@ namespace Common {
         std::function<void(TCPSocket* s, Nanos rx_time)> recv_callback_ = nullptr;
 
         std::string time_str_;
+
+        // io_uring backend state. uring_ is either owned_uring_, created on connect(), or the ring of the TCPServer which accepted this socket.
+        const TCPBackend backend_;
+        const IOUringCfg uring_cfg_;
+        std::unique_ptr<IOUring> owned_uring_;
+        IOUring* uring_ = nullptr;
+        int fixed_file_ = -1;
+        bool recv_armed_ = false;
+        bool cancel_pending_ = false;
+        // Time the first receive completion not yet passed to recv_callback_ was reaped, 0 if there is none
+        Nanos pending_rx_time_ = 0;
+
+        // Length of the asynchronous send in flight starting at send_head_, at most one is outstanding so the stream stays ordered
+        size_t inflight_len_ = 0;
+
+        private:
+            auto uringSendAndRecv() noexcept -> bool;
+            auto armRecv() noexcept -> void;
+            auto cancel(TCPUringOp op) noexcept -> void;
+            auto submitSend() noexcept -> void;
+            auto onSent(ssize_t n, size_t offered) noexcept -> void;
+            auto updateSendInterest() noexcept -> void;
+            // Reallocate the buffers so that at least len more bytes fit, false if that would exceed max_buffer_size_
+            auto growSendBuffer(size_t len) noexcept -> bool;
+            auto growRecvBuffer(size_t len) noexcept -> bool;
     };
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <ctime>
 #include <string>
 
+#include "macros.h"
+
 namespace Common {
     typedef int64_t Nanos;
     constexpr Nanos NANOS_TO_MICROS = 1000;
@@ -15,15 +17,24 @@ namespace Common {
         return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
     }
 
+    // The string only changes once a second, so it is formatted once per second and thread instead of on every call,
+    // ctime() and the timezone lookup behind it cost microseconds.
     inline auto& getCurrentTimeStr(std::string* time_str) {
-        const auto time = std::chrono ::system_clock::to_time_t(std::chrono::system_clock::now());
-        time_str->assign(ctime(&time));
+        thread_local time_t last_time = 0;
+        thread_local std::string last_time_str;
 
-        if (!time_str->empty())
+        const auto time = std::chrono ::system_clock::to_time_t(std::chrono::system_clock::now());
+        if (UNLIKELY(time != last_time))
         {
-            time_str->at(time_str->length()-1) = '\0';
+            last_time = time;
+            last_time_str.assign(ctime(&time));
+            if (!last_time_str.empty())
+            {
+                last_time_str.at(last_time_str.length()-1) = '\0';
+            }
         }
-        
+        time_str->assign(last_time_str);
+
         return *time_str;
     }
 }
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Common {
+    // LEB128 varints, 7 bits per byte least significant first with the top bit set on every byte but the last,
+    // and zigzag mapping of signed values so small deltas of either sign stay short.
+    constexpr size_t VARINT_MAX_LENGTH = 10;
+
+    inline auto zigzagEncode(int64_t value) noexcept -> uint64_t {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    inline auto zigzagDecode(uint64_t value) noexcept -> int64_t {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    // Write value to dst, which must hold VARINT_MAX_LENGTH bytes, and return the length written
+    inline auto varintStore(char* dst, uint64_t value) noexcept -> size_t {
+        size_t len = 0;
+        for(; value >= 0x80; value >>= 7)
+            dst[len++] = static_cast<char>(value | 0x80);
+        dst[len++] = static_cast<char>(value);
+        return len;
+    }
+
+    // Read the varint at src, which must end before end, into *value and return its length, 0 if it is truncated or too long
+    inline auto varintLoad(const char* src, const char* end, uint64_t* value) noexcept -> size_t {
+        uint64_t result = 0;
+        for(size_t len = 0; len < VARINT_MAX_LENGTH && src + len < end; ++len) {
+            const auto byte = static_cast<uint8_t>(src[len]);
+            result |= static_cast<uint64_t>(byte & 0x7f) << (7 * len);
+            if(!(byte & 0x80)) {
+                *value = result;
+                return len + 1;
+            }
+        }
+        return 0;
+    }
+}
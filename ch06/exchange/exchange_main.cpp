@@ -22,32 +22,102 @@ void signal_handler(int) {
     exit(EXIT_SUCCESS);
 }
 
-int main(int, char**) {
+// Pass --io-uring to run the OrderServer on the io_uring TCP backend, --io-uring-sqpoll to also let a kernel thread poll its submission queue.
+// --tcp-pool N preallocates N client connections and --tcp-buffer-kb KB sizes their initial send and receive buffers.
+// --md-mtu BYTES sets the MTU market data packets are filled up to, --md-ab also publishes the incremental feed on the B group.
+// --md-sbe SBE encodes the updates on the snapshot and incremental feeds, --md-delta delta and varint encodes them instead.
+// --md-stamps sends the publish time of every incremental update, which tick-to-trade measurements need.
+// Gap fills of the incremental feed are served on TCP port 12346.
+// --snapshot-interval-ms, --snapshot-rate UPDATES_PER_SEC (0 unpaced) and --snapshot-batch PACKETS control snapshot publication.
+// --mbp-depth LEVELS also publishes the top LEVELS price levels per side of every book on the market-by-price group.
+// --tob-interval-ms MS also publishes the best bid and offer of every book every MS on the top-of-book group, 0 on every change.
+int main(int argc, char** argv) {
     logger = new Common::Logger("exchange_main.log");
     std::signal(SIGINT, signal_handler);
     const int sleep_time = 100 * 1000;
     Exchange::ClientRequestLFQueue client_requests(ME_MAX_CLIENT_UPDATES);
     Exchange::ClientResponseLFQueue client_responses(ME_MAX_CLIENT_UPDATES);
     Exchange::MEMarketUpdateLFQueue market_updates(ME_MAX_MARKET_UPDATES);
+    Exchange::MEPriceLevelUpdateLFQueue price_level_updates(ME_MAX_MARKET_UPDATES);
+
+    size_t mbp_depth = 0;
+    for(int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if(arg == "--mbp-depth" && i + 1 < argc)
+            mbp_depth = strtoul(argv[++i], nullptr, 10);
+    }
 
     std::string time_str;
-    logger->log("%:% %() % Starting Matching Engine...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
-    matching_engine = new Exchange::MatchingEngine(&client_requests, &client_responses, &market_updates);
+    logger->log("%:% %() % Starting Matching Engine mbp_depth:%...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str), mbp_depth);
+    matching_engine = new Exchange::MatchingEngine(&client_requests, &client_responses, &market_updates, mbp_depth ? &price_level_updates : nullptr, mbp_depth);
     matching_engine->start();
 
     const std::string mkt_pub_iface = "lo";
-    const std::string snap_pub_ip = "233.252.14.1", inc_pub_ip = "233.252.14.3";
-    const int snap_pub_port = 20000, inc_pub_port = 20001;
+    const std::string snap_pub_ip = "233.252.14.1", inc_pub_ip = "233.252.14.3", mbp_pub_ip = "233.252.14.5";
+    const int snap_pub_port = 20000, inc_pub_port = 20001, mbp_pub_port = 20003;
+    std::string tob_pub_ip;
+    const int tob_pub_port = 20004;
+    Exchange::TopOfBookCfg tob_cfg;
+    std::string inc_b_pub_ip;
+    const int inc_b_pub_port = 20002, retransmit_port = 12346;
+    size_t mkt_pub_mtu = Exchange::MDP_DEFAULT_MTU;
+    auto mkt_pub_encoding = Exchange::MDPEncoding::RAW;
+    bool mkt_pub_stamps = false;
+    Exchange::SnapshotCfg snapshot_cfg;
+    for(int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if(arg == "--md-mtu" && i + 1 < argc)
+            mkt_pub_mtu = strtoul(argv[++i], nullptr, 10);
+        if(arg == "--md-sbe")
+            mkt_pub_encoding = Exchange::MDPEncoding::SBE;
+        if(arg == "--md-delta")
+            mkt_pub_encoding = Exchange::MDPEncoding::DELTA;
+        if(arg == "--md-stamps")
+            mkt_pub_stamps = true;
+        if(arg == "--md-ab")
+            inc_b_pub_ip = "233.252.14.4";
+        if(arg == "--snapshot-interval-ms" && i + 1 < argc)
+            snapshot_cfg.interval_ = static_cast<Common::Nanos>(strtoul(argv[++i], nullptr, 10)) * Common::NANOS_TO_MILLIS;
+        if(arg == "--snapshot-rate" && i + 1 < argc)
+            snapshot_cfg.max_updates_per_sec_ = strtoul(argv[++i], nullptr, 10);
+        if(arg == "--snapshot-batch" && i + 1 < argc)
+            snapshot_cfg.packets_per_batch_ = strtoul(argv[++i], nullptr, 10);
+        if(arg == "--tob-interval-ms" && i + 1 < argc) {
+            tob_pub_ip = "233.252.14.6";
+            tob_cfg.interval_ = static_cast<Common::Nanos>(strtoul(argv[++i], nullptr, 10)) * Common::NANOS_TO_MILLIS;
+        }
+    }
 
-    logger->log("%:% %() % Starting Market Data Publisher...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
-    market_data_publisher = new Exchange::MarketDataPublisher(&market_updates, mkt_pub_iface, snap_pub_ip, snap_pub_port, inc_pub_ip, inc_pub_port);
+    logger->log("%:% %() % Starting Market Data Publisher mtu:% encoding:% stamps:% incremental_b:% % top_of_book:% %...\n", __FILE__, __LINE__, __FUNCTION__,
+                Common::getCurrentTimeStr(&time_str), mkt_pub_mtu, Exchange::mdpEncodingToString(mkt_pub_encoding), mkt_pub_stamps, inc_b_pub_ip, snapshot_cfg.toString(),
+                tob_pub_ip, tob_cfg.toString());
+    market_data_publisher = new Exchange::MarketDataPublisher(&market_updates, mkt_pub_iface, snap_pub_ip, snap_pub_port, inc_pub_ip, inc_pub_port,
+                                                              mkt_pub_mtu, mkt_pub_encoding, mkt_pub_stamps, inc_b_pub_ip, inc_b_pub_port, retransmit_port, snapshot_cfg,
+                                                              mbp_depth ? &price_level_updates : nullptr, mbp_pub_ip, mbp_pub_port,
+                                                              tob_pub_ip, tob_pub_port, tob_cfg);
     market_data_publisher->start();
 
     const std::string order_gw_iface = "lo";
     const int order_gw_port = 12345;
+    auto order_gw_backend = Common::TCPBackend::EPOLL;
+    Common::IOUringCfg order_gw_uring_cfg;
+    Common::TCPSocketPoolCfg order_gw_pool_cfg;
+    for(int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if(arg == "--io-uring" || arg == "--io-uring-sqpoll")
+            order_gw_backend = Common::TCPBackend::IO_URING;
+        if(arg == "--io-uring-sqpoll")
+            order_gw_uring_cfg.sqpoll_ = true;
+        if(arg == "--tcp-pool" && i + 1 < argc)
+            order_gw_pool_cfg.num_sockets_ = strtoul(argv[++i], nullptr, 10);
+        if(arg == "--tcp-buffer-kb" && i + 1 < argc)
+            order_gw_pool_cfg.buffer_cfg_.send_buffer_size_ = order_gw_pool_cfg.buffer_cfg_.recv_buffer_size_ = strtoul(argv[++i], nullptr, 10) * 1024;
+    }
 
-    logger->log("%:% %() % Starting Order Server...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
-    order_server = new Exchange::OrderServer(&client_requests, &client_responses, order_gw_iface, order_gw_port);
+    logger->log("%:% %() % Starting Order Server backend:% % %...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str),
+                Common::tcpBackendToString(order_gw_backend), order_gw_uring_cfg.toString(), order_gw_pool_cfg.toString());
+    order_server = new Exchange::OrderServer(&client_requests, &client_responses, order_gw_iface, order_gw_port, order_gw_backend, order_gw_uring_cfg,
+                                             order_gw_pool_cfg);
     order_server->start();
     
     while (true)
@@ -4,12 +4,31 @@ namespace Exchange
 {
     MarketDataPublisher::MarketDataPublisher(MEMarketUpdateLFQueue* market_updates, const std::string& iface,
                                 const std::string& snapshot_ip, int snapshot_port,
-                                const std::string& incremental_ip, int incremental_port)
-                                : outgoing_md_updates_(market_updates), snapshot_md_updates_(ME_MAX_MARKET_UPDATES),
-                                run_(false), logger_("exchange_market_data_publisher.log"), incremental_socket_(logger_) {
+                                const std::string& incremental_ip, int incremental_port, size_t mtu, MDPEncoding encoding, bool publish_stamps,
+                                const std::string& incremental_b_ip, int incremental_b_port, int retransmit_port,
+                                const SnapshotCfg& snapshot_cfg, MEPriceLevelUpdateLFQueue* price_level_updates,
+                                const std::string& mbp_ip, int mbp_port,
+                                const std::string& tob_ip, int tob_port, const TopOfBookCfg& tob_cfg)
+                                : outgoing_md_updates_(market_updates), snapshot_md_updates_(ME_MAX_MARKET_UPDATES), retransmit_md_updates_(ME_MAX_MARKET_UPDATES),
+                                tob_md_updates_(ME_MAX_MARKET_UPDATES),
+                                run_(false), logger_("exchange_market_data_publisher.log"), incremental_socket_(logger_), incremental_b_socket_(logger_),
+                                incremental_b_enabled_(!incremental_b_ip.empty()),
+                                incremental_packetizer_(&incremental_socket_, mtu, incremental_b_enabled_ ? &incremental_b_socket_ : nullptr, encoding, publish_stamps),
+                                outgoing_price_level_updates_(price_level_updates), mbp_socket_(logger_), mbp_packetizer_(&mbp_socket_, mtu),
+                                publish_stamps_(publish_stamps) {
                                     ASSERT(incremental_socket_.init(incremental_ip, iface, incremental_port, /* is_listening*/ false) >= 0,
                                     "Unable to create incremental mcast socket. error:" + std::string(std::strerror(errno)));
-                                    snapshot_synthesizer_ = new SnapshotSynthesizer(&snapshot_md_updates_, iface, snapshot_ip, snapshot_port);
+                                    if(incremental_b_enabled_)
+                                        ASSERT(incremental_b_socket_.init(incremental_b_ip, iface, incremental_b_port, /* is_listening*/ false) >= 0,
+                                        "Unable to create incremental B mcast socket. error:" + std::string(std::strerror(errno)));
+                                    if(outgoing_price_level_updates_)
+                                        ASSERT(mbp_socket_.init(mbp_ip, iface, mbp_port, /* is_listening*/ false) >= 0,
+                                        "Unable to create market-by-price mcast socket. error:" + std::string(std::strerror(errno)));
+                                    snapshot_synthesizer_ = new SnapshotSynthesizer(&snapshot_md_updates_, iface, snapshot_ip, snapshot_port, mtu, encoding, snapshot_cfg);
+                                    if(retransmit_port)
+                                        retransmission_server_ = new RetransmissionServer(&retransmit_md_updates_, iface, retransmit_port);
+                                    if(!tob_ip.empty())
+                                        top_of_book_publisher_ = new TopOfBookPublisher(&tob_md_updates_, iface, tob_ip, tob_port, mtu, tob_cfg);
                                 }
     
     auto MarketDataPublisher::run() noexcept -> void {
@@ -20,8 +39,12 @@ namespace Exchange
             outgoing_md_updates_->size() && market_update; 
             market_update = outgoing_md_updates_->getNextToRead()) {
                 logger_.log("%:% %() % sending seq:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), next_inc_seq_num_, market_update->toString().c_str());
-                incremental_socket_.send(&next_inc_seq_num_, sizeof(next_inc_seq_num_));
-                incremental_socket_.send(&market_update, sizeof(MEMarketUpdate));
+                auto& outgoing_update = outgoing_market_update_.mdp_market_update_;
+                outgoing_update.seq_num_ = next_inc_seq_num_;
+                outgoing_update.me_market_update_ = *market_update;
+                if(publish_stamps_)
+                    outgoing_market_update_.publish_time_ = Common::getCurrentNanos();
+                incremental_packetizer_.add(outgoing_market_update_);
                 outgoing_md_updates_->updateReadIndex();
 
                 auto next_write = snapshot_md_updates_.getNextToWriteTo();
@@ -29,10 +52,43 @@ namespace Exchange
                 next_write->me_market_update_ = *market_update;
                 snapshot_md_updates_.updateWriteIndex();
 
+                if(retransmission_server_) {
+                    *retransmit_md_updates_.getNextToWriteTo() = outgoing_update;
+                    retransmit_md_updates_.updateWriteIndex();
+                }
+
+                if(top_of_book_publisher_) {
+                    *tob_md_updates_.getNextToWriteTo() = outgoing_update;
+                    tob_md_updates_.updateWriteIndex();
+                }
+
                 ++next_inc_seq_num_;
             }
+            // Nothing more to publish right now, send the partly filled packet rather than hold it for more updates
+            incremental_packetizer_.flush();
             incremental_socket_.sendAndRecv();
+            if(incremental_b_enabled_)
+                incremental_b_socket_.sendAndRecv();
+
+            if(outgoing_price_level_updates_)
+                publishPriceLevelUpdates();
         }
         
     }
+
+    auto MarketDataPublisher::publishPriceLevelUpdates() noexcept -> void {
+        for(auto price_level_update = outgoing_price_level_updates_->getNextToRead();
+            outgoing_price_level_updates_->size() && price_level_update;
+            price_level_update = outgoing_price_level_updates_->getNextToRead()) {
+                logger_.log("%:% %() % sending %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), price_level_update->toString());
+                // A level changed again before its last state went out replaces that state in place
+                mbp_packetizer_.conflate(*price_level_update, [price_level_update](const MEPriceLevelUpdate& queued) {
+                    return queued.price_ == price_level_update->price_ && queued.ticker_id_ == price_level_update->ticker_id_ &&
+                           queued.side_ == price_level_update->side_;
+                });
+                outgoing_price_level_updates_->updateReadIndex();
+            }
+        mbp_packetizer_.flush();
+        mbp_socket_.sendAndRecv();
+    }
 } // namespace Exchange
@@ -1,6 +1,9 @@
 #pragma once
 #include <functional>
 #include "market_data/snapshot_synthesizer.h"
+#include "market_data/mdp_packetizer.h"
+#include "market_data/retransmission_server.h"
+#include "market_data/top_of_book_publisher.h"
 
 namespace Exchange
 {
@@ -8,17 +11,37 @@ namespace Exchange
         private:
             size_t next_inc_seq_num_ = 1;
             MEMarketUpdateLFQueue* outgoing_md_updates_ = nullptr;
-            MDPMarketUpdateLFQueue snapshot_md_updates_;
+            MDPMarketUpdateLFQueue snapshot_md_updates_, retransmit_md_updates_, tob_md_updates_;
             volatile bool run_ = false;
             std::string time_str_;
             Logger logger_;
-            Common::McastSocket incremental_socket_;
+            // A feed, and the optional B feed publishing the same packets on a second group for consumers to arbitrate between
+            Common::McastSocket incremental_socket_, incremental_b_socket_;
+            const bool incremental_b_enabled_;
+            MDPPacketizer incremental_packetizer_;
+            // Optional market-by-price feed of the top price levels published by the matching engine, nullptr queue if disabled
+            MEPriceLevelUpdateLFQueue* outgoing_price_level_updates_ = nullptr;
+            Common::McastSocket mbp_socket_;
+            MBPPacketizer mbp_packetizer_;
             SnapshotSynthesizer* snapshot_synthesizer_ = nullptr;
+            // Serves gap fills from the most recent incremental updates, nullptr unless a retransmit port was given
+            RetransmissionServer* retransmission_server_ = nullptr;
+            // Publishes the conflated best bid and offer of every ticker, nullptr unless a top-of-book group was given
+            TopOfBookPublisher* top_of_book_publisher_ = nullptr;
+
+            // Copy of the update being published, stamped with its publish time if publish_stamps_
+            const bool publish_stamps_;
+            MDPStampedMarketUpdate outgoing_market_update_;
         
         public:
             MarketDataPublisher(MEMarketUpdateLFQueue* market_updates, const std::string& iface,
                                 const std::string& snapshot_ip, int snapshot_port,
-                                const std::string& incremental_ip, int incremental_port);
+                                const std::string& incremental_ip, int incremental_port, size_t mtu = MDP_DEFAULT_MTU, MDPEncoding encoding = MDPEncoding::RAW,
+                                bool publish_stamps = false,
+                                const std::string& incremental_b_ip = "", int incremental_b_port = 0, int retransmit_port = 0,
+                                const SnapshotCfg& snapshot_cfg = {}, MEPriceLevelUpdateLFQueue* price_level_updates = nullptr,
+                                const std::string& mbp_ip = "", int mbp_port = 0,
+                                const std::string& tob_ip = "", int tob_port = 0, const TopOfBookCfg& tob_cfg = {});
 
             ~MarketDataPublisher() {
                 stop();
@@ -28,21 +51,36 @@ namespace Exchange
 
                 delete snapshot_synthesizer_;
                 snapshot_synthesizer_ = nullptr;
+                delete retransmission_server_;
+                retransmission_server_ = nullptr;
+                delete top_of_book_publisher_;
+                top_of_book_publisher_ = nullptr;
             }
 
             auto start() {
                 run_ = true;
                 ASSERT(Common::createAndStartThread(-1, "Exchange/MarketDataPublisher", [this]() { run(); }) != nullptr, "Failed to start MarketDataPublisher thread.");
                 snapshot_synthesizer_->start();
+                if(retransmission_server_)
+                    retransmission_server_->start();
+                if(top_of_book_publisher_)
+                    top_of_book_publisher_->start();
             }
 
             auto stop() -> void {
                 run_ = false;
                 snapshot_synthesizer_->stop();
+                if(retransmission_server_)
+                    retransmission_server_->stop();
+                if(top_of_book_publisher_)
+                    top_of_book_publisher_->stop();
             }
 
             auto run() noexcept -> void;
 
+            // Conflate the price level updates published since the last call into the open market-by-price packet and send it
+            auto publishPriceLevelUpdates() noexcept -> void;
+
             // deleted copy & move constructors and assignment-operators
             MarketDataPublisher() = default;
             MarketDataPublisher(const MarketDataPublisher&) = delete;
@@ -1,6 +1,7 @@
 #pragma once
 #include <sstream>
 #include "common/types.h"
+#include "common/time_utils.h"
 #include "common/lf_queue.h"
 
 using namespace Common;
@@ -41,6 +42,27 @@ namespace Exchange {
         }
     }
 
+    // Encoding of the updates in a market data packet
+    enum class MDPEncoding : uint8_t {
+        RAW = 0, // the packed structs as they are in memory
+        SBE = 1, // MDPMarketUpdates as SBE messages, see mdp_sbe.h
+        DELTA = 2 // MDPMarketUpdates delta and varint encoded, see mdp_delta.h
+    };
+
+    inline std::string mdpEncodingToString(MDPEncoding encoding) {
+        switch (encoding)
+        {
+            case MDPEncoding::RAW:
+                return "RAW";
+            case MDPEncoding::SBE:
+                return "SBE";
+            case MDPEncoding::DELTA:
+                return "DELTA";
+            default:
+                return "UNKNOWN";
+        }
+    }
+
     #pragma pack(push, 1)
 
     struct MEMarketUpdate
@@ -85,7 +107,167 @@ namespace Exchange {
         };
     };
     
+    // An MDPMarketUpdate with the time MarketDataPublisher published it, 0 if it was not stamped.
+    // What the SBE and delta encodings carry, publish_time_ being optional in both, and the layout of the updates of a RAW packet
+    // with MDP_PUBLISH_TIME_FLAG set. Every other RAW packet holds bare MDPMarketUpdates, so an unstamped feed pays nothing for it.
+    struct MDPStampedMarketUpdate
+    {
+        MDPMarketUpdate mdp_market_update_;
+        Nanos publish_time_ = 0;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "MDPStampedMarketUpdate"
+            << " ["
+            << " " << mdp_market_update_.toString()
+            << " publish_time:" << publish_time_
+            << "]";
+            return ss.str();
+        };
+    };
+
+    // MDPPacketHeader flags_: the incremental updates of the packet carry their publish time
+    constexpr uint8_t MDP_PUBLISH_TIME_FLAG = 0x1;
+
+    // Leads every market data datagram, followed by num_updates_ MDPMarketUpdates, or MEPriceLevelUpdates on the market-by-price feed and
+    // MDPTopOfBooks on the top-of-book feed.
+    // packet_seq_num_ counts datagrams per stream, so a lost datagram shows up as a gap before its updates are even looked at.
+    // encoding_ says how the updates are encoded, so a consumer decodes whatever the publisher is configured with.
+    struct MDPPacketHeader
+    {
+        size_t packet_seq_num_ = 0;
+        Nanos send_time_ = 0;
+        uint16_t num_updates_ = 0;
+        MDPEncoding encoding_ = MDPEncoding::RAW;
+        uint8_t flags_ = 0;
+
+        // Size of a RAW encoded MDPMarketUpdate in this packet
+        auto rawUpdateSize() const noexcept {
+            return (flags_ & MDP_PUBLISH_TIME_FLAG) ? sizeof(MDPStampedMarketUpdate) : sizeof(MDPMarketUpdate);
+        }
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "MDPPacketHeader"
+            << " ["
+            << " packet_seq:" << packet_seq_num_
+            << " send_time:" << send_time_
+            << " updates:" << num_updates_
+            << " encoding:" << mdpEncodingToString(encoding_)
+            << " flags:" << static_cast<int>(flags_)
+            << "]";
+            return ss.str();
+        };
+    };
+    
+    // Number of price levels per side the market-by-price feed publishes unless configured otherwise
+    constexpr size_t MBP_DEFAULT_DEPTH = 10;
+
+    // Aggregated state of one of the top price levels of a book, published by the matching engine on the market-by-price feed
+    // whenever the level changes. num_orders_ of 0 means the level left the top levels, because it emptied or was pushed below them.
+    // Updates carry the full level state keyed by price, so within a packet only the latest one per level needs to be sent.
+    struct MEPriceLevelUpdate
+    {
+        TickerId ticker_id_ = TickerId_INVALID;
+        Side side_ = Side::INVALID;
+        Price price_ = Price_INVALID;
+        Qty qty_ = 0;
+        uint32_t num_orders_ = 0;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "MEPriceLevelUpdate"
+            << " ["
+            << " ticker:" << tickerIdToString(ticker_id_)
+            << " side:" << sideToString(side_)
+            << " price:" << priceToString(price_)
+            << " qty:" << qtyToString(qty_)
+            << " orders:" << num_orders_
+            << "]";
+            return ss.str();
+        };
+    };
+
+    // Best bid and offer of a ticker, published on the top-of-book feed. An empty side has Price_INVALID and 0 qty.
+    // seq_num_ is the incremental seq num of the last update of the ticker reflected in it.
+    struct MDPTopOfBook
+    {
+        size_t seq_num_ = 0;
+        TickerId ticker_id_ = TickerId_INVALID;
+        Price bid_price_ = Price_INVALID;
+        Qty bid_qty_ = 0;
+        Price ask_price_ = Price_INVALID;
+        Qty ask_qty_ = 0;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "MDPTopOfBook"
+            << " ["
+            << " seq:" << seq_num_
+            << " ticker:" << tickerIdToString(ticker_id_)
+            << " bid:" << qtyToString(bid_qty_) << "@" << priceToString(bid_price_)
+            << " ask:" << qtyToString(ask_qty_) << "@" << priceToString(ask_price_)
+            << "]";
+            return ss.str();
+        };
+    };
+
+    // Largest range served by a single MDPRetransmitRequest, larger gaps are cheaper to recover from a snapshot
+    constexpr size_t MDP_MAX_RETRANSMIT_COUNT = 1024;
+
+    // Gap-fill request a MarketDataConsumer sends to the RetransmissionServer over TCP for incremental updates
+    // [begin_seq_num_, begin_seq_num_ + count_)
+    struct MDPRetransmitRequest
+    {
+        size_t begin_seq_num_ = 0;
+        uint32_t count_ = 0;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "MDPRetransmitRequest"
+            << " ["
+            << " begin_seq:" << begin_seq_num_
+            << " count:" << count_
+            << "]";
+            return ss.str();
+        };
+    };
+
+    // Answer to an MDPRetransmitRequest, followed by count_ MDPMarketUpdates.
+    // count_ is 0 if the range is not in the history (anymore), the consumer then has to recover from a snapshot.
+    struct MDPRetransmitResponse
+    {
+        size_t begin_seq_num_ = 0;
+        uint32_t count_ = 0;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "MDPRetransmitResponse"
+            << " ["
+            << " begin_seq:" << begin_seq_num_
+            << " count:" << count_
+            << "]";
+            return ss.str();
+        };
+    };
+
     #pragma pack(pop)
+
+    // Largest snapshot, every OrderId of every ticker live plus its START, END and a CLEAR per ticker
+    constexpr size_t ME_MAX_SNAPSHOT_UPDATES = ME_MAX_TICKERS * (ME_MAX_ORDER_IDS + 1) + 2;
+
+    // Element of the queue from MarketDataConsumer to the trading engine. The latency stamps sit beside the update rather than in it, so
+    // they never reach the matching engine or the wire. Both are zero for snapshot and recovered updates, publish_time_ also for updates
+    // from a publisher which does not stamp its packets.
+    struct MDCMarketUpdate
+    {
+        MEMarketUpdate me_market_update_;
+        Nanos publish_time_ = 0; // set by MarketDataPublisher just before the update is written to the incremental stream
+        Nanos recv_time_ = 0;    // set by MarketDataConsumer when the update is read off the socket
+    };
+
     typedef LFQueue<MEMarketUpdate> MEMarketUpdateLFQueue;
+    typedef LFQueue<MDCMarketUpdate> MDCMarketUpdateLFQueue;
     typedef LFQueue<MDPMarketUpdate> MDPMarketUpdateLFQueue;
+    typedef LFQueue<MEPriceLevelUpdate> MEPriceLevelUpdateLFQueue;
 }
\ No newline at end of file
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <array>
+
+#include "common/macros.h"
+#include "common/varint.h"
+
+#include "exchange/market_data/market_update.h"
+
+namespace Exchange
+{
+    // Delta encoding of MDPStampedMarketUpdates for bandwidth constrained links. Every update is a flags byte, the low bits its
+    // MarketUpdateType and the top bit set if a publish_time_ follows, then varints of the fields its type uses:
+    //   seq_num_ and publish_time_ as deltas from the previous update in the packet,
+    //   order_id_ and price_ as deltas from the previous update of the same ticker in the packet,
+    //   ticker_id_, qty_ and priority_ as they are, side_ as a single byte.
+    // The state is reset at the start of every packet, so every packet decodes on its own whatever was lost before it.
+    // Unlike SBE messages updates carry no length, so a packet with a type the decoder does not know is dropped whole.
+    class MDPDeltaCodec final {
+        public:
+            // Longest encoded update: the flags and side bytes and seven varints
+            static constexpr size_t MAX_LENGTH = 2 + 7 * Common::VARINT_MAX_LENGTH;
+
+            MDPDeltaCodec() = default;
+
+            // Start a new packet
+            auto reset() noexcept -> void {
+                prev_seq_num_ = 0;
+                prev_publish_time_ = 0;
+                tickers_.fill({});
+            }
+
+            // Encode stamped_update to dst, which must hold MAX_LENGTH bytes, and return the length written, 0 for a type with no encoding
+            auto encode(const MDPStampedMarketUpdate& stamped_update, char* dst) noexcept -> size_t {
+                const auto& market_update = stamped_update.mdp_market_update_;
+                const auto& update = market_update.me_market_update_;
+                const auto fields = typeFields(update.type_);
+                if(UNLIKELY(!fields))
+                    return 0;
+
+                size_t len = 0;
+                dst[len++] = static_cast<char>(static_cast<uint8_t>(update.type_) | (stamped_update.publish_time_ ? PUBLISH_TIME_FLAG : 0));
+                len += Common::varintStore(dst + len, Common::zigzagEncode(static_cast<int64_t>(market_update.seq_num_ - prev_seq_num_)));
+                prev_seq_num_ = market_update.seq_num_;
+                // TickerId_INVALID wraps to 0, so the ticker of a snapshot marker is a single byte
+                len += Common::varintStore(dst + len, static_cast<TickerId>(update.ticker_id_ + 1));
+
+                auto& ticker = tickerState(update.ticker_id_);
+                if(fields & ORDER_ID) {
+                    len += Common::varintStore(dst + len, Common::zigzagEncode(static_cast<int64_t>(update.order_id_ - ticker.order_id_)));
+                    ticker.order_id_ = update.order_id_;
+                }
+                if(fields & SIDE)
+                    dst[len++] = static_cast<char>(update.side_);
+                if(fields & PRICE) {
+                    len += Common::varintStore(dst + len, Common::zigzagEncode(static_cast<int64_t>(update.price_ - ticker.price_)));
+                    ticker.price_ = update.price_;
+                }
+                if(fields & QTY)
+                    len += Common::varintStore(dst + len, update.qty_);
+                if(fields & PRIORITY)
+                    len += Common::varintStore(dst + len, update.priority_);
+                if(stamped_update.publish_time_) {
+                    len += Common::varintStore(dst + len, Common::zigzagEncode(static_cast<int64_t>(stamped_update.publish_time_ - prev_publish_time_)));
+                    prev_publish_time_ = stamped_update.publish_time_;
+                }
+                return len;
+            }
+
+            // Decode the update at src, of which len bytes are readable, into stamped_update, which is reset first.
+            // Returns its length, 0 if it is truncated or of a type with no encoding.
+            auto decode(const char* src, size_t len, MDPStampedMarketUpdate* stamped_update) noexcept -> size_t {
+                const auto end = src + len;
+                if(UNLIKELY(!len))
+                    return 0;
+                const auto flags = static_cast<uint8_t>(*src);
+                const auto type = static_cast<MarketUpdateType>(flags & ~PUBLISH_TIME_FLAG);
+                const auto fields = typeFields(type);
+                if(UNLIKELY(!fields))
+                    return 0;
+
+                *stamped_update = {};
+                auto market_update = &stamped_update->mdp_market_update_;
+                auto& update = market_update->me_market_update_;
+                update.type_ = type;
+                auto ptr = src + 1;
+                uint64_t value = 0;
+                const auto next = [&ptr, end, &value]() {
+                    const auto value_len = Common::varintLoad(ptr, end, &value);
+                    ptr += value_len;
+                    return value_len != 0;
+                };
+
+                if(UNLIKELY(!next()))
+                    return 0;
+                market_update->seq_num_ = prev_seq_num_ = prev_seq_num_ + static_cast<uint64_t>(Common::zigzagDecode(value));
+                if(UNLIKELY(!next()))
+                    return 0;
+                update.ticker_id_ = static_cast<TickerId>(value - 1);
+
+                auto& ticker = tickerState(update.ticker_id_);
+                if(fields & ORDER_ID) {
+                    if(UNLIKELY(!next()))
+                        return 0;
+                    update.order_id_ = ticker.order_id_ = ticker.order_id_ + static_cast<uint64_t>(Common::zigzagDecode(value));
+                }
+                if(fields & SIDE) {
+                    if(UNLIKELY(ptr == end))
+                        return 0;
+                    update.side_ = static_cast<Side>(*ptr++);
+                }
+                if(fields & PRICE) {
+                    if(UNLIKELY(!next()))
+                        return 0;
+                    update.price_ = ticker.price_ = ticker.price_ + static_cast<uint64_t>(Common::zigzagDecode(value));
+                }
+                if(fields & QTY) {
+                    if(UNLIKELY(!next()))
+                        return 0;
+                    update.qty_ = static_cast<Qty>(value);
+                }
+                if(fields & PRIORITY) {
+                    if(UNLIKELY(!next()))
+                        return 0;
+                    update.priority_ = value;
+                }
+                if(flags & PUBLISH_TIME_FLAG) {
+                    if(UNLIKELY(!next()))
+                        return 0;
+                    stamped_update->publish_time_ = prev_publish_time_ = prev_publish_time_ + static_cast<uint64_t>(Common::zigzagDecode(value));
+                }
+                return ptr - src;
+            }
+
+            // deleted copy & move constructors and assignment-operators
+            MDPDeltaCodec(const MDPDeltaCodec&) = delete;
+            MDPDeltaCodec(const MDPDeltaCodec&&) = delete;
+            MDPDeltaCodec &operator=(const MDPDeltaCodec&) = delete;
+            MDPDeltaCodec &operator=(const MDPDeltaCodec&&) = delete;
+
+        private:
+            static constexpr uint8_t PUBLISH_TIME_FLAG = 0x80;
+
+            // Fields an update type carries besides seq_num_, ticker_id_ and publish_time_, as in its SBE template.
+            // Types with no encoding have none, not even the always present bit.
+            enum Field : uint8_t { PRESENT = 1, ORDER_ID = 2, SIDE = 4, PRICE = 8, QTY = 16, PRIORITY = 32 };
+
+            static constexpr auto typeFields(MarketUpdateType type) noexcept -> uint8_t {
+                switch (type)
+                {
+                    case MarketUpdateType::CLEAR:
+                        return PRESENT;
+                    case MarketUpdateType::ADD:
+                    case MarketUpdateType::MODIFY:
+                        return PRESENT | ORDER_ID | SIDE | PRICE | QTY | PRIORITY;
+                    case MarketUpdateType::CANCEL:
+                        return PRESENT | ORDER_ID | SIDE | PRICE | QTY;
+                    case MarketUpdateType::TRADE:
+                        return PRESENT | SIDE | PRICE | QTY;
+                    case MarketUpdateType::SNAPSHOT_START:
+                    case MarketUpdateType::SNAPSHOT_END:
+                        return PRESENT | ORDER_ID;
+                    default:
+                        return 0;
+                }
+            }
+
+            // Previous order id and price of each ticker, the extra slot is shared by updates with no valid ticker
+            struct TickerState {
+                OrderId order_id_ = 0;
+                Price price_ = 0;
+            };
+            std::array<TickerState, ME_MAX_TICKERS + 1> tickers_{};
+            size_t prev_seq_num_ = 0;
+            Nanos prev_publish_time_ = 0;
+
+            auto tickerState(TickerId ticker_id) noexcept -> TickerState& {
+                return tickers_[ticker_id < ME_MAX_TICKERS ? ticker_id : ME_MAX_TICKERS];
+            }
+    };
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstring>
+
+#include "common/macros.h"
+#include "common/mcast_socket.h"
+#include "common/time_utils.h"
+
+#include "market_data/market_update.h"
+#include "market_data/mdp_sbe.h"
+#include "market_data/mdp_delta.h"
+
+namespace Exchange
+{
+    // Default MTU of the market data network, each datagram carries at most this less the IP and UDP headers
+    constexpr size_t MDP_DEFAULT_MTU = 1500;
+    constexpr size_t MDP_IP_UDP_HEADER_SIZE = 20 + 8;
+
+    // Frames updates into datagrams of an MDPPacketHeader followed by as many updates as fit in the MTU.
+    // A packet goes out when the next update would not fit, or when the publisher calls flush() because it has gone idle,
+    // so bursts are batched without holding a lone update back.
+    // With a b_socket every packet is also sent on it unchanged, so the A and B feeds carry identical packet sequence numbers.
+    // MDPMarketUpdates may be SBE or delta encoded, packets then hold as many of the variable length messages as fit.
+    // With publish_stamps packets are flagged MDP_PUBLISH_TIME_FLAG and carry the publish time of every incremental update, in RAW packets
+    // as a trailer after each update, otherwise only publish times which are set are encoded.
+    template<typename Update>
+    class BasicMDPPacketizer final {
+        public:
+            BasicMDPPacketizer(Common::McastSocket* socket, size_t mtu, Common::McastSocket* b_socket = nullptr, MDPEncoding encoding = MDPEncoding::RAW,
+                               bool publish_stamps = false)
+                : socket_(socket), b_socket_(b_socket), raw_update_size_(publish_stamps ? sizeof(MDPStampedMarketUpdate) : sizeof(Update)),
+                max_updates_((mtu - MDP_IP_UDP_HEADER_SIZE - sizeof(MDPPacketHeader)) / raw_update_size_),
+                max_len_(std::min(mtu - MDP_IP_UDP_HEADER_SIZE, packet_.size())) {
+                ASSERT(mtu > MDP_IP_UDP_HEADER_SIZE + sizeof(MDPPacketHeader) && max_updates_ > 0 && max_updates_ <= MAX_UPDATES_PER_PACKET,
+                    "MTU:" + std::to_string(mtu) + " must fit the packet header and between 1 and " + std::to_string(MAX_UPDATES_PER_PACKET) + " updates.");
+                ASSERT(encoding == MDPEncoding::RAW || std::is_same_v<Update, MDPMarketUpdate>, "Only MDPMarketUpdates have SBE and delta encodings.");
+                ASSERT(!publish_stamps || std::is_same_v<Update, MDPMarketUpdate>, "Only MDPMarketUpdates carry publish stamps.");
+                header().encoding_ = encoding;
+                header().flags_ = (publish_stamps ? MDP_PUBLISH_TIME_FLAG : 0);
+            }
+
+            // Append an update to the open packet, sending the packet first if it is full
+            auto add(const Update& update) noexcept -> void {
+                if constexpr(std::is_same_v<Update, MDPMarketUpdate>) {
+                    add(MDPStampedMarketUpdate{update});
+                } else {
+                    if(full())
+                        flush();
+                    updates()[header().num_updates_++] = update;
+                    len_ += sizeof(Update);
+                }
+            }
+
+            // Append an incremental update with its publish time, which RAW packets only carry if the packetizer stamps them
+            auto add(const MDPStampedMarketUpdate& update) noexcept -> void requires std::is_same_v<Update, MDPMarketUpdate> {
+                if(header().encoding_ == MDPEncoding::SBE || header().encoding_ == MDPEncoding::DELTA) {
+                    if(full())
+                        flush();
+                    const auto len = (header().encoding_ == MDPEncoding::SBE ? sbeEncode(update, packet_.data() + len_) : delta_codec_.encode(update, packet_.data() + len_));
+                    if(LIKELY(len)) {
+                        len_ += len;
+                        ++header().num_updates_;
+                    }
+                    return;
+                }
+
+                if(full())
+                    flush();
+                // MDPStampedMarketUpdate starts with the MDPMarketUpdate, so an unstamped packet takes just that prefix
+                std::memcpy(packet_.data() + len_, &update, raw_update_size_);
+                len_ += raw_update_size_;
+                ++header().num_updates_;
+            }
+
+            // Overwrite the first update in the open packet for which same(update) holds, else add() it. Unstamped raw encoding only.
+            template<typename SameFn>
+            auto conflate(const Update& update, SameFn same) noexcept -> void {
+                const auto open_updates = updates();
+                for(size_t i = 0; i < header().num_updates_; ++i) {
+                    if(same(open_updates[i])) {
+                        open_updates[i] = update;
+                        return;
+                    }
+                }
+                add(update);
+            }
+
+            // Hand the open packet, if any, to the socket. Goes out on the next McastSocket::sendAndRecv().
+            auto flush() noexcept -> void {
+                auto& header = this->header();
+                if(!header.num_updates_)
+                    return;
+
+                header.packet_seq_num_ = next_packet_seq_num_++;
+                header.send_time_ = Common::getCurrentNanos();
+                socket_->send(packet_.data(), len_);
+                socket_->endPacket();
+                if(b_socket_) {
+                    b_socket_->send(packet_.data(), len_);
+                    b_socket_->endPacket();
+                }
+                header.num_updates_ = 0;
+                len_ = sizeof(MDPPacketHeader);
+                delta_codec_.reset();
+            }
+
+            // Updates a raw packet holds, SBE and delta encoded packets hold at least as many
+            auto maxUpdatesPerPacket() const noexcept { return max_updates_; }
+
+            // Whether the open packet may not have room for another update, the next add() sends it first
+            auto full() const noexcept -> bool {
+                switch (header().encoding_)
+                {
+                    case MDPEncoding::SBE:
+                        return len_ + MDPSBESchema::MAX_LENGTH > max_len_;
+                    case MDPEncoding::DELTA:
+                        return len_ + MDPDeltaCodec::MAX_LENGTH > max_len_;
+                    default:
+                        return header().num_updates_ == max_updates_;
+                }
+            }
+
+            // deleted default, copy & move constructors and assignment-operators
+            BasicMDPPacketizer() = delete;
+            BasicMDPPacketizer(const BasicMDPPacketizer&) = delete;
+            BasicMDPPacketizer(const BasicMDPPacketizer&&) = delete;
+            BasicMDPPacketizer &operator=(const BasicMDPPacketizer&) = delete;
+            BasicMDPPacketizer &operator=(const BasicMDPPacketizer&&) = delete;
+
+        private:
+            // Largest packet the 16-bit update count and a 64KB UDP payload allow
+            static constexpr size_t MAX_UPDATES_PER_PACKET = (64 * 1024 - MDP_IP_UDP_HEADER_SIZE - sizeof(MDPPacketHeader)) / sizeof(Update);
+            // Largest update RAW packets hold
+            static constexpr size_t MAX_UPDATE_SIZE = std::is_same_v<Update, MDPMarketUpdate> ? sizeof(MDPStampedMarketUpdate) : sizeof(Update);
+
+            Common::McastSocket* socket_ = nullptr;
+            Common::McastSocket* b_socket_ = nullptr;
+            const size_t raw_update_size_;
+            const size_t max_updates_;
+            size_t next_packet_seq_num_ = 1;
+
+            // The open packet, built in place, its length and the length it may grow to
+            std::array<char, sizeof(MDPPacketHeader) + MAX_UPDATES_PER_PACKET * MAX_UPDATE_SIZE> packet_{};
+            size_t len_ = sizeof(MDPPacketHeader);
+            const size_t max_len_;
+            // Deltas of the open packet, every packet is encoded against a fresh state
+            MDPDeltaCodec delta_codec_;
+
+            auto header() noexcept -> MDPPacketHeader& { return *reinterpret_cast<MDPPacketHeader*>(packet_.data()); }
+            auto header() const noexcept -> const MDPPacketHeader& { return *reinterpret_cast<const MDPPacketHeader*>(packet_.data()); }
+            auto updates() noexcept -> Update* { return reinterpret_cast<Update*>(packet_.data() + sizeof(MDPPacketHeader)); }
+    };
+
+    // Order-by-order snapshot and incremental feeds
+    typedef BasicMDPPacketizer<MDPMarketUpdate> MDPPacketizer;
+    // Market-by-price feed
+    typedef BasicMDPPacketizer<MEPriceLevelUpdate> MBPPacketizer;
+    // Top-of-book feed
+    typedef BasicMDPPacketizer<MDPTopOfBook> TopOfBookPacketizer;
+} // namespace Exchange
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "common/sbe.h"
+
+#include "exchange/market_data/market_update.h"
+
+namespace Exchange
+{
+    // SBE layouts of MDPStampedMarketUpdate, one template per MarketUpdateType with the template id its value, so the type is carried by the header
+    // and every type only carries the fields it uses.
+    constexpr uint8_t MDP_SBE_VERSION = 1;
+
+    static_assert(ME_MAX_TICKERS <= std::numeric_limits<uint16_t>::max(), "TickerIds are encoded in 16 bits.");
+    static_assert(ME_MAX_ORDER_IDS < std::numeric_limits<uint32_t>::max(), "Priorities, bounded by the orders at a price, are encoded in 32 bits.");
+
+    template<MarketUpdateType Type, typename... Fields>
+    using MDPSBEMessage = SBEMessage<static_cast<uint8_t>(Type), MDP_SBE_VERSION, Fields...>;
+
+    template<typename Wire, auto Member>
+    using MDPSBEField = SBEField<Wire, &MDPStampedMarketUpdate::mdp_market_update_, &MDPMarketUpdate::me_market_update_, Member>;
+
+    using MDPSBESeqNum = SBEField<uint64_t, &MDPStampedMarketUpdate::mdp_market_update_, &MDPMarketUpdate::seq_num_>;
+    using MDPSBEOrderId = MDPSBEField<uint64_t, &MEMarketUpdate::order_id_>;
+    using MDPSBETickerId = MDPSBEField<uint16_t, &MEMarketUpdate::ticker_id_>;
+    using MDPSBESide = MDPSBEField<int8_t, &MEMarketUpdate::side_>;
+    using MDPSBEPrice = MDPSBEField<uint64_t, &MEMarketUpdate::price_>;
+    using MDPSBEQty = MDPSBEField<uint32_t, &MEMarketUpdate::qty_>;
+    using MDPSBEPriority = MDPSBEField<uint32_t, &MEMarketUpdate::priority_>;
+    using MDPSBEPublishTime = SBEOptionalField<uint64_t, &MDPStampedMarketUpdate::publish_time_>;
+
+    typedef SBESchema<
+        MDPSBEMessage<MarketUpdateType::CLEAR, MDPSBESeqNum, MDPSBETickerId>,
+        MDPSBEMessage<MarketUpdateType::ADD, MDPSBESeqNum, MDPSBEOrderId, MDPSBETickerId, MDPSBESide, MDPSBEPrice, MDPSBEQty, MDPSBEPriority, MDPSBEPublishTime>,
+        MDPSBEMessage<MarketUpdateType::MODIFY, MDPSBESeqNum, MDPSBEOrderId, MDPSBETickerId, MDPSBESide, MDPSBEPrice, MDPSBEQty, MDPSBEPriority, MDPSBEPublishTime>,
+        MDPSBEMessage<MarketUpdateType::CANCEL, MDPSBESeqNum, MDPSBEOrderId, MDPSBETickerId, MDPSBESide, MDPSBEPrice, MDPSBEQty, MDPSBEPublishTime>,
+        MDPSBEMessage<MarketUpdateType::TRADE, MDPSBESeqNum, MDPSBETickerId, MDPSBESide, MDPSBEPrice, MDPSBEQty, MDPSBEPublishTime>,
+        // order_id_ carries the incremental seq num the snapshot is consistent with
+        MDPSBEMessage<MarketUpdateType::SNAPSHOT_START, MDPSBESeqNum, MDPSBEOrderId>,
+        MDPSBEMessage<MarketUpdateType::SNAPSHOT_END, MDPSBESeqNum, MDPSBEOrderId>
+    > MDPSBESchema;
+
+    // Encode market_update to dst, which must hold MDPSBESchema::MAX_LENGTH bytes, and return the length written
+    inline auto sbeEncode(const MDPStampedMarketUpdate& market_update, char* dst) noexcept -> size_t {
+        return MDPSBESchema::encode(static_cast<uint8_t>(market_update.mdp_market_update_.me_market_update_.type_), market_update, dst);
+    }
+
+    // Decode the message at src, of which len bytes are readable, into market_update and return its length, 0 if it is incomplete.
+    // A message of a template not in the schema decodes as type INVALID.
+    inline auto sbeDecode(const char* src, size_t len, MDPStampedMarketUpdate* market_update) noexcept -> size_t {
+        uint8_t template_id = 0;
+        const auto decoded = MDPSBESchema::decode(src, len, market_update, &template_id);
+        market_update->mdp_market_update_.me_market_update_.type_ = static_cast<MarketUpdateType>(template_id);
+        return decoded;
+    }
+}
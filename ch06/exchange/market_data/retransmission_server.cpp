@@ -0,0 +1,79 @@
+#include "retransmission_server.h"
+
+namespace Exchange
+{
+    RetransmissionServer::RetransmissionServer(MDPMarketUpdateLFQueue* market_updates, const std::string& iface, int port)
+        : retransmit_md_updates_(market_updates), logger_("exchange_retransmission_server.log"), iface_(iface), port_(port), tcp_server_(logger_),
+        history_(MDP_RETRANSMIT_HISTORY_SIZE) {
+            static_assert(!(MDP_RETRANSMIT_HISTORY_SIZE & (MDP_RETRANSMIT_HISTORY_SIZE - 1)), "MDP_RETRANSMIT_HISTORY_SIZE must be a power of two.");
+            tcp_server_.recv_callback_ = [this](auto socket, auto rx_time) { recvCallback(socket, rx_time); };
+            tcp_server_.recev_finished_callback_ = []() {};
+    }
+
+    RetransmissionServer::~RetransmissionServer() {
+        stop();
+    }
+
+    auto RetransmissionServer::start() -> void {
+        logger_.log("%:% %() % Starting RetransmissionServer on %:% history:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            iface_, port_, history_.size());
+        run_ = true;
+        tcp_server_.listen(iface_, port_);
+        ASSERT(Common::createAndStartThread(-1, "Exchange/RetransmissionServer", [this]() { run(); }) != nullptr, "Failed to start RetransmissionServer thread.");
+    }
+
+    auto RetransmissionServer::run() noexcept -> void {
+        logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+        while (run_)
+        {
+            updateHistory();
+            tcp_server_.poll();
+            tcp_server_.sendAndRecv();
+        }
+    }
+
+    auto RetransmissionServer::updateHistory() noexcept -> void {
+        for(auto market_update = retransmit_md_updates_->getNextToRead();
+            retransmit_md_updates_->size() && market_update; market_update = retransmit_md_updates_->getNextToRead()) {
+                ASSERT(market_update->seq_num_ == next_seq_num_, "Expected incremental seq:" + std::to_string(next_seq_num_) + " got " + market_update->toString());
+                history_[next_seq_num_ & (history_.size() - 1)] = *market_update;
+                ++next_seq_num_;
+                retransmit_md_updates_->updateReadIndex();
+            }
+    }
+
+    auto RetransmissionServer::recvCallback(Common::TCPSocket* socket, Common::Nanos) noexcept -> void {
+        // The gap may have been seen by the consumer before this thread caught up with the publisher
+        updateHistory();
+
+        auto& inbound_data = socket->inbound_data_;
+        for(; inbound_data.readable() >= sizeof(MDPRetransmitRequest); inbound_data.consume(sizeof(MDPRetransmitRequest))) {
+            const auto request = reinterpret_cast<const MDPRetransmitRequest*>(inbound_data.readPtr());
+
+            MDPRetransmitResponse response;
+            response.begin_seq_num_ = request->begin_seq_num_;
+            const auto end_seq_num = request->begin_seq_num_ + request->count_;
+            const auto oldest_seq_num = (next_seq_num_ > history_.size() ? next_seq_num_ - history_.size() : 1);
+            if(request->count_ && request->count_ <= MDP_MAX_RETRANSMIT_COUNT && request->begin_seq_num_ >= oldest_seq_num && end_seq_num <= next_seq_num_)
+                response.count_ = request->count_;
+
+            logger_.log("%:% %() % socket:% % => % history:[%, %)\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                socket->socket_fd_, request->toString(), response.toString(), oldest_seq_num, next_seq_num_);
+
+            if(UNLIKELY(!socket->reserveSend(sizeof(response) + response.count_ * sizeof(MDPMarketUpdate)))) {
+                logger_.log("%:% %() % socket:% not draining, dropping %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                    socket->socket_fd_, response.toString());
+                continue;
+            }
+            socket->send(&response, sizeof(response));
+
+            // The range wraps around the end of the ring at most once
+            for(auto seq_num = response.begin_seq_num_; seq_num < response.begin_seq_num_ + response.count_;) {
+                const auto index = seq_num & (history_.size() - 1);
+                const auto len = std::min(response.begin_seq_num_ + response.count_ - seq_num, history_.size() - index);
+                socket->send(&history_[index], len * sizeof(MDPMarketUpdate));
+                seq_num += len;
+            }
+        }
+    }
+} // namespace Exchange
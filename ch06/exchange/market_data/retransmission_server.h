@@ -0,0 +1,56 @@
+#pragma once
+#include "common/types.h"
+#include "common/thread_utils.h"
+#include "common/lf_queue.h"
+#include "common/macros.h"
+#include "common/tcp_server.h"
+#include "common/logging.h"
+
+#include "market_data/market_update.h"
+
+namespace Exchange
+{
+    // Number of most recent incremental updates kept for gap fills, a power of two so seq numbers map to slots with a mask
+    constexpr size_t MDP_RETRANSMIT_HISTORY_SIZE = 64 * 1024;
+
+    // Keeps a ring of the last MDP_RETRANSMIT_HISTORY_SIZE incremental updates, fed by the MarketDataPublisher, and serves
+    // MDPRetransmitRequests for ranges of it over TCP, so consumers heal small gaps without waiting for the next snapshot.
+    class RetransmissionServer {
+        private:
+            MDPMarketUpdateLFQueue* retransmit_md_updates_ = nullptr;
+            Common::Logger logger_;
+            volatile bool run_ = false;
+            std::string time_str_;
+            const std::string iface_;
+            const int port_ = 0;
+            Common::TCPServer tcp_server_;
+
+            // history_[seq_num & (MDP_RETRANSMIT_HISTORY_SIZE - 1)], holding seq numbers up to next_seq_num_ - 1
+            std::vector<MDPMarketUpdate> history_;
+            size_t next_seq_num_ = 1;
+
+            // Move updates published since the last call into the history
+            auto updateHistory() noexcept -> void;
+
+        public:
+            RetransmissionServer(MDPMarketUpdateLFQueue* market_updates, const std::string& iface, int port);
+            ~RetransmissionServer();
+
+            auto start() -> void;
+
+            auto stop() -> void {
+                run_ = false;
+            }
+
+            auto run() noexcept -> void;
+
+            auto recvCallback(Common::TCPSocket* socket, Common::Nanos rx_time) noexcept -> void;
+
+            // deleted default, copy & move constructors and assignment-operators
+            RetransmissionServer() = delete;
+            RetransmissionServer(const RetransmissionServer&) = delete;
+            RetransmissionServer(const RetransmissionServer&&) = delete;
+            RetransmissionServer &operator=(const RetransmissionServer&) = delete;
+            RetransmissionServer &operator=(const RetransmissionServer&&) = delete;
+    };
+} // namespace Exchange
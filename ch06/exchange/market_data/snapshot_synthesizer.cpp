@@ -1,15 +1,24 @@
+#include <algorithm>
+
 #include "snapshot_synthesizer.h"
 
 namespace Exchange
 {
     SnapshotSynthesizer::SnapshotSynthesizer(MDPMarketUpdateLFQueue* market_updates, const std::string& iface, 
-        const std::string& snapshot_ip, int snapshot_port)
-        : snapshot_md_updates_(market_updates), logger_("exchange_snapshot_synthesizer.log"), snapshot_socket_(logger_), order_pool_(ME_MAX_ORDER_IDS) {
+        const std::string& snapshot_ip, int snapshot_port, size_t mtu, MDPEncoding encoding, const SnapshotCfg& cfg)
+        : snapshot_md_updates_(market_updates), logger_("exchange_snapshot_synthesizer.log"), snapshot_socket_(logger_),
+        snapshot_packetizer_(&snapshot_socket_, mtu, nullptr, encoding),
+        cfg_(cfg) {
             ASSERT(snapshot_socket_.init(snapshot_ip, iface, snapshot_port, /* is_listening */ false) >= 0,
             "Unable to create snapshot mcast socket. error:" + std::string(std::strerror(errno)));
+            ASSERT(cfg_.packets_per_batch_, "Snapshot batches must hold at least one packet. " + cfg_.toString());
+            logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), cfg_.toString());
 
-            for(auto& orders: ticker_orders_)
-                orders.fill(nullptr);
+            for(auto& ticker_orders: ticker_orders_) {
+                ticker_orders.orders_.reserve(ME_MAX_ORDER_IDS);
+                ticker_orders.order_slots_.resize(ME_MAX_ORDER_IDS, ORDER_SLOT_INVALID);
+            }
+            snapshot_updates_.reserve(ME_MAX_SNAPSHOT_UPDATES);
     }
 
     SnapshotSynthesizer::~SnapshotSynthesizer() {
@@ -27,9 +36,11 @@ namespace Exchange
                     snapshot_md_updates_->updateReadIndex();
                 }
             
-            if(getCurrentNanos() - last_snapshot_time_ > 60 * NANOS_TO_SECS) {
-                last_snapshot_time_ = getCurrentNanos();
+            if(next_snapshot_update_ < snapshot_updates_.size()) {
                 publishSnapshot();
+            } else if(getCurrentNanos() - last_snapshot_time_ > cfg_.interval_) {
+                last_snapshot_time_ = getCurrentNanos();
+                startSnapshot();
             }
         }
         
@@ -37,32 +48,42 @@ namespace Exchange
 
     auto SnapshotSynthesizer::addToSnapshot(const MDPMarketUpdate* market_update) -> void {
         const auto& me_market_update_ = market_update->me_market_update_;
-        auto* orders = &ticker_orders_.at(me_market_update_.ticker_id_);
+        auto& ticker_orders = ticker_orders_.at(me_market_update_.ticker_id_);
+        auto& orders = ticker_orders.orders_;
 
         switch (me_market_update_.type_)
         {
         case MarketUpdateType::ADD: {
-            auto* order = orders->at(me_market_update_.order_id_);
-            ASSERT(order == nullptr, "Received:" + me_market_update_.toString() + " but order exists:" + (order ? order->toString() : ""));
-            orders->at(me_market_update_.order_id_) = order_pool_.allocate(me_market_update_);
+            auto& slot = ticker_orders.order_slots_.at(me_market_update_.order_id_);
+            ASSERT(slot == ORDER_SLOT_INVALID, "Received:" + me_market_update_.toString() + " but order exists:" +
+                (slot != ORDER_SLOT_INVALID ? orders[slot].toString() : ""));
+            slot = static_cast<uint32_t>(orders.size());
+            orders.push_back(me_market_update_);
             break;
         }
         case MarketUpdateType::MODIFY: {
-            auto* order = orders->at(me_market_update_.order_id_);
-            ASSERT(order != nullptr, "Received:" + me_market_update_.toString() + " but order does not exist.");
-            ASSERT(order->order_id_ == me_market_update_.order_id_, "Expecting existing order to match new one.");
-            ASSERT(order->side_ == me_market_update_.side_, "Expecting existing order to match new one.");
-            order->qty_ = me_market_update_.qty_;
-            order->price_ = me_market_update_.price_;
+            const auto slot = ticker_orders.order_slots_.at(me_market_update_.order_id_);
+            ASSERT(slot != ORDER_SLOT_INVALID, "Received:" + me_market_update_.toString() + " but order does not exist.");
+            auto& order = orders[slot];
+            ASSERT(order.order_id_ == me_market_update_.order_id_, "Expecting existing order to match new one.");
+            ASSERT(order.side_ == me_market_update_.side_, "Expecting existing order to match new one.");
+            order.qty_ = me_market_update_.qty_;
+            order.price_ = me_market_update_.price_;
             break;
         }
         case MarketUpdateType::CANCEL: {
-            auto* order = orders->at(me_market_update_.order_id_);
-            ASSERT(order != nullptr, "Received:" + me_market_update_.toString() + " but order does not exist.");
-            ASSERT(order->order_id_ == me_market_update_.order_id_, "Expecting existing order to match new one.");
-            ASSERT(order->side_ == me_market_update_.side_, "Expecting existing order to match new one.");
-            order_pool_.deallocate(order);
-            orders->at(me_market_update_.order_id_) = nullptr;
+            auto& slot = ticker_orders.order_slots_.at(me_market_update_.order_id_);
+            ASSERT(slot != ORDER_SLOT_INVALID, "Received:" + me_market_update_.toString() + " but order does not exist.");
+            const auto& order = orders[slot];
+            ASSERT(order.order_id_ == me_market_update_.order_id_, "Expecting existing order to match new one.");
+            ASSERT(order.side_ == me_market_update_.side_, "Expecting existing order to match new one.");
+            // Swap remove, the last live order takes over the cancelled one's slot
+            if(slot != orders.size() - 1) {
+                orders[slot] = orders.back();
+                ticker_orders.order_slots_[orders[slot].order_id_] = slot;
+            }
+            orders.pop_back();
+            slot = ORDER_SLOT_INVALID;
             break;
         }
         case MarketUpdateType::SNAPSHOT_START:
@@ -77,39 +98,58 @@ namespace Exchange
         last_inc_seq_num_ = market_update->seq_num_;
     }
     
-    auto SnapshotSynthesizer::publishSnapshot() -> void {
-        size_t snapshot_size = 0;
-
-        const MDPMarketUpdate start_market_update{snapshot_size++, {MarketUpdateType::SNAPSHOT_START, last_inc_seq_num_}};
-        logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), start_market_update.toString());
-        snapshot_socket_.send(&start_market_update, sizeof(MDPMarketUpdate));
+    auto SnapshotSynthesizer::startSnapshot() -> void {
+        snapshot_updates_.clear();
+        next_snapshot_update_ = 0;
 
+        snapshot_updates_.push_back({snapshot_updates_.size(), {MarketUpdateType::SNAPSHOT_START, last_inc_seq_num_}});
         for(size_t ticker_id = 0; ticker_id < ticker_orders_.size(); ++ticker_id) {
-            const auto& orders = ticker_orders_.at(ticker_id);
-
             MEMarketUpdate me_market_update_;
             me_market_update_.type_ = MarketUpdateType::CLEAR;
             me_market_update_.ticker_id_ = ticker_id;
+            snapshot_updates_.push_back({snapshot_updates_.size(), me_market_update_});
 
-            const MDPMarketUpdate clear_market_update{snapshot_size++, me_market_update_};
-            logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), clear_market_update.toString());
-            snapshot_socket_.send(&clear_market_update, sizeof(MDPMarketUpdate));
-
-            for(const auto order: orders) {
-                if (order) {
-                    const MDPMarketUpdate market_update{snapshot_size++, *order};
-                    logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), market_update.toString());
-                    snapshot_socket_.send(&market_update, sizeof(MDPMarketUpdate));
-                    snapshot_socket_.sendAndRecv();
-                }
-            }
+            // Swap removes scramble the live orders, put them back in OrderId, i.e. time priority, order so every price level is
+            // rebuilt with its orders queued as at the exchange
+            const auto ticker_begin = snapshot_updates_.size();
+            for(const auto& order: ticker_orders_.at(ticker_id).orders_)
+                snapshot_updates_.push_back({0, order});
+            std::sort(snapshot_updates_.begin() + ticker_begin, snapshot_updates_.end(),
+                [](const auto& lhs, const auto& rhs) { return lhs.me_market_update_.order_id_ < rhs.me_market_update_.order_id_; });
+            for(auto i = ticker_begin; i < snapshot_updates_.size(); ++i)
+                snapshot_updates_[i].seq_num_ = i;
         }
+        snapshot_updates_.push_back({snapshot_updates_.size(), {MarketUpdateType::SNAPSHOT_END, last_inc_seq_num_}});
+
+        logger_.log("%:% %() % Captured snapshot of % updates at inc seq:%\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_),
+            snapshot_updates_.size(), last_inc_seq_num_);
+        next_batch_time_ = getCurrentNanos();
+        publishSnapshot();
+    }
 
-        const MDPMarketUpdate end_market_update{snapshot_size++, {MarketUpdateType::SNAPSHOT_END, last_inc_seq_num_}};
-        logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), end_market_update.toString());
-        snapshot_socket_.send(&end_market_update, sizeof(MDPMarketUpdate));
+    auto SnapshotSynthesizer::publishSnapshot() -> void {
+        const auto now = getCurrentNanos();
+        if(now < next_batch_time_)
+            return;
+
+        // A batch ends with the packet which fills it, whatever number of updates the encoding fits in its packets
+        size_t batch_size = 0, batch_packets = 0;
+        for(; next_snapshot_update_ < snapshot_updates_.size(); ++next_snapshot_update_, ++batch_size) {
+            if(snapshot_packetizer_.full() && ++batch_packets == cfg_.packets_per_batch_)
+                break;
+            const auto& market_update = snapshot_updates_[next_snapshot_update_];
+            logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), market_update.toString());
+            snapshot_packetizer_.add(market_update);
+        }
+        snapshot_packetizer_.flush();
         snapshot_socket_.sendAndRecv();
 
-        logger_.log("%:% %() % Published snapshot of % orders.\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), snapshot_size - 1);
+        // The next batch is due once this one has been spread over its share of the rate, a late batch does not make up for lost time
+        if(cfg_.max_updates_per_sec_)
+            next_batch_time_ = std::max(next_batch_time_, now) + static_cast<Nanos>(batch_size * NANOS_TO_SECS / cfg_.max_updates_per_sec_);
+
+        if(next_snapshot_update_ == snapshot_updates_.size())
+            logger_.log("%:% %() % Published snapshot of % orders.\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_),
+                snapshot_updates_.size() - ticker_orders_.size() - 2); // less the SNAPSHOT_START, SNAPSHOT_END and CLEAR of every ticker
     }
-} // namespace Exchange
+} // namespace Exchange
\ No newline at end of file
@@ -4,14 +4,35 @@
 #include "common/lf_queue.h"
 #include "common/macros.h"
 #include "common/mcast_socket.h"
-#include "common/mem_pool.h"
 #include "common/logging.h"
 
 #include "market_data/market_update.h"
+#include "market_data/mdp_packetizer.h"
 #include "matcher/me_order.h"
 
 namespace Exchange
 {
+    struct SnapshotCfg {
+        // Time between the starts of consecutive snapshots
+        Nanos interval_ = 10 * NANOS_TO_SECS;
+        // Pace at which snapshot updates go out, 0 sends each snapshot as fast as the socket takes it
+        size_t max_updates_per_sec_ = 100'000;
+        // Full packets handed to the socket, i.e. sent back to back, per paced batch
+        size_t packets_per_batch_ = 4;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "SnapshotCfg[interval_ms:" << interval_ / NANOS_TO_MILLIS
+               << " max_updates_per_sec:" << max_updates_per_sec_
+               << " packets_per_batch:" << packets_per_batch_
+               << "]";
+            return ss.str();
+        }
+    };
+
+    // Maintains the live orders from the incremental updates and publishes them as a snapshot every interval.
+    // A snapshot is captured from the orders in one go, so it is consistent with a single incremental seq number, and then sent out
+    // in paced batches between rounds of incremental processing, so receivers are not hit by a burst of the whole book.
     class SnapshotSynthesizer {
         private:
             MDPMarketUpdateLFQueue* snapshot_md_updates_ = nullptr;
@@ -19,13 +40,30 @@ namespace Exchange
             volatile bool run_;
             std::string time_str_;
             Common::McastSocket snapshot_socket_;
-            std::array<std::array<MEMarketUpdate*, ME_MAX_ORDER_IDS>, ME_MAX_TICKERS> ticker_orders_;
+            MDPPacketizer snapshot_packetizer_;
+            // Live orders of a ticker packed at the front of orders_, a cancel moves the last one into the hole, and the slot in orders_
+            // of every live OrderId. A snapshot only walks the live orders.
+            struct TickerOrders {
+                std::vector<MEMarketUpdate> orders_;
+                std::vector<uint32_t> order_slots_;
+            };
+            static constexpr auto ORDER_SLOT_INVALID = std::numeric_limits<uint32_t>::max();
+            // Every OrderId of a ticker can be live at once, so orders_ is reserved for ME_MAX_ORDER_IDS and snapshot_updates_ for
+            // ME_MAX_SNAPSHOT_UPDATES up front. Only the pages used get faulted in, and neither ever reallocates.
+            std::array<TickerOrders, ME_MAX_TICKERS> ticker_orders_;
             size_t last_inc_seq_num_ = 0;
             Nanos last_snapshot_time_ = 0;
-            MemPool<MEMarketUpdate> order_pool_;
+
+            const SnapshotCfg cfg_;
+            // The snapshot being published, START to END, and the next of its updates to send
+            std::vector<MDPMarketUpdate> snapshot_updates_;
+            size_t next_snapshot_update_ = 0;
+            // Earliest time the next paced batch may go out
+            Nanos next_batch_time_ = 0;
         
         public:
-            SnapshotSynthesizer(MDPMarketUpdateLFQueue* market_updates, const std::string& iface, const std::string& snapshot_ip, int snapshot_port);
+            SnapshotSynthesizer(MDPMarketUpdateLFQueue* market_updates, const std::string& iface, const std::string& snapshot_ip, int snapshot_port,
+                                size_t mtu = MDP_DEFAULT_MTU, MDPEncoding encoding = MDPEncoding::RAW, const SnapshotCfg& cfg = {});
             ~SnapshotSynthesizer();
 
              auto start() {
@@ -40,6 +78,9 @@ namespace Exchange
             auto run() -> void;
 
             auto addToSnapshot(const MDPMarketUpdate* market_update) -> void;
+            // Capture the live orders into snapshot_updates_ and start publishing them
+            auto startSnapshot() -> void;
+            // Send the next paced batch of the snapshot being published, if it is due
             auto publishSnapshot() -> void;
 
             // deleted copy & move constructors and assignment-operators
@@ -0,0 +1,119 @@
+#include "top_of_book_publisher.h"
+
+namespace Exchange
+{
+    TopOfBookPublisher::TopOfBookPublisher(MDPMarketUpdateLFQueue* market_updates, const std::string& iface, const std::string& tob_ip, int tob_port,
+        size_t mtu, const TopOfBookCfg& cfg)
+        : tob_md_updates_(market_updates), logger_("exchange_top_of_book_publisher.log"), tob_socket_(logger_), tob_packetizer_(&tob_socket_, mtu),
+        cfg_(cfg) {
+            ASSERT(tob_socket_.init(tob_ip, iface, tob_port, /* is_listening */ false) >= 0,
+            "Unable to create top-of-book mcast socket. error:" + std::string(std::strerror(errno)));
+            logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), cfg_.toString());
+
+            for(size_t ticker_id = 0; ticker_id < books_.size(); ++ticker_id) {
+                books_[ticker_id].order_qtys_.resize(ME_MAX_ORDER_IDS, 0);
+                books_[ticker_id].top_.ticker_id_ = ticker_id;
+            }
+    }
+
+    TopOfBookPublisher::~TopOfBookPublisher() {
+        stop();
+    }
+
+    auto TopOfBookPublisher::run() noexcept -> void {
+        logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_));
+        while (run_)
+        {
+            for(auto market_update = tob_md_updates_->getNextToRead();
+                tob_md_updates_->size() && market_update; market_update = tob_md_updates_->getNextToRead()) {
+                    onMarketUpdate(market_update);
+                    tob_md_updates_->updateReadIndex();
+                }
+
+            // Everything queued is applied, so only the latest top of each book goes out however many updates there were
+            if(!cfg_.interval_) {
+                publish(false);
+            } else if(getCurrentNanos() - last_publish_time_ >= cfg_.interval_) {
+                last_publish_time_ = getCurrentNanos();
+                publish(true);
+            }
+        }
+    }
+
+    auto TopOfBookPublisher::onMarketUpdate(const MDPMarketUpdate* market_update) noexcept -> void {
+        const auto& me_market_update = market_update->me_market_update_;
+        auto& book = books_.at(me_market_update.ticker_id_);
+        auto& side_levels = (me_market_update.side_ == Side::BUY ? book.bids_ : book.asks_);
+
+        switch (me_market_update.type_)
+        {
+        case MarketUpdateType::ADD: {
+            book.order_qtys_.at(me_market_update.order_id_) = me_market_update.qty_;
+            updateLevel(side_levels, me_market_update.side_, me_market_update.price_, me_market_update.qty_);
+            break;
+        }
+        case MarketUpdateType::MODIFY: {
+            auto& order_qty = book.order_qtys_.at(me_market_update.order_id_);
+            updateLevel(side_levels, me_market_update.side_, me_market_update.price_, static_cast<int64_t>(me_market_update.qty_) - order_qty);
+            order_qty = me_market_update.qty_;
+            break;
+        }
+        case MarketUpdateType::CANCEL: {
+            auto& order_qty = book.order_qtys_.at(me_market_update.order_id_);
+            updateLevel(side_levels, me_market_update.side_, me_market_update.price_, -static_cast<int64_t>(order_qty));
+            order_qty = 0;
+            break;
+        }
+        default:
+            break;
+        }
+
+        auto& top = book.top_;
+        top.seq_num_ = market_update->seq_num_;
+        const auto bid_qty = static_cast<Qty>(book.bids_.best_price_ != Price_INVALID ? book.bids_.levels_[book.bids_.best_price_ % ME_MAX_PRICE_LEVELS].qty_ : 0);
+        const auto ask_qty = static_cast<Qty>(book.asks_.best_price_ != Price_INVALID ? book.asks_.levels_[book.asks_.best_price_ % ME_MAX_PRICE_LEVELS].qty_ : 0);
+        if(top.bid_price_ != book.bids_.best_price_ || top.bid_qty_ != bid_qty || top.ask_price_ != book.asks_.best_price_ || top.ask_qty_ != ask_qty) {
+            top.bid_price_ = book.bids_.best_price_;
+            top.bid_qty_ = bid_qty;
+            top.ask_price_ = book.asks_.best_price_;
+            top.ask_qty_ = ask_qty;
+            book.changed_ = true;
+        }
+    }
+
+    auto TopOfBookPublisher::updateLevel(SideLevels& side_levels, Side side, Price price, int64_t qty_delta) noexcept -> void {
+        auto& level = side_levels.levels_[price % ME_MAX_PRICE_LEVELS];
+        level.price_ = price;
+        level.qty_ += qty_delta;
+
+        const auto is_better = [side](Price candidate, Price best) { return best == Price_INVALID || (side == Side::BUY ? candidate > best : candidate < best); };
+        if(level.qty_) {
+            if(is_better(price, side_levels.best_price_))
+                side_levels.best_price_ = price;
+        } else if(price == side_levels.best_price_) {
+            // The best level emptied, the next best is found among the ME_MAX_PRICE_LEVELS levels, a single pass over a few KB
+            side_levels.best_price_ = Price_INVALID;
+            for(const auto& other: side_levels.levels_) {
+                if(other.qty_ && is_better(other.price_, side_levels.best_price_))
+                    side_levels.best_price_ = other.price_;
+            }
+        }
+    }
+
+    auto TopOfBookPublisher::publish(bool all) noexcept -> void {
+        bool published = false;
+        for(auto& book: books_) {
+            if(all || book.changed_) {
+                logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), book.top_.toString());
+                tob_packetizer_.add(book.top_);
+                book.changed_ = false;
+                published = true;
+            }
+        }
+
+        if(published) {
+            tob_packetizer_.flush();
+            tob_socket_.sendAndRecv();
+        }
+    }
+} // namespace Exchange
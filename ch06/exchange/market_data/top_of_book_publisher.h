@@ -0,0 +1,90 @@
+#pragma once
+#include "common/types.h"
+#include "common/thread_utils.h"
+#include "common/lf_queue.h"
+#include "common/macros.h"
+#include "common/mcast_socket.h"
+#include "common/logging.h"
+
+#include "market_data/market_update.h"
+#include "market_data/mdp_packetizer.h"
+
+namespace Exchange
+{
+    struct TopOfBookCfg {
+        // Time between publications of the top of every book, 0 publishes a book as soon as its top changes
+        Nanos interval_ = 100 * NANOS_TO_MILLIS;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "TopOfBookCfg[interval_ms:" << interval_ / NANOS_TO_MILLIS << "]";
+            return ss.str();
+        }
+    };
+
+    // Maintains the best bid and offer of every ticker from the incremental updates and publishes only their latest state, as fixed-size
+    // MDPTopOfBooks on their own group. Consumers that cannot keep up with the full incremental feed, like risk and position monitors,
+    // never fall behind: whatever happened in between, they get one message per ticker per interval, or per change of its top.
+    class TopOfBookPublisher {
+        private:
+            MDPMarketUpdateLFQueue* tob_md_updates_ = nullptr;
+            Common::Logger logger_;
+            volatile bool run_ = false;
+            std::string time_str_;
+            Common::McastSocket tob_socket_;
+            TopOfBookPacketizer tob_packetizer_;
+
+            // Total qty at each price of a side of a book, indexed by price like the matching engine's price levels, and the best price
+            struct Level {
+                Price price_ = Price_INVALID;
+                uint64_t qty_ = 0;
+            };
+            struct SideLevels {
+                std::array<Level, ME_MAX_PRICE_LEVELS> levels_;
+                Price best_price_ = Price_INVALID;
+            };
+            struct TickerBook {
+                // Open qty of every live OrderId, MODIFYs and CANCELs only carry the new qty
+                std::vector<Qty> order_qtys_;
+                SideLevels bids_, asks_;
+                // Latest state, and whether it changed since it was last published
+                MDPTopOfBook top_;
+                bool changed_ = false;
+            };
+            std::array<TickerBook, ME_MAX_TICKERS> books_;
+
+            const TopOfBookCfg cfg_;
+            Nanos last_publish_time_ = 0;
+
+            // Add qty_delta to the level at price and move the best price if the level became or stopped being the best
+            auto updateLevel(SideLevels& side_levels, Side side, Price price, int64_t qty_delta) noexcept -> void;
+
+        public:
+            TopOfBookPublisher(MDPMarketUpdateLFQueue* market_updates, const std::string& iface, const std::string& tob_ip, int tob_port,
+                               size_t mtu = MDP_DEFAULT_MTU, const TopOfBookCfg& cfg = {});
+            ~TopOfBookPublisher();
+
+            auto start() {
+                run_ = true;
+                ASSERT(Common::createAndStartThread(-1, "Exchange/TopOfBookPublisher", [this]() { run(); }) != nullptr, "Failed to start TopOfBookPublisher thread.");
+            }
+
+            auto stop() -> void {
+                run_ = false;
+            }
+
+            auto run() noexcept -> void;
+
+            auto onMarketUpdate(const MDPMarketUpdate* market_update) noexcept -> void;
+
+            // Send the top of every book changed since the last call, or of every book if all is set
+            auto publish(bool all) noexcept -> void;
+
+            // deleted default, copy & move constructors and assignment-operators
+            TopOfBookPublisher() = delete;
+            TopOfBookPublisher(const TopOfBookPublisher&) = delete;
+            TopOfBookPublisher(const TopOfBookPublisher&&) = delete;
+            TopOfBookPublisher &operator=(const TopOfBookPublisher&) = delete;
+            TopOfBookPublisher &operator=(const TopOfBookPublisher&&) = delete;
+    };
+} // namespace Exchange
@@ -4,15 +4,19 @@ namespace Exchange
 {
     MatchingEngine::MatchingEngine(ClientRequestLFQueue *client_requests,
                             ClientResponseLFQueue *client_responses,
-                            MEMarketUpdateLFQueue *market_updates) 
+                            MEMarketUpdateLFQueue *market_updates,
+                            MEPriceLevelUpdateLFQueue *price_level_updates,
+                            size_t mbp_depth)
                             : incoming_requests_(client_requests),
                               outgoing_ogw_responses_(client_responses),
                               outgoing_md_updates_(market_updates),
-                              logger_("exchange_matching_engine.log")
+                              outgoing_price_level_updates_(price_level_updates),
+                              logger_("exchange_matching_engine.log"),
+                              perf_sampler_("MatchingEngine", &logger_, Common::PERF_COUNTERS_REPORT_EVERY)
                             {
                                 for (size_t i = 0; i < ticker_order_book_.size(); i++)
                                 {
-                                    ticker_order_book_[i] = new MEOrderBook(i, &logger_, this);
+                                    ticker_order_book_[i] = new MEOrderBook(i, &logger_, this, price_level_updates ? mbp_depth : 0);
                                 }
                                 
                             }
@@ -25,6 +29,7 @@ namespace Exchange
         incoming_requests_ = nullptr;
         outgoing_ogw_responses_ = nullptr;
         outgoing_md_updates_ = nullptr;
+        outgoing_price_level_updates_ = nullptr;
 
         for(auto& order_book : ticker_order_book_) {
             delete order_book;
@@ -2,6 +2,7 @@
 #include "common/thread_utils.h"
 #include "common/lf_queue.h"
 #include "common/macros.h"
+#include "common/perf_counters.h"
 #include "order_server/client_request.h"
 #include "order_server/client_response.h"
 #include "market_data/market_update.h"
@@ -11,9 +12,12 @@ namespace Exchange
 {
     class MatchingEngine final {
         public:
+            // With price_level_updates the books also publish changes to their top mbp_depth price levels for the market-by-price feed
             MatchingEngine(ClientRequestLFQueue *client_requests,
                             ClientResponseLFQueue *client_responses,
-                            MEMarketUpdateLFQueue *market_updates);
+                            MEMarketUpdateLFQueue *market_updates,
+                            MEPriceLevelUpdateLFQueue *price_level_updates = nullptr,
+                            size_t mbp_depth = MBP_DEFAULT_DEPTH);
             ~MatchingEngine();
             auto start() -> void;
             auto stop() -> void;
@@ -56,13 +60,22 @@ namespace Exchange
                 outgoing_md_updates_->updateWriteIndex();
             }
 
+            auto sendPriceLevelUpdate(const MEPriceLevelUpdate *price_level_update) noexcept {
+                logger_.log("%:% %() % Sending %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), price_level_update->toString());
+                auto next_write = outgoing_price_level_updates_->getNextToWriteTo();
+                *next_write = *price_level_update;
+                outgoing_price_level_updates_->updateWriteIndex();
+            }
+
             auto run() noexcept {
                 logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+                perf_sampler_.open();
                 while (run_)
                 {
                     const auto me_client_request = incoming_requests_->getNextToRead();
                     if (LIKELY(me_client_request))
                     {
+                        Common::PerfCounterScope perf_scope(&perf_sampler_);
                         logger_.log("%:% %() % Processing %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), me_client_request->toString());
                         processClientRequest(me_client_request);
                         incoming_requests_->updateReadIndex();
@@ -82,8 +95,12 @@ namespace Exchange
             ClientRequestLFQueue *incoming_requests_ = nullptr;
             ClientResponseLFQueue *outgoing_ogw_responses_ = nullptr;
             MEMarketUpdateLFQueue *outgoing_md_updates_ = nullptr;
+            MEPriceLevelUpdateLFQueue *outgoing_price_level_updates_ = nullptr;
             volatile bool run_;
             std::string time_str_;
             Logger logger_;
+
+            // Hardware counters sampled around the processing of every client request
+            Common::PerfCounterSampler perf_sampler_;
     };
 } // namespace Exchange
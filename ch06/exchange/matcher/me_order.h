@@ -57,6 +57,10 @@ namespace Exchange
 
         MEOrder *first_me_order_ = nullptr;
 
+        // Total qty and number of the orders at this price, the level data published on the market-by-price feed
+        Qty qty_ = 0;
+        uint32_t num_orders_ = 0;
+
         // MEOrdersAtPrice also serve as a node in a doubly linked list of price levels arranged from the most aggressive to least aggressive price
         MEOrdersAtPrice *prev_entry_ = nullptr;
         MEOrdersAtPrice *next_entry_ = nullptr;
@@ -3,9 +3,9 @@
 
 namespace Exchange
 {
-    MEOrderBook::MEOrderBook(TickerId ticker_id, Logger* logger, MatchingEngine* matching_engine)
+    MEOrderBook::MEOrderBook(TickerId ticker_id, Logger* logger, MatchingEngine* matching_engine, size_t mbp_depth)
         : ticker_id_(ticker_id), matching_engine_(matching_engine), orders_at_price_pool_(ME_MAX_PRICE_LEVELS),
-        order_pool_(ME_MAX_ORDER_IDS), logger_(logger) {
+        order_pool_(ME_MAX_ORDER_IDS), mbp_depth_(mbp_depth), logger_(logger) {
 
     }
 
@@ -25,6 +25,7 @@ namespace Exchange
 
         *leaves_qty -= fill_qty;
         order->qty_ -= fill_qty;
+        getOrdersAtPrice(order->price_)->qty_ -= fill_qty;
 
         client_response_ = {ClientResponseType::FILLED, client_id, ticker_id, client_order_id, new_market_order_id, side, itr->price_, fill_qty, *leaves_qty};
         matching_engine_->sendClientResponse(&client_response_);
@@ -42,9 +43,16 @@ namespace Exchange
         } else {
             market_update_ = {MarketUpdateType::MODIFY, order->market_order_id_, ticker_id, order->side_, order->price_, order->qty_, order->priority_};
             matching_engine_->sendMarketUpdate(&market_update_);
+            onLevelChanged(getOrdersAtPrice(order->price_));
         }
     }
 
+    auto MEOrderBook::sendPriceLevelUpdate(const MEOrdersAtPrice* orders_at_price, bool left_top_levels) noexcept -> void {
+        price_level_update_ = {ticker_id_, orders_at_price->side_, orders_at_price->price_,
+                               left_top_levels ? 0 : orders_at_price->qty_, left_top_levels ? 0 : orders_at_price->num_orders_};
+        matching_engine_->sendPriceLevelUpdate(&price_level_update_);
+    }
+
     auto MEOrderBook::checkForMatch(TickerId ticker_id, ClientId client_id, Side side, Price price, OrderId client_order_id, OrderId new_market_order_id, Qty qty) noexcept {
         auto leaves_qty = qty;
 
@@ -80,7 +88,7 @@ namespace Exchange
         client_response_ = {ClientResponseType::ACCEPTED, client_id, ticker_id, client_order_id, new_market_oder_id, side, price, 0, qty};
         matching_engine_->sendClientResponse(&client_response_);
 
-        const auto leaves_qty = checkForMatch(ticker_id, client_id, side, price, client_order_id, qty, new_market_oder_id);
+        const auto leaves_qty = checkForMatch(ticker_id, client_id, side, price, client_order_id, new_market_oder_id, qty);
 
         if(LIKELY(leaves_qty)) {
             const auto priority = getNextPriority(price);
@@ -155,7 +163,7 @@ namespace Exchange
             ss << std::endl;
 
             if(sanity_check) {
-                if((side == Side::SELL && itr->price_ >= last_price) || (side == Side::BUY && itr->price_ <= last_price)) {
+                if((side == Side::SELL && itr->price_ <= last_price) || (side == Side::BUY && itr->price_ >= last_price)) {
                     FATAL("Bids/Asks are not sorted by ascending/descending prices last:" + priceToString(last_price) + " itr:" + itr->toString());
                 }
 
@@ -16,7 +16,8 @@ namespace Exchange
 
     class MEOrderBook final {
         public:
-            explicit MEOrderBook(TickerId ticker_id, Logger* logger, MatchingEngine* matching_engine);
+            // mbp_depth is the number of price levels per side published on the market-by-price feed, 0 if it is disabled
+            explicit MEOrderBook(TickerId ticker_id, Logger* logger, MatchingEngine* matching_engine, size_t mbp_depth = 0);
             ~MEOrderBook();
 
             auto add(ClientId client_id, OrderId client_order_id, TickerId ticker_id, Side side, Price price, Qty qty) noexcept -> void;
@@ -57,6 +58,9 @@ namespace Exchange
             MEClientResponse client_response_;
             MEMarketUpdate market_update_;
 
+            size_t mbp_depth_ = 0;
+            MEPriceLevelUpdate price_level_update_;
+
             OrderId next_market_order_id_ = 1;
 
             std::string time_str_;
@@ -133,8 +137,8 @@ namespace Exchange
                         target->prev_entry_->next_entry_ = new_orders_at_price;
                         target->prev_entry_ = new_orders_at_price;
 
-                        if((new_orders_at_price->side_ == Side::SELL && new_orders_at_price->price_ > best_orders_by_price->price_) ||
-                                    (new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ < best_orders_by_price->price_)) {
+                        if((new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ > best_orders_by_price->price_) ||
+                                    (new_orders_at_price->side_ == Side::SELL && new_orders_at_price->price_ < best_orders_by_price->price_)) {
                             target->next_entry_ = (target->next_entry_ ==  best_orders_by_price ? new_orders_at_price : target->next_entry_);
                             (new_orders_at_price->side_ == Side::BUY ? bids_by_price_ : asks_by_price_) = new_orders_at_price; 
                         }
@@ -165,6 +169,58 @@ namespace Exchange
                 orders_at_price_pool_.deallocate(orders_at_price);
             }
 
+            // Side of the book at depth levels from the best price, nullptr if the side has fewer levels
+            auto levelAtDepth(Side side, size_t depth) const noexcept -> MEOrdersAtPrice* {
+                const auto best_orders_by_price = (side == Side::BUY ? bids_by_price_ : asks_by_price_);
+                auto itr = best_orders_by_price;
+                for(; itr && depth; --depth) {
+                    itr = itr->next_entry_;
+                    if(itr == best_orders_by_price)
+                        return nullptr;
+                }
+                return itr;
+            }
+
+            // Whether orders_at_price is among the top mbp_depth_ levels of its side, always false with the market-by-price feed disabled
+            auto isTopLevel(const MEOrdersAtPrice* orders_at_price) const noexcept {
+                const auto best_orders_by_price = (orders_at_price->side_ == Side::BUY ? bids_by_price_ : asks_by_price_);
+                auto itr = best_orders_by_price;
+                for(size_t depth = 0; depth < mbp_depth_; ++depth) {
+                    if(itr == orders_at_price)
+                        return true;
+                    itr = itr->next_entry_;
+                    if(itr == best_orders_by_price)
+                        break;
+                }
+                return false;
+            }
+
+            auto sendPriceLevelUpdate(const MEOrdersAtPrice* orders_at_price, bool left_top_levels) noexcept -> void;
+
+            // Publish the new state of a top level whose qty or number of orders changed
+            auto onLevelChanged(const MEOrdersAtPrice* orders_at_price) noexcept {
+                if(isTopLevel(orders_at_price))
+                    sendPriceLevelUpdate(orders_at_price, false);
+            }
+
+            // Called once a new level is linked in, a new top level pushes the last top level out
+            auto onLevelAdded(const MEOrdersAtPrice* orders_at_price) noexcept {
+                if(isTopLevel(orders_at_price)) {
+                    sendPriceLevelUpdate(orders_at_price, false);
+                    if(const auto pushed_out = levelAtDepth(orders_at_price->side_, mbp_depth_))
+                        sendPriceLevelUpdate(pushed_out, true);
+                }
+            }
+
+            // Called before an emptied level is unlinked, removing a top level pulls the next level in
+            auto onLevelRemoved(const MEOrdersAtPrice* orders_at_price) noexcept {
+                if(isTopLevel(orders_at_price)) {
+                    sendPriceLevelUpdate(orders_at_price, true);
+                    if(const auto pulled_in = levelAtDepth(orders_at_price->side_, mbp_depth_))
+                        sendPriceLevelUpdate(pulled_in, false);
+                }
+            }
+
             auto addOrder(MEOrder* order) noexcept {
                 const auto orders_at_price = getOrdersAtPrice(order->price_);
 
@@ -173,13 +229,19 @@ namespace Exchange
                     order->next_order_ = order->prev_order_ = order;
 
                     auto new_orders_at_price = orders_at_price_pool_.allocate(order->side_, order->price_, order, nullptr, nullptr);
+                    new_orders_at_price->qty_ = order->qty_;
+                    new_orders_at_price->num_orders_ = 1;
                     addOrdersAtPrice(new_orders_at_price);
+                    onLevelAdded(new_orders_at_price);
                 } else {
                     auto first_order = (orders_at_price ? orders_at_price->first_me_order_ : nullptr);
                     first_order->prev_order_->next_order_ = order;
                     order->prev_order_ = first_order->prev_order_;
                     order->next_order_ = first_order;
                     first_order->prev_order_ = order;
+                    orders_at_price->qty_ += order->qty_;
+                    ++orders_at_price->num_orders_;
+                    onLevelChanged(orders_at_price);
                 }
 
                 cid_oid_to_order_.at(order->client_id_).at(order->client_order_id_) = order;
@@ -188,8 +250,11 @@ namespace Exchange
             //mRemove and de-allocate provided order from the containers
             auto removeOrder(MEOrder* order) noexcept {
                 auto orders_at_price = getOrdersAtPrice(order->price_);
+                orders_at_price->qty_ -= order->qty_;
+                --orders_at_price->num_orders_;
 
                 if(order->prev_order_ == order) { // only one element
+                    onLevelRemoved(orders_at_price);
                     removeOrdersAtPrice(order->side_, order->price_);
                 } else { // remove the link
                     const auto order_before = order->prev_order_;
@@ -202,6 +267,7 @@ namespace Exchange
                     }
 
                     order->prev_order_ = order->next_order_ = nullptr;
+                    onLevelChanged(orders_at_price);
                 }
 
                 cid_oid_to_order_.at(order->client_id_).at(order->client_order_id_) = nullptr;
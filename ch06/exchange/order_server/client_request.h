@@ -1,6 +1,7 @@
 #pragma once
 #include <sstream>
 #include "common/types.h"
+#include "common/time_utils.h"
 #include "common/lf_queue.h"
 
 using namespace Common;
@@ -60,6 +61,11 @@ namespace Exchange {
         size_t seq_num_ = 0;
         MEClientRequest me_client_request_;
 
+        // Optional tick-to-trade stamps, zero unless set. They are optional trailing fields of the SBE encoding and never reach the matching engine.
+        Nanos md_publish_time_ = 0; // publish time of the market update which triggered this request
+        Nanos md_recv_time_ = 0;    // time the trading client read that market update off the socket
+        Nanos send_time_ = 0;       // set by OrderGateway just before a request with market data stamps is written to the socket
+
         auto toString() const {
             std::stringstream ss;
             ss << "OMClientRequest"
@@ -72,5 +78,16 @@ namespace Exchange {
     };
     
     #pragma pack(pop)
+
+    // Element of the queue from a trading client's strategy to its OrderGateway, the request with the stamps of the market update which
+    // triggered it, zero if none did. The stamps sit beside the request, so the exchange's request queues never carry them.
+    struct OGWClientRequest
+    {
+        MEClientRequest me_client_request_;
+        Nanos md_publish_time_ = 0;
+        Nanos md_recv_time_ = 0;
+    };
+
     typedef LFQueue<MEClientRequest> ClientRequestLFQueue;
+    typedef LFQueue<OGWClientRequest> OGWClientRequestLFQueue;
 }
\ No newline at end of file
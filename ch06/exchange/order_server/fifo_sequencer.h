@@ -16,12 +16,14 @@ namespace Exchange {
             }
 
             auto addClientRequest(Nanos rx_time, const MEClientRequest& request) {
-                if(pending_size_ >= pending_client_requests_.size())
-                    FATAL("Too many pending requests");
+                if(UNLIKELY(pending_size_ >= pending_client_requests_.size())) { // a single read burst filled the window, publish what we have early
+                    logger_->log("%:% %() % WARN Pending requests full, publishing % early.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), pending_size_);
+                    sequenceAndPublish();
+                }
                 pending_client_requests_.at(pending_size_++) = std::move(RecvTimeClientRequest{rx_time, request});
             }
 
-            auto sequenceAndPublish() {
+            auto sequenceAndPublish() -> void {
                 if(UNLIKELY(!pending_size_))
                     return;
                 
@@ -37,6 +39,8 @@ namespace Exchange {
                     *next_write = std::move(client_request.request_);
                     incoming_requests_->updateWriteIndex();
                 }
+
+                pending_size_ = 0;
             }
 
             // deleted copy & move constructors and assignment-operators
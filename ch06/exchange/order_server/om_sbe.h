@@ -0,0 +1,52 @@
+#pragma once
+
+#include "common/sbe.h"
+
+#include "exchange/order_server/client_request.h"
+
+namespace Exchange
+{
+    // SBE layouts of OMClientRequest, one template per ClientRequestType with the template id its value. The tick-to-trade stamps are
+    // optional, so requests from clients which do not set them leave them out of the block.
+    constexpr uint8_t OM_SBE_VERSION = 1;
+
+    static_assert(ME_MAX_TICKERS <= std::numeric_limits<uint16_t>::max(), "TickerIds are encoded in 16 bits.");
+
+    template<ClientRequestType Type, typename... Fields>
+    using OMSBEMessage = SBEMessage<static_cast<uint8_t>(Type), OM_SBE_VERSION, Fields...>;
+
+    template<typename Wire, auto Member>
+    using OMSBEField = SBEField<Wire, &OMClientRequest::me_client_request_, Member>;
+
+    template<auto Member>
+    using OMSBEStamp = SBEOptionalField<uint64_t, Member>;
+
+    using OMSBESeqNum = SBEField<uint64_t, &OMClientRequest::seq_num_>;
+    using OMSBEClientId = OMSBEField<uint32_t, &MEClientRequest::client_id_>;
+    using OMSBETickerId = OMSBEField<uint16_t, &MEClientRequest::ticker_id_>;
+    using OMSBEOrderId = OMSBEField<uint64_t, &MEClientRequest::order_id_>;
+    using OMSBESide = OMSBEField<int8_t, &MEClientRequest::side_>;
+    using OMSBEPrice = OMSBEField<uint64_t, &MEClientRequest::price_>;
+    using OMSBEQty = OMSBEField<uint32_t, &MEClientRequest::qty_>;
+
+    typedef SBESchema<
+        OMSBEMessage<ClientRequestType::NEW, OMSBESeqNum, OMSBEClientId, OMSBETickerId, OMSBEOrderId, OMSBESide, OMSBEPrice, OMSBEQty,
+                     OMSBEStamp<&OMClientRequest::md_publish_time_>, OMSBEStamp<&OMClientRequest::md_recv_time_>, OMSBEStamp<&OMClientRequest::send_time_>>,
+        OMSBEMessage<ClientRequestType::CANCEL, OMSBESeqNum, OMSBEClientId, OMSBETickerId, OMSBEOrderId,
+                     OMSBEStamp<&OMClientRequest::md_publish_time_>, OMSBEStamp<&OMClientRequest::md_recv_time_>, OMSBEStamp<&OMClientRequest::send_time_>>
+    > OMSBESchema;
+
+    // Encode client_request to dst, which must hold OMSBESchema::MAX_LENGTH bytes, and return the length written
+    inline auto sbeEncode(const OMClientRequest& client_request, char* dst) noexcept -> size_t {
+        return OMSBESchema::encode(static_cast<uint8_t>(client_request.me_client_request_.type_), client_request, dst);
+    }
+
+    // Decode the message at src, of which len bytes are readable, into client_request and return its length, 0 if it is incomplete.
+    // A message of a template not in the schema decodes as type INVALID.
+    inline auto sbeDecode(const char* src, size_t len, OMClientRequest* client_request) noexcept -> size_t {
+        uint8_t template_id = 0;
+        const auto decoded = OMSBESchema::decode(src, len, client_request, &template_id);
+        client_request->me_client_request_.type_ = static_cast<ClientRequestType>(template_id);
+        return decoded;
+    }
+}
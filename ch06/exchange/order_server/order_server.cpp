@@ -4,15 +4,17 @@ using namespace Common;
 
 namespace Exchange
 {
-    OrderServer::OrderServer(ClientRequestLFQueue* client_requests, ClientResponseLFQueue* client_responses, const std::string& iface, int port) 
+    OrderServer::OrderServer(ClientRequestLFQueue* client_requests, ClientResponseLFQueue* client_responses, const std::string& iface, int port,
+                            Common::TCPBackend tcp_backend, const Common::IOUringCfg& uring_cfg, const Common::TCPSocketPoolCfg& pool_cfg) 
     : iface_(iface), port_(port), outgoing_responses_(client_responses), logger_("exchange_order_server.log"), 
-    tcp_server_(logger_), fifo_sequencer_(client_requests, &logger_) {
+    tcp_server_(logger_, tcp_backend, uring_cfg, pool_cfg), fifo_sequencer_(client_requests, &logger_), tick_to_trade_(&logger_, TICK_TO_TRADE_REPORT_EVERY) {
         cid_next_outgoing_seq_num_.fill(1);
         cid_next_exp_seq_num_.fill(1);
         cid_tcp_socket_.fill(nullptr);
 
         tcp_server_.recv_callback_ = [this](auto socket, auto rx_time) { recvCallback(socket, rx_time); };
         tcp_server_.recev_finished_callback_ = [this]() { recvFinishedCallback(); };
+        tcp_server_.disconnect_callback_ = [this](auto socket) { disconnectCallback(socket); };
     }
 
     OrderServer::~OrderServer() {
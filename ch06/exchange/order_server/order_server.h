@@ -7,8 +7,10 @@
 #include "common/tcp_server.h"
 
 #include "order_server/client_request.h"
+#include "order_server/om_sbe.h"
 #include "order_server/client_response.h"
 #include "order_server/fifo_sequencer.h"
+#include "order_server/tick_to_trade_collector.h"
 
 namespace Exchange
 {
@@ -31,9 +33,16 @@ namespace Exchange
             TCPServer tcp_server_;
             // FIFO Sequencer responsible for ensuring incoming client requests are processed in the order in which they are received
             FIFOSequencer fifo_sequencer_;
+
+            // Target requests are decoded into off the wire
+            OMClientRequest decoded_request_;
+            // Tick-to-trade histograms built from the timestamp trailer on client requests
+            TickToTradeCollector tick_to_trade_;
             
         public:
-            OrderServer(ClientRequestLFQueue* client_requests, ClientResponseLFQueue* client_responses, const std::string& iface, int port);
+            OrderServer(ClientRequestLFQueue* client_requests, ClientResponseLFQueue* client_responses, const std::string& iface, int port,
+                        Common::TCPBackend tcp_backend = Common::TCPBackend::EPOLL, const Common::IOUringCfg& uring_cfg = {},
+                        const Common::TCPSocketPoolCfg& pool_cfg = {});
             ~OrderServer();
 
             auto start() -> void;
@@ -51,10 +60,18 @@ namespace Exchange
                         logger_.log("%:% %() % Processing cid:% seq:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
                         client_response->client_id_, next_outgoing_seq_num, client_response->toString());
 
-                        ASSERT(cid_tcp_socket_[client_response->client_id_] != nullptr,
-                            "Don\'t have a TCPSocket for ClientId:" + std::to_string(client_response->client_id_));
-                        cid_tcp_socket_[client_response->client_id_]->send(&next_outgoing_seq_num, sizeof(next_outgoing_seq_num));
-                        cid_tcp_socket_[client_response->client_id_]->send(client_response, sizeof(MEClientResponse));
+                        auto socket = cid_tcp_socket_[client_response->client_id_];
+                        if(UNLIKELY(socket == nullptr)) { // the client disconnected, e.g. one of its resting orders traded after it left
+                            logger_.log("%:% %() % Dropping response for disconnected ClientId:% %\n", __FILE__, __LINE__, __FUNCTION__,
+                                Common::getCurrentTimeStr(&time_str_), client_response->client_id_, client_response->toString());
+                            outgoing_responses_->updateReadIndex();
+                            continue;
+                        }
+                        // The client is not draining its socket, leave this and later responses queued until its outbound ring has room
+                        if(UNLIKELY(!socket->reserveSend(sizeof(next_outgoing_seq_num) + sizeof(MEClientResponse))))
+                            break;
+                        socket->send(&next_outgoing_seq_num, sizeof(next_outgoing_seq_num));
+                        socket->send(client_response, sizeof(MEClientResponse));
 
                         outgoing_responses_->updateReadIndex();
 
@@ -67,38 +84,43 @@ namespace Exchange
             // Callback methods for TCP server
             auto recvCallback(Common::TCPSocket* socket, Common::Nanos rx_time) noexcept {
                 logger_.log("%:% %() % Received socket:% len:% rx:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                socket->socket_fd_, socket->next_rcv_valid_index_, rx_time);
+                socket->socket_fd_, socket->inbound_data_.readable(), rx_time);
+
+                // Requests are SBE encoded, a trailing partial message stays in the buffer until the rest of it is received
+                auto& inbound_data = socket->inbound_data_;
+                for(size_t len; (len = sbeDecode(inbound_data.readPtr(), inbound_data.readable(), &decoded_request_)); ) {
+                    inbound_data.consume(len);
+                    const auto request = &decoded_request_;
+                    if(UNLIKELY(request->me_client_request_.type_ == ClientRequestType::INVALID)) { // template of a newer schema
+                        logger_.log("%:% %() % Skipped unknown request of len:% from socket:%\n", __FILE__, __LINE__, __FUNCTION__,
+                            Common::getCurrentTimeStr(&time_str_), len, socket->socket_fd_);
+                        continue;
+                    }
+                    logger_.log("%:% %() % Received % \n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), request->toString());
 
-                if(socket->next_rcv_valid_index_ >= sizeof(OMClientRequest)) {
-                    size_t i = 0;
-                    for(; i + sizeof(OMClientRequest) <= socket->next_rcv_valid_index_; i += sizeof(OMClientRequest)) {
-                        auto request = reinterpret_cast<const OMClientRequest*>(socket->inbound_data_.data() + i);
-                        logger_.log("%:% %() % Received % \n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), request->toString());
+                    if(UNLIKELY(cid_tcp_socket_[request->me_client_request_.client_id_] == nullptr)) { // first message back to the client
+                        cid_tcp_socket_[request->me_client_request_.client_id_] = socket;
+                    }
 
-                        if(UNLIKELY(cid_tcp_socket_[request->me_client_request_.client_id_] == nullptr)) { // first message back to the client
-                            cid_tcp_socket_[request->me_client_request_.client_id_] = socket;
-                        }
+                    if(cid_tcp_socket_[request->me_client_request_.client_id_] != socket) { // TODO - change this to send a reject back to the client
+                        logger_.log("%:% %() % Received ClientRequest from ClientId:% on different socket:% expected:%", 
+                            __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), request->me_client_request_.client_id_, socket->socket_fd_,
+                        cid_tcp_socket_[request->me_client_request_.client_id_]->socket_fd_);
+                        continue;
+                    }
 
-                        if(cid_tcp_socket_[request->me_client_request_.client_id_] != socket) { // TODO - change this to send a reject back to the client
-                            logger_.log("%:% %() % Received ClientRequest from ClientId:% on different socket:% expected:%", 
-                                __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), request->me_client_request_.client_id_, socket->socket_fd_,
-                            cid_tcp_socket_[request->me_client_request_.client_id_]->socket_fd_);
-                            continue;
-                        }
+                    auto& next_exp_seq_num = cid_next_exp_seq_num_[request->me_client_request_.client_id_];
+                    if(request->seq_num_ != next_exp_seq_num) { // TODO - change this to send a reject back to the client
+                        logger_.log("%:% %() Incorrect sequence number. ClientId:% SeqNum expected:% received:%", __FILE__, __LINE__, __FUNCTION__,
+                        Common::getCurrentTimeStr(&time_str_), request->me_client_request_.client_id_, next_exp_seq_num, request->seq_num_);
+                        continue;
+                    }
 
-                        auto& next_exp_seq_num = cid_next_exp_seq_num_[request->me_client_request_.client_id_];
-                        if(request->seq_num_ != next_exp_seq_num) { // TODO - change this to send a reject back to the client
-                            logger_.log("%:% %() Incorrect sequence number. ClientId:% SeqNum expected:% received:%", __FILE__, __LINE__, __FUNCTION__,
-                            Common::getCurrentTimeStr(&time_str_), request->me_client_request_.client_id_, next_exp_seq_num, request->seq_num_);
-                            continue;
-                        }
+                    ++next_exp_seq_num;
 
-                        ++next_exp_seq_num;
+                    tick_to_trade_.record(*request, rx_time);
 
-                        fifo_sequencer_.addClientRequest(rx_time, request->me_client_request_);
-                    }
-                    memcpy(socket->inbound_data_.data(), socket->inbound_data_.data() + i, socket->next_rcv_valid_index_ - i);
-                    socket->next_rcv_valid_index_ -= i;
+                    fifo_sequencer_.addClientRequest(rx_time, request->me_client_request_);
                 }
             }
 
@@ -106,6 +128,19 @@ namespace Exchange
                 fifo_sequencer_.sequenceAndPublish();
             }
 
+            // The connection of socket is gone, the client it belonged to starts over from sequence number 1 when it connects again
+            auto disconnectCallback(Common::TCPSocket* socket) noexcept {
+                for(size_t client_id = 0; client_id < cid_tcp_socket_.size(); ++client_id) {
+                    if(cid_tcp_socket_[client_id] != socket)
+                        continue;
+
+                    logger_.log("%:% %() % ClientId:% disconnected socket:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                        client_id, socket->socket_fd_);
+                    cid_tcp_socket_[client_id] = nullptr;
+                    cid_next_outgoing_seq_num_[client_id] = cid_next_exp_seq_num_[client_id] = 1;
+                }
+            }
+
             // deleted copy & move constructors and assignment-operators
             OrderServer() = default;
             OrderServer(const OrderServer&) = delete;
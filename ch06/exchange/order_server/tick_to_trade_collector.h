@@ -0,0 +1,65 @@
+#pragma once
+
+#include "common/macros.h"
+#include "common/logging.h"
+#include "common/time_utils.h"
+#include "common/latency_histogram.h"
+
+#include "order_server/client_request.h"
+
+namespace Exchange
+{
+    // Default number of samples aggregated in every TickToTradeCollector report
+    constexpr size_t TICK_TO_TRADE_REPORT_EVERY = 1000;
+
+    // Builds tick-to-trade histograms from the timestamp trailer on incoming client requests.
+    // A request carries the publish and receive time of the market update which triggered it and its own send time, so the total
+    // latency from the exchange publishing a tick to receiving the reaction to it is broken down into its legs.
+    // All stamps come from Common::getCurrentNanos(), so the legs are only meaningful when both sides run on the same box.
+    class TickToTradeCollector final {
+        public:
+            TickToTradeCollector(Logger* logger, size_t report_every)
+                : logger_(logger), report_every_(report_every) {}
+
+            ~TickToTradeCollector() {
+                if(total_.count())
+                    report();
+            }
+
+            // Requests without a complete set of stamps were not triggered by market data and are ignored
+            auto record(const OMClientRequest& request, Nanos rx_time) noexcept {
+                if(LIKELY(!request.md_publish_time_ || !request.md_recv_time_ || !request.send_time_))
+                    return;
+                if(!rx_time)
+                    rx_time = Common::getCurrentNanos();
+
+                feed_.record(request.md_recv_time_ - request.md_publish_time_);
+                reaction_.record(request.send_time_ - request.md_recv_time_);
+                order_entry_.record(rx_time - request.send_time_);
+                total_.record(rx_time - request.md_publish_time_);
+
+                if(UNLIKELY(report_every_ && total_.count() % report_every_ == 0))
+                    report();
+            }
+
+            // deleted copy & move constructors and assignment-operators
+            TickToTradeCollector() = delete;
+            TickToTradeCollector(const TickToTradeCollector&) = delete;
+            TickToTradeCollector(const TickToTradeCollector&&) = delete;
+            TickToTradeCollector &operator=(const TickToTradeCollector&) = delete;
+            TickToTradeCollector &operator=(const TickToTradeCollector&&) = delete;
+
+        private:
+            Logger* logger_ = nullptr;
+            const size_t report_every_;
+            std::string time_str_;
+
+            // publish -> client receive, client receive -> client send, client send -> order server receive, and publish -> order server receive
+            Common::LatencyHistogram feed_, reaction_, order_entry_, total_;
+
+            auto report() noexcept -> void {
+                logger_->log("%:% %() % TickToTrade feed_ns:% reaction_ns:% order_entry_ns:% total_ns:%\n", __FILE__, __LINE__, __FUNCTION__,
+                            Common::getCurrentTimeStr(&time_str_), feed_.toString(), reaction_.toString(), order_entry_.toString(), total_.toString());
+            }
+    };
+} // namespace Exchange
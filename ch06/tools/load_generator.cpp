@@ -0,0 +1,248 @@
+#include "load_generator.h"
+
+namespace Tools
+{
+    LoadGenerator::LoadGenerator(const LoadGeneratorCfg& cfg)
+    : cfg_(cfg), logger_("tools_load_generator.log"), sessions_(cfg.num_sessions_), rng_(cfg.seed_) {
+        ASSERT(cfg_.num_sessions_ > 0 && cfg_.first_client_id_ + cfg_.num_sessions_ <= ME_MAX_NUM_CLIENTS,
+            "Sessions must map to ClientIds below ME_MAX_NUM_CLIENTS:" + std::to_string(ME_MAX_NUM_CLIENTS));
+        ASSERT(cfg_.num_tickers_ > 0 && cfg_.num_tickers_ <= ME_MAX_TICKERS, "Invalid number of tickers:" + std::to_string(cfg_.num_tickers_));
+        ASSERT(cfg_.add_pct_ + cfg_.cancel_pct_ <= 100, "Order mix add% + cancel% must not exceed 100.");
+        ASSERT(cfg_.ref_price_ > cfg_.max_passive_ticks_ + cfg_.max_aggressive_ticks_, "Reference price too low for the configured tick ranges.");
+        ASSERT(cfg_.max_passive_ticks_ + cfg_.max_aggressive_ticks_ < ME_MAX_PRICE_LEVELS / 2, "Price range must fit in ME_MAX_PRICE_LEVELS.");
+
+        num_sent_.fill(0);
+
+        for(size_t i = 0; i < sessions_.size(); ++i) {
+            auto& session = sessions_[i];
+            session.client_id_ = cfg_.first_client_id_ + i;
+            session.order_send_time_.resize(ME_MAX_ORDER_IDS, 0);
+            session.order_request_type_.resize(ME_MAX_ORDER_IDS, LoadRequestType::ADD);
+            session.live_orders_.resize(cfg_.num_tickers_);
+            for(auto& live_orders: session.live_orders_)
+                live_orders.reserve(ME_MAX_ORDER_IDS / cfg_.num_tickers_);
+
+            session.socket_ = new Common::TCPSocket(logger_);
+            session.socket_->recv_callback_ = [this, &session](auto socket, auto rx_time) { recvCallback(&session, socket, rx_time); };
+        }
+    }
+
+    LoadGenerator::~LoadGenerator() {
+        for(auto& session: sessions_) {
+            if(session.socket_->socket_fd_ >= 0)
+                close(session.socket_->socket_fd_);
+            delete session.socket_;
+            session.socket_ = nullptr;
+        }
+    }
+
+    auto LoadGenerator::connect() -> void {
+        for(auto& session: sessions_) {
+            ASSERT(session.socket_->connect(cfg_.ip_, cfg_.iface_, cfg_.port_, false) >= 0,
+                "Unable to connect to ip:" + cfg_.ip_ + " port:" + std::to_string(cfg_.port_) + " on iface:" + cfg_.iface_ + " error:" + std::string(std::strerror(errno)));
+            logger_.log("%:% %() % Connected session client:% socket:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                session.client_id_, session.socket_->socket_fd_);
+        }
+
+        // The sockets connect asynchronously, give the handshakes time to complete before sending anything
+        using namespace std::literals::chrono_literals;
+        std::this_thread::sleep_for(1s);
+    }
+
+    auto LoadGenerator::nextInterArrival() noexcept -> Nanos {
+        const auto mean_gap = NANOS_TO_SECS / cfg_.orders_per_sec_ *
+                                (cfg_.arrival_profile_ == ArrivalProfile::BURSTY ? cfg_.burst_size_ : 1);
+        std::exponential_distribution<double> gap(1.0 / mean_gap);
+        return static_cast<Nanos>(gap(rng_));
+    }
+
+    auto LoadGenerator::sendRequest(Session* session, LoadRequestType type, const Exchange::MEClientRequest& request) noexcept -> bool {
+        const Exchange::OMClientRequest om_request{session->next_outgoing_seq_num_, request};
+        char buffer[Exchange::OMSBESchema::MAX_LENGTH];
+        if(UNLIKELY(!session->socket_->send(buffer, Exchange::sbeEncode(om_request, buffer)))) {
+            ++num_throttled_;
+            return false;
+        }
+        logger_.log("%:% %() % Sent %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), om_request.toString());
+
+        ++session->next_outgoing_seq_num_;
+        session->order_send_time_[request.order_id_] = Common::getCurrentNanos();
+        session->order_request_type_[request.order_id_] = type;
+
+        ++num_sent_[static_cast<size_t>(type)];
+        ++num_outstanding_;
+
+        return true;
+    }
+
+    auto LoadGenerator::sendNextRequest() noexcept -> void {
+        auto& session = sessions_[rng_() % sessions_.size()];
+        // The exchange is not draining this session fast enough, skip this arrival rather than overflow its outbound ring
+        if(UNLIKELY(!session.socket_->reserveSend(Exchange::OMSBESchema::MAX_LENGTH))) {
+            ++num_throttled_;
+            return;
+        }
+        const TickerId ticker_id = rng_() % cfg_.num_tickers_;
+        auto& live_orders = session.live_orders_[ticker_id];
+
+        const auto draw = rng_() % 100;
+        auto type = (draw < cfg_.add_pct_ ? LoadRequestType::ADD :
+                    (draw < cfg_.add_pct_ + cfg_.cancel_pct_ ? LoadRequestType::CANCEL : LoadRequestType::AGGRESSIVE));
+        // Only cancel orders which have been acknowledged, so a request never has two outstanding round trips
+        const auto cancel_index = (live_orders.empty() ? 0 : rng_() % live_orders.size());
+        if(type == LoadRequestType::CANCEL && (live_orders.empty() || session.order_send_time_[live_orders[cancel_index]]))
+            type = LoadRequestType::ADD;
+
+        if(type == LoadRequestType::CANCEL) {
+            // Swap-remove the resting order once the cancel is sent, so it is not cancelled twice
+            const auto order_id = live_orders[cancel_index];
+            if(sendRequest(&session, type, {Exchange::ClientRequestType::CANCEL, session.client_id_, ticker_id, order_id,
+                                           Side::INVALID, Price_INVALID, Qty_INVALID})) {
+                live_orders[cancel_index] = live_orders.back();
+                live_orders.pop_back();
+            }
+            return;
+        }
+
+        if(UNLIKELY(session.next_order_id_ >= ME_MAX_ORDER_IDS)) {
+            logger_.log("%:% %() % WARN client:% ran out of OrderIds.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), session.client_id_);
+            return;
+        }
+
+        const auto side = (rng_() & 1 ? Side::BUY : Side::SELL);
+        const auto qty = static_cast<Qty>(1 + rng_() % cfg_.max_qty_);
+        Price price;
+        if(type == LoadRequestType::ADD) { // rest on our side of the reference price
+            const auto ticks = 1 + rng_() % cfg_.max_passive_ticks_;
+            price = (side == Side::BUY ? cfg_.ref_price_ - ticks : cfg_.ref_price_ + ticks);
+        } else { // cross the reference price to take liquidity
+            const auto ticks = rng_() % (cfg_.max_aggressive_ticks_ + 1);
+            price = (side == Side::BUY ? cfg_.ref_price_ + ticks : cfg_.ref_price_ - ticks);
+        }
+
+        const auto order_id = session.next_order_id_;
+        if(sendRequest(&session, type, {Exchange::ClientRequestType::NEW, session.client_id_, ticker_id, order_id, side, price, qty})) {
+            ++session.next_order_id_;
+            live_orders.push_back(order_id);
+        }
+    }
+
+    auto LoadGenerator::pollSessions() noexcept -> void {
+        for(auto& session: sessions_) {
+            session.socket_->sendAndRecv();
+            if(UNLIKELY(session.socket_->disconnected_ && !aborted_)) {
+                logger_.log("%:% %() % ERROR client:% socket:% disconnected, aborting the run.\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getCurrentTimeStr(&time_str_), session.client_id_, session.socket_->socket_fd_);
+                aborted_ = true;
+            }
+        }
+    }
+
+    auto LoadGenerator::recvCallback(Session* session, Common::TCPSocket* socket, Nanos rx_time) noexcept -> void {
+        logger_.log("%:% %() % Received socket:% len:% rx:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            socket->socket_fd_, socket->inbound_data_.readable(), rx_time);
+
+        // Messages are decoded in place, a trailing partial message stays in the buffer until the rest of it is received
+        auto& inbound_data = socket->inbound_data_;
+        for(; inbound_data.readable() >= sizeof(Exchange::OMClientResponse); inbound_data.consume(sizeof(Exchange::OMClientResponse))) {
+            auto response = reinterpret_cast<const Exchange::OMClientResponse*>(inbound_data.readPtr());
+            logger_.log("%:% %() % Received %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), response->toString());
+
+            if(response->seq_num_ != session->next_exp_seq_num_) {
+                logger_.log("%:% %() % ERROR Incorrect sequence number. ClientId:% SeqNum expected:% received:%.\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getCurrentTimeStr(&time_str_), session->client_id_, session->next_exp_seq_num_, response->seq_num_);
+                ++num_seq_errors_;
+                session->next_exp_seq_num_ = response->seq_num_;
+            }
+            ++session->next_exp_seq_num_;
+
+            onResponse(session, response->me_client_response_);
+        }
+    }
+
+    auto LoadGenerator::onResponse(Session* session, const Exchange::MEClientResponse& response) noexcept -> void {
+        ++num_responses_;
+
+        const auto order_id = response.client_order_id_;
+        if(UNLIKELY(response.client_id_ != session->client_id_ || order_id >= ME_MAX_ORDER_IDS))
+            return;
+
+        auto& send_time = session->order_send_time_[order_id];
+        if(!send_time)
+            return;
+
+        // Only the first response to a request closes its round trip, fills on a resting order are not request driven
+        const auto type = session->order_request_type_[order_id];
+        const auto closes_request = (type == LoadRequestType::CANCEL ?
+                                    (response.type_ == Exchange::ClientResponseType::CANCELED || response.type_ == Exchange::ClientResponseType::CANCEL_REJECTED) :
+                                    response.type_ == Exchange::ClientResponseType::ACCEPTED);
+        if(!closes_request)
+            return;
+
+        latencies_[static_cast<size_t>(type)].record(Common::getCurrentNanos() - send_time);
+        send_time = 0;
+        --num_outstanding_;
+    }
+
+    auto LoadGenerator::run() -> void {
+        logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), cfg_.toString());
+        connect();
+
+        load_start_time_ = Common::getCurrentNanos();
+        const auto load_end_time = load_start_time_ + static_cast<Nanos>(cfg_.duration_secs_) * NANOS_TO_SECS;
+        const auto orders_per_arrival = (cfg_.arrival_profile_ == ArrivalProfile::BURSTY ? cfg_.burst_size_ : 1);
+
+        // Open loop generation, arrivals are scheduled independently of responses so a slow exchange cannot throttle the offered load
+        auto next_arrival_time = load_start_time_;
+        for(auto now = load_start_time_; now < load_end_time && !aborted_; now = Common::getCurrentNanos()) {
+            while(next_arrival_time <= now) {
+                for(size_t i = 0; i < orders_per_arrival; ++i)
+                    sendNextRequest();
+                next_arrival_time += nextInterArrival();
+            }
+            pollSessions();
+        }
+        load_end_time_ = Common::getCurrentNanos();
+
+        // Drain outstanding responses, giving up after a grace period or once a session is gone
+        const auto drain_end_time = load_end_time_ + 5 * NANOS_TO_SECS;
+        while(num_outstanding_ && !aborted_ && Common::getCurrentNanos() < drain_end_time)
+            pollSessions();
+
+        logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), report());
+    }
+
+    auto LoadGenerator::report() const -> std::string {
+        std::stringstream ss;
+        const auto elapsed_secs = static_cast<double>(load_end_time_ - load_start_time_) / NANOS_TO_SECS;
+
+        size_t total_sent = 0;
+        Common::LatencyHistogram total_latencies;
+        for(size_t i = 0; i < latencies_.size(); ++i) {
+            total_sent += num_sent_[i];
+            total_latencies.merge(latencies_[i]);
+        }
+
+        ss << cfg_.toString() << std::endl
+           << (aborted_ ? "ABORTED, a session was disconnected. " : "")
+           << "elapsed:" << elapsed_secs << "s"
+           << " sent:" << total_sent
+           << " sent/s:" << (elapsed_secs > 0 ? total_sent / elapsed_secs : 0)
+           << " responses:" << num_responses_
+           << " responses/s:" << (elapsed_secs > 0 ? num_responses_ / elapsed_secs : 0)
+           << " unanswered:" << num_outstanding_
+           << " seq_errors:" << num_seq_errors_
+           << " throttled:" << num_throttled_ << std::endl;
+
+        for(size_t i = 0; i < latencies_.size(); ++i) {
+            ss << loadRequestTypeToString(static_cast<LoadRequestType>(i))
+               << " sent:" << num_sent_[i]
+               << " rtt_ns:" << latencies_[i].toString() << std::endl;
+        }
+        ss << "ALL rtt_ns:" << total_latencies.toString() << std::endl;
+        for(const auto& session: sessions_)
+            ss << "client:" << session.client_id_ << " " << session.socket_->send_stats_.toString() << std::endl;
+
+        return ss.str();
+    }
+} // namespace Tools
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <random>
+#include <vector>
+
+#include "common/types.h"
+#include "common/macros.h"
+#include "common/logging.h"
+#include "common/tcp_socket.h"
+#include "common/latency_histogram.h"
+
+#include "exchange/order_server/client_request.h"
+#include "exchange/order_server/om_sbe.h"
+#include "exchange/order_server/client_response.h"
+
+namespace Tools
+{
+    enum class ArrivalProfile : uint8_t {
+        POISSON = 0,
+        BURSTY = 1
+    };
+
+    inline std::string arrivalProfileToString(ArrivalProfile profile) {
+        switch (profile)
+        {
+        case ArrivalProfile::POISSON:
+            return "POISSON";
+        case ArrivalProfile::BURSTY:
+            return "BURSTY";
+        default:
+            return "UNKNOWN";
+        }
+    }
+
+    // Kind of order flow generated, also used to bucket round-trip latencies
+    enum class LoadRequestType : uint8_t {
+        ADD = 0,
+        CANCEL = 1,
+        AGGRESSIVE = 2,
+        MAX = 3
+    };
+
+    inline std::string loadRequestTypeToString(LoadRequestType type) {
+        switch (type)
+        {
+        case LoadRequestType::ADD:
+            return "ADD";
+        case LoadRequestType::CANCEL:
+            return "CANCEL";
+        case LoadRequestType::AGGRESSIVE:
+            return "AGGRESSIVE";
+        default:
+            return "UNKNOWN";
+        }
+    }
+
+    struct LoadGeneratorCfg {
+        std::string ip_ = "127.0.0.1";
+        std::string iface_ = "lo";
+        int port_ = 12345;
+
+        size_t num_sessions_ = 4;
+        ClientId first_client_id_ = 1;
+        size_t num_tickers_ = ME_MAX_TICKERS;
+
+        // Aggregate order rate across all sessions and how long to generate load for
+        double orders_per_sec_ = 10000;
+        size_t duration_secs_ = 10;
+
+        ArrivalProfile arrival_profile_ = ArrivalProfile::POISSON;
+        // Number of back to back orders sent on every arrival when the profile is BURSTY
+        size_t burst_size_ = 100;
+
+        // Order mix in percent, whatever is left after add and cancel is sent as aggressive orders
+        size_t add_pct_ = 60;
+        size_t cancel_pct_ = 30;
+
+        // Prices are drawn around a fixed reference price per ticker, passive orders rest up to max_passive_ticks_ away from it
+        // and aggressive orders cross it by up to max_aggressive_ticks_
+        Price ref_price_ = 100;
+        Price max_passive_ticks_ = 20;
+        Price max_aggressive_ticks_ = 5;
+        Qty max_qty_ = 100;
+
+        uint64_t seed_ = 1;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "LoadGeneratorCfg[ip:" << ip_
+               << " iface:" << iface_
+               << " port:" << port_
+               << " sessions:" << num_sessions_
+               << " first_client_id:" << first_client_id_
+               << " tickers:" << num_tickers_
+               << " rate:" << orders_per_sec_
+               << " duration:" << duration_secs_
+               << " profile:" << arrivalProfileToString(arrival_profile_)
+               << " burst:" << burst_size_
+               << " add%:" << add_pct_
+               << " cancel%:" << cancel_pct_
+               << " ref_price:" << ref_price_
+               << " passive_ticks:" << max_passive_ticks_
+               << " aggressive_ticks:" << max_aggressive_ticks_
+               << " max_qty:" << max_qty_
+               << " seed:" << seed_
+               << "]";
+            return ss.str();
+        }
+    };
+
+    // Opens many order entry sessions to the OrderServer from a single thread, generates a configurable mix of order flow
+    // and measures the round trip time from sending each request to receiving the first response for it.
+    class LoadGenerator final {
+        public:
+            explicit LoadGenerator(const LoadGeneratorCfg& cfg);
+            ~LoadGenerator();
+
+            // Connect all sessions, generate load for the configured duration, then wait for outstanding responses
+            auto run() -> void;
+
+            // Throughput and latency summary of the last run
+            auto report() const -> std::string;
+
+            // True if the last run stopped early because a session was disconnected
+            auto aborted() const noexcept { return aborted_; }
+
+            // deleted default, copy & move constructors and assignment-operators
+            LoadGenerator() = delete;
+            LoadGenerator(const LoadGenerator&) = delete;
+            LoadGenerator(const LoadGenerator&&) = delete;
+            LoadGenerator &operator=(const LoadGenerator&) = delete;
+            LoadGenerator &operator=(const LoadGenerator&&) = delete;
+
+        private:
+            // A single order entry connection, owns the sequence numbers and the outstanding orders of one ClientId
+            struct Session {
+                ClientId client_id_ = ClientId_INVALID;
+                Common::TCPSocket* socket_ = nullptr;
+
+                size_t next_outgoing_seq_num_ = 1;
+                size_t next_exp_seq_num_ = 1;
+                OrderId next_order_id_ = 1;
+
+                // Send time and type of the request outstanding on each OrderId, 0 once its first response has been seen
+                std::vector<Nanos> order_send_time_;
+                std::vector<LoadRequestType> order_request_type_;
+
+                // Resting orders per ticker which are candidates to be cancelled
+                std::vector<std::vector<OrderId>> live_orders_;
+            };
+
+            const LoadGeneratorCfg cfg_;
+            std::string time_str_;
+            Common::Logger logger_;
+
+            std::vector<Session> sessions_;
+            std::mt19937_64 rng_;
+
+            std::array<Common::LatencyHistogram, static_cast<size_t>(LoadRequestType::MAX)> latencies_;
+            std::array<size_t, static_cast<size_t>(LoadRequestType::MAX)> num_sent_;
+            size_t num_responses_ = 0;
+            size_t num_seq_errors_ = 0;
+            size_t num_outstanding_ = 0;
+            // Arrivals skipped because the session's outbound ring had no room, i.e. backpressure from the exchange
+            size_t num_throttled_ = 0;
+            // A session was disconnected by the exchange, nothing it sent after that can be answered so the run stops
+            bool aborted_ = false;
+            Nanos load_start_time_ = 0;
+            Nanos load_end_time_ = 0;
+
+            auto connect() -> void;
+
+            // Time to wait until the next arrival for the configured profile
+            auto nextInterArrival() noexcept -> Nanos;
+
+            // Pick a session and ticker at random and send an order of a type drawn from the configured mix
+            auto sendNextRequest() noexcept -> void;
+            // False if the session's outbound ring rejected the request, which is then neither sequenced nor counted
+            auto sendRequest(Session* session, LoadRequestType type, const Exchange::MEClientRequest& request) noexcept -> bool;
+
+            // Publish pending requests and read responses on every session, aborts the run once a session is disconnected
+            auto pollSessions() noexcept -> void;
+
+            auto recvCallback(Session* session, Common::TCPSocket* socket, Nanos rx_time) noexcept -> void;
+            auto onResponse(Session* session, const Exchange::MEClientResponse& response) noexcept -> void;
+    };
+} // namespace Tools
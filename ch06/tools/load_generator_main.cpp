@@ -0,0 +1,74 @@
+#include <getopt.h>
+
+#include "tools/load_generator.h"
+
+namespace {
+    auto usage(const char* name) {
+        std::cerr << "USAGE " << name << " [--ip IP] [--iface IFACE] [--port PORT] [--sessions N] [--first-client-id ID] [--tickers N]"
+                  << " [--rate ORDERS_PER_SEC] [--duration SECS] [--profile poisson|bursty] [--burst N]"
+                  << " [--add-pct PCT] [--cancel-pct PCT] [--ref-price PX] [--passive-ticks N] [--aggressive-ticks N] [--max-qty N] [--seed N]" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+int main(int argc, char** argv) {
+    Tools::LoadGeneratorCfg cfg;
+
+    const option long_options[] = {
+        {"ip", required_argument, nullptr, 'i'},
+        {"iface", required_argument, nullptr, 'f'},
+        {"port", required_argument, nullptr, 'p'},
+        {"sessions", required_argument, nullptr, 's'},
+        {"first-client-id", required_argument, nullptr, 'c'},
+        {"tickers", required_argument, nullptr, 't'},
+        {"rate", required_argument, nullptr, 'r'},
+        {"duration", required_argument, nullptr, 'd'},
+        {"profile", required_argument, nullptr, 'P'},
+        {"burst", required_argument, nullptr, 'b'},
+        {"add-pct", required_argument, nullptr, 'a'},
+        {"cancel-pct", required_argument, nullptr, 'x'},
+        {"ref-price", required_argument, nullptr, 'R'},
+        {"passive-ticks", required_argument, nullptr, 'T'},
+        {"aggressive-ticks", required_argument, nullptr, 'A'},
+        {"max-qty", required_argument, nullptr, 'q'},
+        {"seed", required_argument, nullptr, 'S'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    for(int opt; (opt = getopt_long(argc, argv, "", long_options, nullptr)) != -1;) {
+        switch (opt)
+        {
+        case 'i': cfg.ip_ = optarg; break;
+        case 'f': cfg.iface_ = optarg; break;
+        case 'p': cfg.port_ = atoi(optarg); break;
+        case 's': cfg.num_sessions_ = strtoul(optarg, nullptr, 10); break;
+        case 'c': cfg.first_client_id_ = strtoul(optarg, nullptr, 10); break;
+        case 't': cfg.num_tickers_ = strtoul(optarg, nullptr, 10); break;
+        case 'r': cfg.orders_per_sec_ = atof(optarg); break;
+        case 'd': cfg.duration_secs_ = strtoul(optarg, nullptr, 10); break;
+        case 'P':
+            if(std::string(optarg) == "poisson")
+                cfg.arrival_profile_ = Tools::ArrivalProfile::POISSON;
+            else if(std::string(optarg) == "bursty")
+                cfg.arrival_profile_ = Tools::ArrivalProfile::BURSTY;
+            else
+                usage(argv[0]);
+            break;
+        case 'b': cfg.burst_size_ = strtoul(optarg, nullptr, 10); break;
+        case 'a': cfg.add_pct_ = strtoul(optarg, nullptr, 10); break;
+        case 'x': cfg.cancel_pct_ = strtoul(optarg, nullptr, 10); break;
+        case 'R': cfg.ref_price_ = strtoull(optarg, nullptr, 10); break;
+        case 'T': cfg.max_passive_ticks_ = strtoull(optarg, nullptr, 10); break;
+        case 'A': cfg.max_aggressive_ticks_ = strtoull(optarg, nullptr, 10); break;
+        case 'q': cfg.max_qty_ = strtoul(optarg, nullptr, 10); break;
+        case 'S': cfg.seed_ = strtoull(optarg, nullptr, 10); break;
+        default: usage(argv[0]);
+        }
+    }
+
+    Tools::LoadGenerator load_generator(cfg);
+    load_generator.run();
+    std::cout << load_generator.report();
+
+    return load_generator.aborted() ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,53 @@
+#include "md_capture.h"
+
+namespace Tools
+{
+    MDCapture::MDCapture(const MDCaptureCfg& cfg)
+    : cfg_(cfg), logger_("tools_md_capture.log"), writer_(cfg_.path_, cfg_.max_mb_ * 1024 * 1024) {
+        for(const auto& group_str: cfg_.groups_) {
+            const auto colon = group_str.find(':');
+            ASSERT(colon != std::string::npos, "Group " + group_str + " is not ip:port.");
+            const auto ip = group_str.substr(0, colon);
+            const auto port = atoi(group_str.c_str() + colon + 1);
+
+            auto group = new Group{Common::McastSocket(logger_), inet_addr(ip.c_str()), htons(static_cast<uint16_t>(port))};
+            ASSERT(group->socket_.init(ip, cfg_.iface_, port, /* is_listening */ true) >= 0,
+                "Unable to create mcast socket for " + group_str + ". error:" + std::string(std::strerror(errno)));
+            ASSERT(group->socket_.join(ip), "Join failed on " + group_str + ". error:" + std::string(std::strerror(errno)));
+            group->socket_.recv_callback_ = [this, group](auto socket) {
+                auto& inbound_data = socket->inbound_data_;
+                writer_.write(Common::getCurrentNanos(), group->addr_, group->port_, inbound_data.readPtr(), inbound_data.readable());
+                inbound_data.clear();
+            };
+            groups_.push_back(group);
+        }
+    }
+
+    MDCapture::~MDCapture() {
+        for(auto group: groups_)
+            delete group;
+        groups_.clear();
+    }
+
+    auto MDCapture::run() -> void {
+        logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), cfg_.toString());
+
+        const auto end_time = Common::getCurrentNanos() + static_cast<Common::Nanos>(cfg_.duration_secs_) * Common::NANOS_TO_SECS;
+        while(Common::getCurrentNanos() < end_time) {
+            for(auto group: groups_)
+                group->socket_.sendAndRecv();
+        }
+        writer_.close();
+
+        logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), report());
+    }
+
+    auto MDCapture::report() const -> std::string {
+        std::stringstream ss;
+        ss << cfg_.toString() << std::endl
+           << "datagrams:" << writer_.numRecords()
+           << " dropped:" << writer_.numDropped()
+           << " bytes:" << writer_.bytesWritten() << std::endl;
+        return ss.str();
+    }
+} // namespace Tools
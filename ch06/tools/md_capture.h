@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+
+#include "common/types.h"
+#include "common/macros.h"
+#include "common/logging.h"
+#include "common/mcast_socket.h"
+#include "common/capture_file.h"
+
+namespace Tools
+{
+    struct MDCaptureCfg {
+        std::string iface_ = "lo";
+        // ip:port of every group to capture, the snapshot and incremental feeds unless given
+        std::vector<std::string> groups_ = {"233.252.14.1:20000", "233.252.14.3:20001"};
+        std::string path_ = "md_capture.pcap";
+        // Largest capture, allocated up front, datagrams past it are dropped
+        size_t max_mb_ = 1024;
+        size_t duration_secs_ = 30;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "MDCaptureCfg[iface:" << iface_ << " groups:";
+            for(const auto& group: groups_)
+                ss << group << " ";
+            ss << "path:" << path_
+               << " max_mb:" << max_mb_
+               << " duration:" << duration_secs_
+               << "]";
+            return ss.str();
+        }
+    };
+
+    // Records every datagram received on a set of multicast groups, with the time it was read off the socket, to a capture file.
+    // The receive loop only copies into the capture's mapping, so capturing a feed costs it no more than consuming it.
+    class MDCapture final {
+        public:
+            explicit MDCapture(const MDCaptureCfg& cfg);
+            ~MDCapture();
+
+            // Capture for the configured duration
+            auto run() -> void;
+
+            auto report() const -> std::string;
+
+            // deleted default, copy & move constructors and assignment-operators
+            MDCapture() = delete;
+            MDCapture(const MDCapture&) = delete;
+            MDCapture(const MDCapture&&) = delete;
+            MDCapture &operator=(const MDCapture&) = delete;
+            MDCapture &operator=(const MDCapture&&) = delete;
+
+        private:
+            const MDCaptureCfg cfg_;
+            std::string time_str_;
+            Common::Logger logger_;
+            Common::CaptureWriter writer_;
+
+            struct Group {
+                Common::McastSocket socket_;
+                in_addr_t addr_ = 0;
+                in_port_t port_ = 0;
+            };
+            std::vector<Group*> groups_;
+    };
+} // namespace Tools
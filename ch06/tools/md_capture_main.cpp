@@ -0,0 +1,49 @@
+#include <getopt.h>
+
+#include "tools/md_capture.h"
+
+namespace {
+    auto usage(const char* name) {
+        std::cerr << "USAGE " << name << " [--iface IFACE] [--group IP:PORT]... [--out FILE] [--max-mb MB] [--duration SECS]" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Capture the feeds of a running exchange_main for replay with md_replay, e.g.
+//   md_capture --group 233.252.14.1:20000 --group 233.252.14.3:20001 --out open.pcap --duration 60
+int main(int argc, char** argv) {
+    Tools::MDCaptureCfg cfg;
+    bool default_groups = true;
+
+    const option long_options[] = {
+        {"iface", required_argument, nullptr, 'f'},
+        {"group", required_argument, nullptr, 'g'},
+        {"out", required_argument, nullptr, 'o'},
+        {"max-mb", required_argument, nullptr, 'm'},
+        {"duration", required_argument, nullptr, 'd'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    for(int opt; (opt = getopt_long(argc, argv, "", long_options, nullptr)) != -1;) {
+        switch (opt)
+        {
+        case 'f': cfg.iface_ = optarg; break;
+        case 'g':
+            if(default_groups)
+                cfg.groups_.clear();
+            default_groups = false;
+            cfg.groups_.push_back(optarg);
+            break;
+        case 'o': cfg.path_ = optarg; break;
+        case 'm': cfg.max_mb_ = strtoul(optarg, nullptr, 10); break;
+        case 'd': cfg.duration_secs_ = strtoul(optarg, nullptr, 10); break;
+        default: usage(argv[0]);
+        }
+    }
+
+    Tools::MDCapture md_capture(cfg);
+    md_capture.run();
+    std::cout << md_capture.report();
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "md_replay.h"
+
+namespace Tools
+{
+    MDReplay::MDReplay(const MDReplayCfg& cfg)
+    : cfg_(cfg), logger_("tools_md_replay.log"), reader_(cfg_.path_) {
+        ASSERT(cfg_.speed_ >= 0, "Replay speed must not be negative:" + std::to_string(cfg_.speed_));
+    }
+
+    MDReplay::~MDReplay() {
+        for(auto group: groups_)
+            delete group;
+        groups_.clear();
+    }
+
+    auto MDReplay::group(const Common::CaptureRecord& record) -> Group* {
+        for(auto group: groups_) {
+            if(group->addr_ == record.dst_addr_ && group->port_ == record.dst_port_)
+                return group;
+        }
+
+        char ip[INET_ADDRSTRLEN];
+        const in_addr addr{record.dst_addr_};
+        inet_ntop(AF_INET, &addr, ip, sizeof(ip));
+        auto group = new Group{Common::McastSocket(logger_), record.dst_addr_, record.dst_port_, 0};
+        ASSERT(group->socket_.init(ip, cfg_.iface_, ntohs(record.dst_port_), /* is_listening */ false) >= 0,
+            "Unable to create mcast socket for " + std::string(ip) + ":" + std::to_string(ntohs(record.dst_port_)) + ". error:" + std::string(std::strerror(errno)));
+        logger_.log("%:% %() % Publishing %:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), ip, ntohs(record.dst_port_));
+        groups_.push_back(group);
+        return group;
+    }
+
+    auto MDReplay::flush(Group* group) noexcept -> void {
+        if(group && group->pending_) {
+            group->socket_.sendAndRecv();
+            group->pending_ = 0;
+        }
+    }
+
+    auto MDReplay::run() -> void {
+        logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), cfg_.toString());
+
+        const auto start_time = Common::getCurrentNanos();
+        Common::CaptureRecord record;
+        for(size_t loop = 0; loop < cfg_.loops_; ++loop) {
+            reader_.rewind();
+            const auto loop_start_time = Common::getCurrentNanos();
+            Common::Nanos first_record_time = 0;
+            Group* last_group = nullptr;
+
+            for(bool first = true; reader_.next(&record); first = false) {
+                if(first)
+                    first_record_time = record.time_;
+                auto group = this->group(record);
+
+                if(cfg_.speed_ > 0) {
+                    const auto due_time = loop_start_time + static_cast<Common::Nanos>(static_cast<double>(record.time_ - first_record_time) / cfg_.speed_);
+                    auto now = Common::getCurrentNanos();
+                    while(now < due_time)
+                        now = Common::getCurrentNanos();
+                    max_lateness_ = std::max(max_lateness_, now - due_time);
+                } else if(group != last_group) { // keep datagrams in capture order across groups
+                    flush(last_group);
+                }
+
+                group->socket_.send(record.payload_, record.len_);
+                group->socket_.endPacket();
+                ++group->pending_;
+                ++num_datagrams_;
+                num_bytes_ += record.len_;
+                // Paced datagrams go out as they fall due, unpaced ones a sendmmsg() batch at a time
+                if(cfg_.speed_ > 0 || group->pending_ == Common::McastBatchSize)
+                    flush(group);
+                last_group = group;
+            }
+            flush(last_group);
+        }
+        elapsed_ = Common::getCurrentNanos() - start_time;
+
+        logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), report());
+    }
+
+    auto MDReplay::report() const -> std::string {
+        std::stringstream ss;
+        ss << cfg_.toString() << std::endl
+           << "datagrams:" << num_datagrams_
+           << " bytes:" << num_bytes_
+           << " skipped_records:" << reader_.numSkipped()
+           << " groups:" << groups_.size()
+           << " elapsed:" << static_cast<double>(elapsed_) / Common::NANOS_TO_SECS << "s"
+           << " datagrams/s:" << (elapsed_ ? static_cast<double>(num_datagrams_) * Common::NANOS_TO_SECS / elapsed_ : 0)
+           << " max_lateness_ns:" << max_lateness_ << std::endl;
+        return ss.str();
+    }
+} // namespace Tools
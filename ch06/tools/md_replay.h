@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+
+#include "common/types.h"
+#include "common/macros.h"
+#include "common/logging.h"
+#include "common/mcast_socket.h"
+#include "common/capture_file.h"
+
+namespace Tools
+{
+    struct MDReplayCfg {
+        std::string iface_ = "lo";
+        std::string path_ = "md_capture.pcap";
+        // Multiple of the captured rate to replay at, 0 replays as fast as the sockets take the datagrams
+        double speed_ = 1.0;
+        size_t loops_ = 1;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "MDReplayCfg[iface:" << iface_
+               << " path:" << path_
+               << " speed:" << speed_
+               << " loops:" << loops_
+               << "]";
+            return ss.str();
+        }
+    };
+
+    // Republishes the datagrams of a capture file on the groups they were captured from, spaced as they were received divided by
+    // the speed, so bursts recorded in production reproduce against MarketDataConsumer and MarketOrderBook on a single box.
+    class MDReplay final {
+        public:
+            explicit MDReplay(const MDReplayCfg& cfg);
+            ~MDReplay();
+
+            // Replay the capture the configured number of times
+            auto run() -> void;
+
+            auto report() const -> std::string;
+
+            // deleted default, copy & move constructors and assignment-operators
+            MDReplay() = delete;
+            MDReplay(const MDReplay&) = delete;
+            MDReplay(const MDReplay&&) = delete;
+            MDReplay &operator=(const MDReplay&) = delete;
+            MDReplay &operator=(const MDReplay&&) = delete;
+
+        private:
+            const MDReplayCfg cfg_;
+            std::string time_str_;
+            Common::Logger logger_;
+            Common::CaptureReader reader_;
+
+            struct Group {
+                Common::McastSocket socket_;
+                in_addr_t addr_ = 0;
+                in_port_t port_ = 0;
+                size_t pending_ = 0;
+            };
+            std::vector<Group*> groups_;
+
+            size_t num_datagrams_ = 0;
+            size_t num_bytes_ = 0;
+            Common::Nanos elapsed_ = 0;
+            // Worst time a paced datagram went out after it was due
+            Common::Nanos max_lateness_ = 0;
+
+            // Publisher for the group of record, created the first time the group is seen
+            auto group(const Common::CaptureRecord& record) -> Group*;
+            auto flush(Group* group) noexcept -> void;
+    };
+} // namespace Tools
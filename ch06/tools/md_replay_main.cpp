@@ -0,0 +1,43 @@
+#include <getopt.h>
+
+#include "tools/md_replay.h"
+
+namespace {
+    auto usage(const char* name) {
+        std::cerr << "USAGE " << name << " [--iface IFACE] [--in FILE] [--speed MULTIPLE] [--max-speed] [--loops N]" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Replay a capture from md_capture, or tcpdump, in place of exchange_main, e.g.
+//   tick_to_trade --duration 30 & md_replay --in open.pcap --speed 10
+int main(int argc, char** argv) {
+    Tools::MDReplayCfg cfg;
+
+    const option long_options[] = {
+        {"iface", required_argument, nullptr, 'f'},
+        {"in", required_argument, nullptr, 'i'},
+        {"speed", required_argument, nullptr, 's'},
+        {"max-speed", no_argument, nullptr, 'm'},
+        {"loops", required_argument, nullptr, 'l'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    for(int opt; (opt = getopt_long(argc, argv, "", long_options, nullptr)) != -1;) {
+        switch (opt)
+        {
+        case 'f': cfg.iface_ = optarg; break;
+        case 'i': cfg.path_ = optarg; break;
+        case 's': cfg.speed_ = atof(optarg); break;
+        case 'm': cfg.speed_ = 0; break;
+        case 'l': cfg.loops_ = strtoul(optarg, nullptr, 10); break;
+        default: usage(argv[0]);
+        }
+    }
+
+    Tools::MDReplay md_replay(cfg);
+    md_replay.run();
+    std::cout << md_replay.report();
+
+    return 0;
+}
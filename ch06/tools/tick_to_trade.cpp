@@ -0,0 +1,71 @@
+#include "tick_to_trade.h"
+
+namespace Tools
+{
+    TickToTrade::TickToTrade(const TickToTradeCfg& cfg)
+    : cfg_(cfg), logger_("tools_tick_to_trade.log"),
+    market_updates_(ME_MAX_MARKET_UPDATES), client_requests_(ME_MAX_CLIENT_UPDATES), client_responses_(ME_MAX_CLIENT_UPDATES) {
+        ASSERT(cfg_.client_id_ < ME_MAX_NUM_CLIENTS, "ClientId must be below ME_MAX_NUM_CLIENTS:" + std::to_string(ME_MAX_NUM_CLIENTS));
+    }
+
+    TickToTrade::~TickToTrade() {
+        delete market_data_consumer_; market_data_consumer_ = nullptr;
+        delete order_gateway_; order_gateway_ = nullptr;
+    }
+
+    auto TickToTrade::onMarketUpdate(const Exchange::MDCMarketUpdate& md_update) noexcept -> void {
+        ++num_market_updates_;
+
+        // Snapshot and recovered updates are not stamped, and only updates for a real ticker can be answered with an order request
+        const auto& market_update = md_update.me_market_update_;
+        if(!md_update.publish_time_ || !md_update.recv_time_ || market_update.ticker_id_ >= ME_MAX_TICKERS)
+            return;
+        feed_latencies_.record(md_update.recv_time_ - md_update.publish_time_);
+
+        if(cfg_.trades_only_ && market_update.type_ != Exchange::MarketUpdateType::TRADE)
+            return;
+
+        auto next_write = client_requests_.getNextToWriteTo();
+        *next_write = {{Exchange::ClientRequestType::CANCEL, cfg_.client_id_, market_update.ticker_id_, PROBE_ORDER_ID,
+                        Side::INVALID, Price_INVALID, Qty_INVALID}, md_update.publish_time_, md_update.recv_time_};
+        client_requests_.updateWriteIndex();
+        ++num_probes_;
+    }
+
+    auto TickToTrade::run() -> void {
+        logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), cfg_.toString());
+
+        order_gateway_ = new Trading::OrderGateway(cfg_.client_id_, &client_requests_, &client_responses_, cfg_.ip_, cfg_.iface_, cfg_.port_,
+                                                    cfg_.tcp_backend_);
+        order_gateway_->start();
+        market_data_consumer_ = new Trading::MarketDataConsumer(cfg_.client_id_, &market_updates_, cfg_.iface_,
+                                                                cfg_.snapshot_ip_, cfg_.snapshot_port_, cfg_.incremental_ip_, cfg_.incremental_port_,
+                                                                cfg_.incremental_b_ip_, cfg_.incremental_b_port_, cfg_.retransmit_ip_, cfg_.retransmit_port_);
+        market_data_consumer_->start();
+
+        const auto end_time = Common::getCurrentNanos() + static_cast<Nanos>(cfg_.duration_secs_) * NANOS_TO_SECS;
+        while(Common::getCurrentNanos() < end_time) {
+            for(auto market_update = market_updates_.getNextToRead(); market_update; market_update = market_updates_.getNextToRead()) {
+                onMarketUpdate(*market_update);
+                market_updates_.updateReadIndex();
+            }
+            for(auto client_response = client_responses_.getNextToRead(); client_response; client_response = client_responses_.getNextToRead()) {
+                ++num_responses_;
+                client_responses_.updateReadIndex();
+            }
+        }
+
+        logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), report());
+    }
+
+    auto TickToTrade::report() const -> std::string {
+        std::stringstream ss;
+        ss << cfg_.toString() << std::endl
+           << "market_updates:" << num_market_updates_
+           << " probes:" << num_probes_
+           << " responses:" << num_responses_ << std::endl
+           << "feed_ns:" << feed_latencies_.toString() << std::endl
+           << "Tick-to-trade histograms are logged by the exchange OrderServer in exchange_order_server.log" << std::endl;
+        return ss.str();
+    }
+} // namespace Tools
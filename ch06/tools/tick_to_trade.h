@@ -0,0 +1,101 @@
+#pragma once
+
+#include "common/types.h"
+#include "common/macros.h"
+#include "common/logging.h"
+#include "common/latency_histogram.h"
+
+#include "exchange/market_data/market_update.h"
+#include "exchange/order_server/client_request.h"
+#include "exchange/order_server/client_response.h"
+
+#include "trading/market_data/market_data_consumer.h"
+#include "trading/order_gw/order_gateway.h"
+
+namespace Tools
+{
+    struct TickToTradeCfg {
+        std::string iface_ = "lo";
+        std::string snapshot_ip_ = "233.252.14.1";
+        int snapshot_port_ = 20000;
+        std::string incremental_ip_ = "233.252.14.3";
+        int incremental_port_ = 20001;
+        // B feed to arbitrate against, unused while the ip is empty
+        std::string incremental_b_ip_;
+        int incremental_b_port_ = 20002;
+        // Gap fill service of the exchange, port 0 recovers every gap from a snapshot
+        std::string retransmit_ip_ = "127.0.0.1";
+        int retransmit_port_ = 12346;
+        std::string ip_ = "127.0.0.1";
+        int port_ = 12345;
+
+        ClientId client_id_ = 200;
+        size_t duration_secs_ = 30;
+        // React to trades only instead of to every incremental update
+        bool trades_only_ = false;
+        Common::TCPBackend tcp_backend_ = Common::TCPBackend::EPOLL;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "TickToTradeCfg[iface:" << iface_
+               << " snapshot:" << snapshot_ip_ << ":" << snapshot_port_
+               << " incremental:" << incremental_ip_ << ":" << incremental_port_
+               << " incremental_b:" << incremental_b_ip_ << ":" << incremental_b_port_
+               << " retransmit:" << retransmit_ip_ << ":" << retransmit_port_
+               << " order_server:" << ip_ << ":" << port_
+               << " client_id:" << client_id_
+               << " duration:" << duration_secs_
+               << " trades_only:" << trades_only_
+               << " tcp_backend:" << Common::tcpBackendToString(tcp_backend_)
+               << "]";
+            return ss.str();
+        }
+    };
+
+    // Minimal trading client which answers every market update from the exchange with an order request, so the exchange side
+    // TickToTradeCollector can measure publish -> client -> order server latency end to end. Only stamped updates are answered, so the exchange
+    // has to run with --md-stamps.
+    // The reaction is a cancel of an OrderId this client never uses, which the exchange rejects without touching the book or
+    // publishing market data, so probes never generate more market data to react to.
+    class TickToTrade final {
+        public:
+            explicit TickToTrade(const TickToTradeCfg& cfg);
+            ~TickToTrade();
+
+            // Consume market data and send probes for the configured duration
+            auto run() -> void;
+
+            // Probe counts and the client side feed latency histogram of the last run
+            auto report() const -> std::string;
+
+            // deleted default, copy & move constructors and assignment-operators
+            TickToTrade() = delete;
+            TickToTrade(const TickToTrade&) = delete;
+            TickToTrade(const TickToTrade&&) = delete;
+            TickToTrade &operator=(const TickToTrade&) = delete;
+            TickToTrade &operator=(const TickToTrade&&) = delete;
+
+        private:
+            // Never sent as a NEW order by this client, so cancels on it are always rejected
+            static constexpr OrderId PROBE_ORDER_ID = ME_MAX_ORDER_IDS - 1;
+
+            const TickToTradeCfg cfg_;
+            std::string time_str_;
+            Common::Logger logger_;
+
+            Exchange::MDCMarketUpdateLFQueue market_updates_;
+            Exchange::OGWClientRequestLFQueue client_requests_;
+            Exchange::ClientResponseLFQueue client_responses_;
+
+            Trading::MarketDataConsumer* market_data_consumer_ = nullptr;
+            Trading::OrderGateway* order_gateway_ = nullptr;
+
+            // Publish -> MarketDataConsumer receive, as seen by this client
+            Common::LatencyHistogram feed_latencies_;
+            size_t num_market_updates_ = 0;
+            size_t num_probes_ = 0;
+            size_t num_responses_ = 0;
+
+            auto onMarketUpdate(const Exchange::MDCMarketUpdate& md_update) noexcept -> void;
+    };
+} // namespace Tools
@@ -0,0 +1,65 @@
+#include <getopt.h>
+
+#include "tools/tick_to_trade.h"
+
+namespace {
+    auto usage(const char* name) {
+        std::cerr << "USAGE " << name << " [--iface IFACE] [--snapshot-ip IP] [--snapshot-port PORT] [--incremental-ip IP] [--incremental-port PORT]"
+                  << " [--incremental-b-ip IP] [--incremental-b-port PORT] [--retransmit-ip IP] [--retransmit-port PORT]"
+                  << " [--ip IP] [--port PORT] [--client-id ID] [--duration SECS] [--trades-only] [--io-uring]" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Run next to exchange_main and drive market activity with load_generator, e.g.
+//   exchange_main --md-stamps & tick_to_trade --duration 30 & load_generator --duration 20
+int main(int argc, char** argv) {
+    Tools::TickToTradeCfg cfg;
+
+    const option long_options[] = {
+        {"iface", required_argument, nullptr, 'f'},
+        {"snapshot-ip", required_argument, nullptr, 's'},
+        {"snapshot-port", required_argument, nullptr, 'S'},
+        {"incremental-ip", required_argument, nullptr, 'n'},
+        {"incremental-port", required_argument, nullptr, 'N'},
+        {"incremental-b-ip", required_argument, nullptr, 'b'},
+        {"incremental-b-port", required_argument, nullptr, 'B'},
+        {"retransmit-ip", required_argument, nullptr, 'r'},
+        {"retransmit-port", required_argument, nullptr, 'R'},
+        {"ip", required_argument, nullptr, 'i'},
+        {"port", required_argument, nullptr, 'p'},
+        {"client-id", required_argument, nullptr, 'c'},
+        {"duration", required_argument, nullptr, 'd'},
+        {"trades-only", no_argument, nullptr, 't'},
+        {"io-uring", no_argument, nullptr, 'u'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    for(int opt; (opt = getopt_long(argc, argv, "", long_options, nullptr)) != -1;) {
+        switch (opt)
+        {
+        case 'f': cfg.iface_ = optarg; break;
+        case 's': cfg.snapshot_ip_ = optarg; break;
+        case 'S': cfg.snapshot_port_ = atoi(optarg); break;
+        case 'n': cfg.incremental_ip_ = optarg; break;
+        case 'N': cfg.incremental_port_ = atoi(optarg); break;
+        case 'b': cfg.incremental_b_ip_ = optarg; break;
+        case 'B': cfg.incremental_b_port_ = atoi(optarg); break;
+        case 'r': cfg.retransmit_ip_ = optarg; break;
+        case 'R': cfg.retransmit_port_ = atoi(optarg); break;
+        case 'i': cfg.ip_ = optarg; break;
+        case 'p': cfg.port_ = atoi(optarg); break;
+        case 'c': cfg.client_id_ = strtoul(optarg, nullptr, 10); break;
+        case 'd': cfg.duration_secs_ = strtoul(optarg, nullptr, 10); break;
+        case 't': cfg.trades_only_ = true; break;
+        case 'u': cfg.tcp_backend_ = Common::TCPBackend::IO_URING; break;
+        default: usage(argv[0]);
+        }
+    }
+
+    Tools::TickToTrade tick_to_trade(cfg);
+    tick_to_trade.run();
+    std::cout << tick_to_trade.report();
+
+    return 0;
+}
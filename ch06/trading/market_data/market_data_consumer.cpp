@@ -2,14 +2,19 @@
 
 namespace Trading
 {
-    MarketDataConsumer::MarketDataConsumer(Common::ClientId client_id, Exchange::MEMarketUpdateLFQueue* market_updates,
+    MarketDataConsumer::MarketDataConsumer(Common::ClientId client_id, Exchange::MDCMarketUpdateLFQueue* market_updates,
                                 const std::string& iface,
                                 const std::string& snapshot_ip, int snapshot_port,
-                                const std::string& increment_ip, int incremental_port) 
+                                const std::string& increment_ip, int incremental_port,
+                                const std::string& increment_b_ip, int incremental_b_port,
+                                const std::string& retransmit_ip, int retransmit_port) 
                                 : incoming_md_updates_(market_updates), run_(false), 
                                 logger_("trading_market_data_consumer_" + std::to_string(client_id) + ".log"),
-                                incremental_mcast_socket_(logger_), snapshot_mcast_socket_(logger_),
-                                iface_(iface), snapshot_ip_(snapshot_ip), snapshot_port_(snapshot_port) {
+                                incremental_mcast_socket_(logger_), incremental_b_mcast_socket_(logger_), snapshot_mcast_socket_(logger_),
+                                incremental_b_enabled_(!increment_b_ip.empty()), retransmit_socket_(logger_),
+                                iface_(iface), snapshot_ip_(snapshot_ip), snapshot_port_(snapshot_port),
+                                snapshot_queued_msgs_(std::bit_ceil(Exchange::ME_MAX_SNAPSHOT_UPDATES)), incremental_queued_msgs_(ME_MAX_MARKET_UPDATES),
+                                perf_sampler_("MarketDataConsumer", &logger_, Common::PERF_COUNTERS_REPORT_EVERY) {
                                     auto recv_callback = [this] (auto socket) {
                                         recvCallback(socket);
                                     };
@@ -20,175 +25,409 @@ namespace Trading
                                     ASSERT(incremental_mcast_socket_.join(increment_ip),
                                         "Join failed on:" + std::to_string(incremental_mcast_socket_.socket_fd_) + " error:" + std::string(std::strerror(errno)));
 
+                                    if(incremental_b_enabled_) {
+                                        incremental_b_mcast_socket_.recv_callback_ = recv_callback;
+                                        ASSERT(incremental_b_mcast_socket_.init(increment_b_ip, iface, incremental_b_port, /*is_listening*/ true) >= 0,
+                                        "Unable to create incremental B mcast socket. error:" + std::string(std::strerror(errno)));
+                                        ASSERT(incremental_b_mcast_socket_.join(increment_b_ip),
+                                            "Join failed on:" + std::to_string(incremental_b_mcast_socket_.socket_fd_) + " error:" + std::string(std::strerror(errno)));
+                                    }
+
                                     snapshot_mcast_socket_.recv_callback_ = recv_callback;
+
+                                    // Gap fills are an optimisation, without the retransmission service every gap is recovered from a snapshot
+                                    if(!retransmit_ip.empty() && retransmit_port) {
+                                        retransmit_socket_.recv_callback_ = [this](auto socket, auto rx_time) { retransmitCallback(socket, rx_time); };
+                                        retransmit_enabled_ = (retransmit_socket_.connect(retransmit_ip, iface, retransmit_port, false) >= 0);
+                                        logger_.log("%:% %() % Retransmission service %:% enabled:%\n", __FILE__, __LINE__, __FUNCTION__,
+                                            Common::getCurrentTimeStr(&time_str_), retransmit_ip, retransmit_port, retransmit_enabled_);
+                                    }
                                 }
     
     auto MarketDataConsumer::run() noexcept -> void {
         logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+        perf_sampler_.open();
         while (run_)
         {
             incremental_mcast_socket_.sendAndRecv();
+            if(incremental_b_enabled_)
+                incremental_b_mcast_socket_.sendAndRecv();
             snapshot_mcast_socket_.sendAndRecv();
+
+            // The other line never filled the gap, it lost the packet as well
+            if(UNLIKELY(line_gap_time_ && Common::getCurrentNanos() - line_gap_time_ > LINE_ARBITRATION_TIMEOUT))
+                lineGapLost();
+
+            // Only polled while a gap fill is outstanding, the connection is idle otherwise
+            if(UNLIKELY(gap_fill_time_)) {
+                retransmit_socket_.sendAndRecv();
+                if(gap_fill_time_ && Common::getCurrentNanos() - gap_fill_time_ > GAP_FILL_TIMEOUT) {
+                    logger_.log("%:% %() % Gap fill timed out %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                        gap_fill_request_.toString());
+                    startSnapshotSync();
+                }
+            }
         }
     }
 
+    auto MarketDataConsumer::arbitratePacket(size_t line, size_t packet_seq, Common::Nanos recv_time) noexcept -> bool {
+        auto process = true;
+        if(LIKELY(!next_exp_inc_packet_seq_ || packet_seq == next_exp_inc_packet_seq_)) {
+            next_exp_inc_packet_seq_ = packet_seq + 1;
+        } else if(packet_seq < next_exp_inc_packet_seq_) {
+            // Behind the other line, which skipped it if it is not before the gap. Its updates are sorted out by sequence number.
+            process = line_gap_time_ && packet_seq >= line_gap_packet_seq_;
+            num_duplicate_packets_ += !process;
+        } else {
+            // This line skipped [next_exp_inc_packet_seq_, packet_seq). Process the packet anyway, its updates are queued until the other
+            // line delivers the missing ones.
+            logger_.log("%:% %() % Packet gap on line %. PacketSeq expected:% received:% duplicates so far:%\n", __FILE__, __LINE__, __FUNCTION__,
+                Common::getCurrentTimeStr(&time_str_), (line ? 'B' : 'A'), next_exp_inc_packet_seq_, packet_seq, num_duplicate_packets_);
+            if(!line_gap_time_) {
+                line_gap_time_ = recv_time;
+                line_gap_packet_seq_ = next_exp_inc_packet_seq_;
+            }
+            next_exp_inc_packet_seq_ = packet_seq + 1;
+        }
+
+        line_last_packet_seq_[line] = packet_seq;
+        for(size_t l = 0; l < (incremental_b_enabled_ ? 2 : 1); ++l) {
+            if(line_last_packet_seq_[l] + 1 >= next_exp_inc_packet_seq_)
+                line_behind_time_[l] = 0;
+            else if(!line_behind_time_[l])
+                line_behind_time_[l] = recv_time;
+        }
+
+        return process;
+    }
+
+    // Apply the updates queued behind the line gap which the packet just processed filled, and give up on the gap if no line can still fill it
+    auto MarketDataConsumer::checkLineGap(size_t packet_seq, Common::Nanos recv_time) noexcept -> void {
+        const auto next_exp_seq = next_exp_inc_seq_inc_;
+        if(!applyQueuedIncrementals()) {
+            logger_.log("%:% %() % Packet gap filled by the other line, next seq:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                next_exp_inc_seq_inc_);
+            incremental_queued_msgs_.clear();
+            line_gap_time_ = 0;
+            return;
+        }
+
+        // Partly filled, the rest of the gap is after this packet
+        if(next_exp_inc_seq_inc_ != next_exp_seq) {
+            line_gap_time_ = recv_time;
+            line_gap_packet_seq_ = packet_seq + 1;
+        }
+
+        // Every line has either moved past the gap or lagged so long it is taken for dead, none of them is going to fill it
+        bool lost = true;
+        for(size_t line = 0; line < (incremental_b_enabled_ ? 2 : 1); ++line)
+            lost = lost && (line_last_packet_seq_[line] > line_gap_packet_seq_ ||
+                            (line_behind_time_[line] && recv_time - line_behind_time_[line] > LINE_ARBITRATION_TIMEOUT));
+        if(lost)
+            lineGapLost();
+    }
+
+    // Recover the updates of a packet missing on every line, those queued behind it are applied once they are
+    auto MarketDataConsumer::lineGapLost() noexcept -> void {
+        logger_.log("%:% %() % Packet gap not filled by the other line. PacketSeq:% SeqNum expected:%\n", __FILE__, __LINE__, __FUNCTION__,
+            Common::getCurrentTimeStr(&time_str_), line_gap_packet_seq_, next_exp_inc_seq_inc_);
+        line_gap_time_ = 0;
+        if(!applyQueuedIncrementals()) { // nothing held back behind it
+            incremental_queued_msgs_.clear();
+            return;
+        }
+        in_recovery_ = true;
+        startRecovery(nextQueuedSeq());
+    }
+
     auto MarketDataConsumer::recvCallback(McastSocket* socket) noexcept -> void {
+        Common::PerfCounterScope perf_scope(&perf_sampler_);
+        const auto recv_time = Common::getCurrentNanos();
+
         const auto is_snapshot = (socket->socket_fd_ == snapshot_mcast_socket_.socket_fd_);
         // market update was read from the snapshot market data stream and we are not in recovery, so we don't need it and discard it
         if(UNLIKELY(is_snapshot && !in_recovery_)) { 
-            socket->next_rcv_valid_index_ = 0;
+            socket->inbound_data_.clear();
             logger_.log("%:% %() % WARN Not expecting snapshot messages.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
         }
 
-        if(socket->next_rcv_valid_index_ >= sizeof(Exchange::MDPMarketUpdate)) {
-            size_t i = 0;
-            for(; i + sizeof(Exchange::MDPMarketUpdate) <= socket->next_rcv_valid_index_; i+=sizeof(Exchange::MDPMarketUpdate)) {
-                auto request = reinterpret_cast<const Exchange::MDPMarketUpdate*>(socket->inbound_data_.data() + i);
-                logger_.log("%:% %() % Received % socket len:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), 
-                (is_snapshot ? "snapshot" : "incremental"), sizeof(Exchange::MDPMarketUpdate), request->toString());
-
-                const bool already_in_recovery = in_recovery_;
-                in_recovery_ = (already_in_recovery || request->seq_num_ != next_exp_inc_seq_inc_);
-
-                if(UNLIKELY(in_recovery_)) {
-                    if(UNLIKELY(!already_in_recovery)) { // if we entered recovery, start the snapshot synchronization process by subscribing to the multicast stream
-                        logger_.log("%:% %() % Packet drop on % socket. SeqNum expected:% received:%\n", __FILE__, __LINE__, __FUNCTION__, 
-                            Common::getCurrentTimeStr(&time_str_), (is_snapshot ? "snapshot" : "incremental"), next_exp_inc_seq_inc_, request->seq_num_);
-                        startSnapshotSync();
-                    }
+        // Every datagram is one packet, an MDPPacketHeader followed by the updates it counts
+        auto& inbound_data = socket->inbound_data_;
+        if(!inbound_data.readable())
+            return;
+        const auto header = reinterpret_cast<const Exchange::MDPPacketHeader*>(inbound_data.readPtr());
+        if(UNLIKELY(inbound_data.readable() < sizeof(Exchange::MDPPacketHeader) ||
+                    (header->encoding_ == Exchange::MDPEncoding::RAW &&
+                     inbound_data.readable() != sizeof(Exchange::MDPPacketHeader) + header->num_updates_ * header->rawUpdateSize()) ||
+                    header->encoding_ > Exchange::MDPEncoding::DELTA)) {
+            logger_.log("%:% %() % ERROR Malformed packet on % socket len:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                (is_snapshot ? "snapshot" : "incremental"), inbound_data.readable());
+            inbound_data.clear();
+            return;
+        }
+        logger_.log("%:% %() % Received % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            (is_snapshot ? "snapshot" : "incremental"), header->toString());
 
-                    queueMessage(is_snapshot, request); // queue up the market data update msg and check if snapshot recovery / synchro can be completed successfully
-                } else if(!is_snapshot) {
-                    logger_.log("%:% %() % % \n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), request->toString());
-                    ++next_exp_inc_seq_inc_;
+        if(is_snapshot) {
+            if(UNLIKELY(next_exp_snapshot_packet_seq_ && header->packet_seq_num_ != next_exp_snapshot_packet_seq_))
+                logger_.log("%:% %() % Packet gap on snapshot socket. PacketSeq expected:% received:%\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getCurrentTimeStr(&time_str_), next_exp_snapshot_packet_seq_, header->packet_seq_num_);
+            next_exp_snapshot_packet_seq_ = header->packet_seq_num_ + 1;
+        } else if(!in_recovery_ && !arbitratePacket(socket == &incremental_b_mcast_socket_, header->packet_seq_num_, recv_time)) {
+            inbound_data.clear();
+            return;
+        }
+        const auto packet_seq = header->packet_seq_num_;
+        const auto encoding = header->encoding_;
+        const auto num_updates = header->num_updates_;
+        const auto stamped = (header->flags_ & Exchange::MDP_PUBLISH_TIME_FLAG);
+        const auto raw_update_size = header->rawUpdateSize();
+        inbound_data.consume(sizeof(Exchange::MDPPacketHeader));
 
-                    auto next_write = incoming_md_updates_->getNextToWriteTo();
-                    *next_write = std::move(request->me_market_update_);
-                    incoming_md_updates_->updateWriteIndex();
+        if(encoding == Exchange::MDPEncoding::RAW) {
+            for(; inbound_data.readable() >= raw_update_size; inbound_data.consume(raw_update_size)) {
+                const auto update = reinterpret_cast<const Exchange::MDPStampedMarketUpdate*>(inbound_data.readPtr());
+                onMarketUpdate(is_snapshot, &update->mdp_market_update_, stamped ? update->publish_time_ : 0, recv_time);
+            }
+        } else {
+            delta_codec_.reset();
+            for(uint16_t i = 0; i < num_updates; ++i) {
+                const auto len = (encoding == Exchange::MDPEncoding::SBE ? Exchange::sbeDecode(inbound_data.readPtr(), inbound_data.readable(), &decoded_update_) :
+                                                                           delta_codec_.decode(inbound_data.readPtr(), inbound_data.readable(), &decoded_update_));
+                if(UNLIKELY(!len)) {
+                    logger_.log("%:% %() % ERROR Undecodable % update % of % on % socket\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                        Exchange::mdpEncodingToString(encoding), i, num_updates, (is_snapshot ? "snapshot" : "incremental"));
+                    break;
                 }
+                inbound_data.consume(len);
+                // Template of a newer schema, nothing this consumer could apply
+                if(UNLIKELY(decoded_update_.mdp_market_update_.me_market_update_.type_ == Exchange::MarketUpdateType::INVALID))
+                    continue;
+                onMarketUpdate(is_snapshot, &decoded_update_.mdp_market_update_, decoded_update_.publish_time_, recv_time);
             }
-            memcpy(socket->inbound_data_.data(), socket->inbound_data_.data() + i, socket->next_rcv_valid_index_ - i);
-            socket->next_rcv_valid_index_ -= i;
+            inbound_data.clear();
         }
+
+        if(UNLIKELY(line_gap_time_ && !is_snapshot && !in_recovery_))
+            checkLineGap(packet_seq, recv_time);
     }
 
-    // Start the process of snapshot synchronization by subscribing to the snapshot multicast stream
-    auto MarketDataConsumer::startSnapshotSync() -> void {
-        snapshot_queued_msgs_.clear();
-        incremental_queued_msgs_.clear();
+    auto MarketDataConsumer::onMarketUpdate(bool is_snapshot, const Exchange::MDPMarketUpdate* request, Common::Nanos publish_time, Common::Nanos recv_time) noexcept -> void {
+        logger_.log("%:% %() % Received % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+        (is_snapshot ? "snapshot" : "incremental"), request->toString());
 
-        ASSERT(snapshot_mcast_socket_.init(snapshot_ip_, iface_, snapshot_port_, /*is_listening*/ true) >= 0,
-        "Unable to create incremental mcast socket. error:" + std::string(std::strerror(errno)));
-        ASSERT(snapshot_mcast_socket_.join(snapshot_ip_), // IGMP multicast subscription
-            "Join failed on:" + std::to_string(snapshot_mcast_socket_.socket_fd_) + " error:" + std::string(std::strerror(errno)));
+        // Already applied before a resync from recovery, and replayed by the slower line
+        if(!is_snapshot && !in_recovery_ && request->seq_num_ < next_exp_inc_seq_inc_)
+            return;
 
-    }
+        // Behind a packet this line skipped, held back until the other line delivers it
+        if(UNLIKELY(!is_snapshot && !in_recovery_ && line_gap_time_ && request->seq_num_ != next_exp_inc_seq_inc_)) {
+            incremental_queued_msgs_.insert(request->seq_num_, request->me_market_update_);
+            return;
+        }
 
-    // Queue up a message in the *_queue_msgs_ containers, first param specifies if the update came from the snapshot or the incremental stream
-     auto MarketDataConsumer::queueMessage(bool is_snapshot, const Exchange::MDPMarketUpdate* request) {
-        if(is_snapshot) {
-            if(snapshot_queued_msgs_.find(request->seq_num_) != snapshot_queued_msgs_.end()) {
-                logger_.log("%:% %() % Packet drops on snapshot socket. Received for a 2nd time:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), request->toString());
-                snapshot_queued_msgs_.clear();
+        const bool already_in_recovery = in_recovery_;
+        in_recovery_ = (already_in_recovery || request->seq_num_ != next_exp_inc_seq_inc_);
+
+        if(UNLIKELY(in_recovery_)) {
+            if(UNLIKELY(!already_in_recovery)) { // if we entered recovery, start the snapshot synchronization process by subscribing to the multicast stream
+                logger_.log("%:% %() % Packet drop on % socket. SeqNum expected:% received:%\n", __FILE__, __LINE__, __FUNCTION__, 
+                    Common::getCurrentTimeStr(&time_str_), (is_snapshot ? "snapshot" : "incremental"), next_exp_inc_seq_inc_, request->seq_num_);
+                startRecovery(request->seq_num_);
             }
-            snapshot_queued_msgs_[request->seq_num_] = request->me_market_update_;
-        } else {
-            logger_.log("%:% %() % size snapshot:% incremental:% % => %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), snapshot_queued_msgs_.size(), incremental_queued_msgs_.size(), request->seq_num_, request->toString());
-            checkSnapshotSync();
+
+            queueMessage(is_snapshot, request); // queue up the market data update msg and check if snapshot recovery / synchro can be completed successfully
+        } else if(!is_snapshot) {
+            logger_.log("%:% %() % % \n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), request->toString());
+            ++next_exp_inc_seq_inc_;
+
+            auto next_write = incoming_md_updates_->getNextToWriteTo();
+            *next_write = {request->me_market_update_, publish_time, recv_time};
+            incoming_md_updates_->updateWriteIndex();
         }
-     }
+    }
 
-     // Check if a recovery / synchro is possible for the queued up market data updates from the snapshot and incremental market data streams
-     auto MarketDataConsumer::checkSnapshotSync() -> void {
-        if(snapshot_queued_msgs_.empty()) {
+    // Recover the incremental updates before seq_num, from the retransmission service if the gap is small enough
+    auto MarketDataConsumer::startRecovery(size_t seq_num) -> void {
+        if(retransmit_enabled_ && seq_num > next_exp_inc_seq_inc_ && seq_num - next_exp_inc_seq_inc_ <= Exchange::MDP_MAX_RETRANSMIT_COUNT) {
+            requestGapFill(seq_num - next_exp_inc_seq_inc_);
             return;
         }
 
-        const auto& first_snapshot_msg = snapshot_queued_msgs_.begin()->second;
-        if(first_snapshot_msg.type_ != Exchange::MarketUpdateType::SNAPSHOT_START) {
-            logger_.log("%:% %() % Returning because have not seen s SNAPSHOT_START yet. \n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
-            snapshot_queued_msgs_.clear();
+        startSnapshotSync();
+    }
+
+    // Ask the retransmission service for count updates from next_exp_inc_seq_inc_, incremental updates are queued until they arrive
+    auto MarketDataConsumer::requestGapFill(size_t count) -> void {
+        gap_fill_request_.begin_seq_num_ = next_exp_inc_seq_inc_;
+        gap_fill_request_.count_ = static_cast<uint32_t>(count);
+        if(!retransmit_socket_.reserveSend(sizeof(gap_fill_request_))) {
+            startSnapshotSync();
             return;
         }
 
-        std::vector<Exchange::MEMarketUpdate> final_events;
+        logger_.log("%:% %() % Requesting %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), gap_fill_request_.toString());
+        retransmit_socket_.send(&gap_fill_request_, sizeof(gap_fill_request_));
+        retransmit_socket_.sendAndRecv();
+        gap_fill_time_ = Common::getCurrentNanos();
+    }
+
+    auto MarketDataConsumer::retransmitCallback(Common::TCPSocket* socket, Common::Nanos) noexcept -> void {
+        auto& inbound_data = socket->inbound_data_;
+        while(inbound_data.readable() >= sizeof(Exchange::MDPRetransmitResponse)) {
+            const auto response = reinterpret_cast<const Exchange::MDPRetransmitResponse*>(inbound_data.readPtr());
+            const auto len = sizeof(Exchange::MDPRetransmitResponse) + response->count_ * sizeof(Exchange::MDPMarketUpdate);
+            if(inbound_data.readable() < len) // rest of the response still on its way
+                return;
+
+            logger_.log("%:% %() % Received % for %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), response->toString(),
+                gap_fill_request_.toString());
+
+            // Answer to a request given up on already
+            if(!gap_fill_time_ || response->begin_seq_num_ != gap_fill_request_.begin_seq_num_) {
+                inbound_data.consume(len);
+                continue;
+            }
 
-        auto have_complete_snapshot = true;
-        size_t next_snapshot_seq = 0;
-        for(auto& snapshot_itr: snapshot_queued_msgs_) {
-            logger_.log("%:% %() % % => %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), snapshot_itr.first, snapshot_itr.second.toString());
-            if(snapshot_itr.first != next_snapshot_seq) {
-                have_complete_snapshot = false;
-                logger_.log("%:% %() % Detected gap in snapshot stream, expected:% found:% %.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), 
-                next_snapshot_seq, snapshot_itr.first, snapshot_itr.second.toString());
-                break;
+            gap_fill_time_ = 0;
+            if(!response->count_) {
+                inbound_data.consume(len);
+                startSnapshotSync();
+                continue;
             }
 
-            if (snapshot_itr.second.type_ != Exchange::MarketUpdateType::SNAPSHOT_START &&
-                snapshot_itr.second.type_ != Exchange::MarketUpdateType::SNAPSHOT_END)
-                final_events.push_back(snapshot_itr.second);
-            
-            ++next_snapshot_seq;
+            auto update = reinterpret_cast<const Exchange::MDPMarketUpdate*>(inbound_data.readPtr() + sizeof(Exchange::MDPRetransmitResponse));
+            for(uint32_t i = 0; i < response->count_; ++i, ++update)
+                incremental_queued_msgs_.insert(update->seq_num_, update->me_market_update_);
+            inbound_data.consume(len);
+
+            checkGapFill();
         }
+    }
 
-        if(!have_complete_snapshot) {
-            logger_.log("%:% %() % Returning because found gaps in snapshot stream.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
-            snapshot_queued_msgs_.clear();
-            return;
+    // Apply the queued incremental updates up to the first gap, returns whether any are left queued behind it
+    auto MarketDataConsumer::applyQueuedIncrementals() noexcept -> bool {
+        for(; incremental_queued_msgs_.contains(next_exp_inc_seq_inc_); ++next_exp_inc_seq_inc_) {
+            auto next_write = incoming_md_updates_->getNextToWriteTo();
+            *next_write = {incremental_queued_msgs_.at(next_exp_inc_seq_inc_)};
+            incoming_md_updates_->updateWriteIndex();
         }
 
-        const auto& last_snapshot_msg = snapshot_queued_msgs_.rbegin()->second;
-        if(last_snapshot_msg.type_ != Exchange::MarketUpdateType::SNAPSHOT_END) {
-            logger_.log("%:% %() % Returning because have not seen s SNAPSHOT_START yet.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+        return !incremental_queued_msgs_.empty() && incremental_queued_msgs_.maxSeq() >= next_exp_inc_seq_inc_;
+    }
+
+    // Lowest queued incremental seq after the first gap, only valid if applyQueuedIncrementals() left any
+    auto MarketDataConsumer::nextQueuedSeq() const noexcept -> size_t {
+        auto next_queued_seq = next_exp_inc_seq_inc_ + 1;
+        while(!incremental_queued_msgs_.contains(next_queued_seq))
+            ++next_queued_seq;
+        return next_queued_seq;
+    }
+
+    // Apply the queued incremental updates up to the first gap, recovery is complete if none is left
+    auto MarketDataConsumer::checkGapFill() -> void {
+        if(applyQueuedIncrementals()) { // lost more while waiting for the gap fill
+            const auto next_queued_seq = nextQueuedSeq();
+            logger_.log("%:% %() % Gap filled up to seq:%, next queued seq:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                next_exp_inc_seq_inc_, next_queued_seq);
+            startRecovery(next_queued_seq);
             return;
         }
 
-        auto have_complete_incremental = true;
-        size_t num_incrementals = 0;
-        next_exp_inc_seq_inc_ = last_snapshot_msg.order_id_ + 1;
-        for(auto inc_itr = incremental_queued_msgs_.begin(); inc_itr != incremental_queued_msgs_.end(); ++inc_itr) {
-            logger_.log("%:% %() % Checking next_exp:% vs seq:% %.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-            next_exp_inc_seq_inc_, inc_itr->first, inc_itr->second.toString());
+        logger_.log("%:% %() % Gap filled, next seq:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), next_exp_inc_seq_inc_);
+        incremental_queued_msgs_.clear();
+        in_recovery_ = false;
+        next_exp_inc_packet_seq_ = 0;
+        line_last_packet_seq_ = {};
+        line_behind_time_ = {};
+    }
 
-            if(inc_itr->first < next_exp_inc_seq_inc_)
-                continue;
-            
-            if(inc_itr->first != next_exp_inc_seq_inc_) {
-                logger_.log("%:% %() % Detected gap in incremental stream expected:% found:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                next_exp_inc_seq_inc_, inc_itr->first, inc_itr->second.toString());
-                have_complete_incremental = false;
-                break;
-            }
+    // Start the process of snapshot synchronization by subscribing to the snapshot multicast stream
+    auto MarketDataConsumer::startSnapshotSync() -> void {
+        gap_fill_time_ = 0;
+        next_exp_snapshot_packet_seq_ = 0;
+        snapshot_queued_msgs_.clear();
+        incremental_queued_msgs_.clear();
 
-            logger_.log("%:% %() % % => %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), inc_itr->first, inc_itr->second.toString());
+        ASSERT(snapshot_mcast_socket_.init(snapshot_ip_, iface_, snapshot_port_, /*is_listening*/ true) >= 0,
+        "Unable to create incremental mcast socket. error:" + std::string(std::strerror(errno)));
+        ASSERT(snapshot_mcast_socket_.join(snapshot_ip_), // IGMP multicast subscription
+            "Join failed on:" + std::to_string(snapshot_mcast_socket_.socket_fd_) + " error:" + std::string(std::strerror(errno)));
 
-            if(inc_itr->second.type_ != Exchange::MarketUpdateType::SNAPSHOT_START
-                && inc_itr->second.type_ != Exchange::MarketUpdateType::SNAPSHOT_END)
-                final_events.push_back(inc_itr->second);
-            
+    }
 
-            ++next_exp_inc_seq_inc_;
-            ++num_incrementals;
+    // Queue up a message in the *_queue_msgs_ containers, first param specifies if the update came from the snapshot or the incremental stream
+     auto MarketDataConsumer::queueMessage(bool is_snapshot, const Exchange::MDPMarketUpdate* request) -> void {
+        if(is_snapshot) {
+            // Each snapshot is sequenced from 0 and arrives in order, anything but the next seq means drops or the start of the next snapshot
+            const auto next_snapshot_seq = (snapshot_queued_msgs_.empty() ? 0 : snapshot_queued_msgs_.maxSeq() + 1);
+            if(request->seq_num_ != next_snapshot_seq) {
+                logger_.log("%:% %() % Packet drops on snapshot socket. SeqNum expected:% received:%\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getCurrentTimeStr(&time_str_), next_snapshot_seq, request->toString());
+                snapshot_queued_msgs_.clear();
+            }
+            if(snapshot_queued_msgs_.empty() && request->me_market_update_.type_ != Exchange::MarketUpdateType::SNAPSHOT_START) {
+                logger_.log("%:% %() % Returning because have not seen a SNAPSHOT_START yet.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+                return;
+            }
+            snapshot_queued_msgs_.insert(request->seq_num_, request->me_market_update_);
+        } else {
+            incremental_queued_msgs_.insert(request->seq_num_, request->me_market_update_);
         }
 
-        if(!have_complete_incremental) {
-            logger_.log("%:% %() % Returning because have gaps in queued incrementals.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+        logger_.log("%:% %() % snapshot max:% incremental contiguous:[%, %] % => %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            snapshot_queued_msgs_.maxSeq(), incremental_queued_msgs_.contiguousFrom(), incremental_queued_msgs_.maxSeq(), request->seq_num_, request->toString());
+        checkSnapshotSync();
+     }
+
+     // Check if a recovery / synchro is possible for the queued up market data updates from the snapshot and incremental market data streams.
+     // The snapshot queue only ever holds a gap free prefix of a snapshot, so it is complete once its last update is the SNAPSHOT_END.
+     auto MarketDataConsumer::checkSnapshotSync() -> void {
+        if(snapshot_queued_msgs_.empty())
+            return;
+
+        const auto snapshot_end_seq = snapshot_queued_msgs_.maxSeq();
+        const auto& last_snapshot_msg = snapshot_queued_msgs_.at(snapshot_end_seq);
+        if(last_snapshot_msg.type_ != Exchange::MarketUpdateType::SNAPSHOT_END)
+            return;
+
+        // Every incremental update after the one the snapshot was taken at has to be queued, i.e. contiguous up to the latest one
+        const auto first_inc_seq = last_snapshot_msg.order_id_ + 1;
+        if(!incremental_queued_msgs_.empty() && incremental_queued_msgs_.maxSeq() >= first_inc_seq && incremental_queued_msgs_.contiguousFrom() > first_inc_seq) {
+            logger_.log("%:% %() % Returning because have gaps in queued incrementals. expected:% contiguous from:%\n", __FILE__, __LINE__, __FUNCTION__,
+                Common::getCurrentTimeStr(&time_str_), first_inc_seq, incremental_queued_msgs_.contiguousFrom());
             snapshot_queued_msgs_.clear();
             return;
         }
 
-        for(const auto& itr: final_events) {
+        auto publish = [this](const Exchange::MEMarketUpdate& market_update) {
+            if(market_update.type_ == Exchange::MarketUpdateType::SNAPSHOT_START || market_update.type_ == Exchange::MarketUpdateType::SNAPSHOT_END)
+                return;
             auto next_write = incoming_md_updates_->getNextToWriteTo();
-            *next_write = itr;
+            *next_write = {market_update};
             incoming_md_updates_->updateWriteIndex();
+        };
+
+        for(size_t seq = 1; seq < snapshot_end_seq; ++seq)
+            publish(snapshot_queued_msgs_.at(seq));
+
+        size_t num_incrementals = 0;
+        next_exp_inc_seq_inc_ = first_inc_seq;
+        if(!incremental_queued_msgs_.empty()) {
+            for(; next_exp_inc_seq_inc_ <= incremental_queued_msgs_.maxSeq(); ++next_exp_inc_seq_inc_, ++num_incrementals)
+                publish(incremental_queued_msgs_.at(next_exp_inc_seq_inc_));
         }
 
-        logger_.log("%:% %() % Recovered snapshot and % incremental orders.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-        snapshot_queued_msgs_.size() - 2, num_incrementals);
+        logger_.log("%:% %() % Recovered snapshot of % and % incremental orders.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+        snapshot_end_seq - 1, num_incrementals);
         
         snapshot_queued_msgs_.clear();
         incremental_queued_msgs_.clear();
         in_recovery_  = false;
+        // Resynchronise line arbitration on the next incremental packet, updates already applied are skipped by sequence number
+        next_exp_inc_packet_seq_ = 0;
+        line_last_packet_seq_ = {};
+        line_behind_time_ = {};
 
         snapshot_mcast_socket_.leave(snapshot_ip_, snapshot_port_);
      }
@@ -1,41 +1,92 @@
 #pragma once
 
+#include <array>
+#include <bit>
 #include <functional>
-#include <map>
 
 #include "common/thread_utils.h"
 #include "common/lf_queue.h"
 #include "common/macros.h"
 #include "common/mcast_socket.h"
+#include "common/tcp_socket.h"
+#include "common/perf_counters.h"
 #include "exchange/market_data/market_update.h"
+#include "exchange/market_data/mdp_sbe.h"
+#include "exchange/market_data/mdp_delta.h"
+#include "trading/market_data/queued_market_updates.h"
 
 namespace Trading
 {
     class MarketDataConsumer {
         private:
             size_t next_exp_inc_seq_inc_ = 1;
-            Exchange::MEMarketUpdateLFQueue* incoming_md_updates_ = nullptr;
+            // Next packet sequence number expected on each stream, 0 until the first packet after (re)joining it
+            size_t next_exp_inc_packet_seq_ = 0, next_exp_snapshot_packet_seq_ = 0;
+            Exchange::MDCMarketUpdateLFQueue* incoming_md_updates_ = nullptr;
             volatile bool run_;
             std::string time_str_;
             Logger logger_;
-            Common::McastSocket incremental_mcast_socket_, snapshot_mcast_socket_;
+            // A and optional B incremental feeds carrying identical packets, and the snapshot feed joined only during recovery
+            Common::McastSocket incremental_mcast_socket_, incremental_b_mcast_socket_, snapshot_mcast_socket_;
+            const bool incremental_b_enabled_ = false;
             bool in_recovery_ = false;
+
+            // Line arbitration: the first copy of every incremental packet is processed and the later one dropped. Updates after a gap
+            // on one line are queued while the other line fills it (line_gap_time_ != 0). Only a packet missing on every line starts
+            // recovery: every line has moved past it or lagged the others for LINE_ARBITRATION_TIMEOUT, or the gap stays open that long.
+            static constexpr Common::Nanos LINE_ARBITRATION_TIMEOUT = 10 * Common::NANOS_TO_MILLIS;
+            std::array<size_t, 2> line_last_packet_seq_{};
+            // Since when a line has not delivered the latest packet yet, 0 while it is level with the others
+            std::array<Common::Nanos, 2> line_behind_time_{};
+            Common::Nanos line_gap_time_ = 0;
+            // First packet of the open gap
+            size_t line_gap_packet_seq_ = 0;
+            size_t num_duplicate_packets_ = 0;
+
+            // Connection to the exchange's retransmission service and the outstanding gap fill, if any (gap_fill_time_ != 0).
+            // Small gaps are filled from it, larger ones, a rejected request or one unanswered for GAP_FILL_TIMEOUT fall back to a snapshot.
+            static constexpr Common::Nanos GAP_FILL_TIMEOUT = 100 * Common::NANOS_TO_MILLIS;
+            Common::TCPSocket retransmit_socket_;
+            bool retransmit_enabled_ = false;
+            Exchange::MDPRetransmitRequest gap_fill_request_;
+            Common::Nanos gap_fill_time_ = 0;
             const std::string iface_, snapshot_ip_;
             const int snapshot_port_;
-            typedef std::map<size_t, Exchange::MEMarketUpdate> QueuedMarketUpdates;
+            // Updates queued while recovering. The snapshot ring holds the largest possible snapshot, so any book can be recovered,
+            // the incremental ring ME_MAX_MARKET_UPDATES updates.
             QueuedMarketUpdates snapshot_queued_msgs_, incremental_queued_msgs_;
 
+            // Hardware counters sampled around every recvCallback()
+            Common::PerfCounterSampler perf_sampler_;
+
+            // Target SBE and delta encoded updates are decoded into, and the deltas of the packet being decoded
+            Exchange::MDPStampedMarketUpdate decoded_update_;
+            Exchange::MDPDeltaCodec delta_codec_;
+
             auto run() noexcept -> void;
             auto recvCallback(McastSocket* socket) noexcept -> void;
+            auto onMarketUpdate(bool is_snapshot, const Exchange::MDPMarketUpdate* request, Common::Nanos publish_time, Common::Nanos recv_time) noexcept -> void;
+            // Whether the incremental packet packet_seq received on line 0 (A) or 1 (B) is to be processed, false for a duplicate
+            auto arbitratePacket(size_t line, size_t packet_seq, Common::Nanos recv_time) noexcept -> bool;
+            auto checkLineGap(size_t packet_seq, Common::Nanos recv_time) noexcept -> void;
+            auto lineGapLost() noexcept -> void;
+            auto startRecovery(size_t seq_num) -> void;
+            auto requestGapFill(size_t count) -> void;
+            auto retransmitCallback(Common::TCPSocket* socket, Common::Nanos rx_time) noexcept -> void;
+            auto applyQueuedIncrementals() noexcept -> bool;
+            auto nextQueuedSeq() const noexcept -> size_t;
+            auto checkGapFill() -> void;
             auto startSnapshotSync() -> void;
             auto checkSnapshotSync() -> void;
-            auto queueMessage(bool is_snapshot, const Exchange::MDPMarketUpdate* request);
+            auto queueMessage(bool is_snapshot, const Exchange::MDPMarketUpdate* request) -> void;
 
         public:
-            MarketDataConsumer(Common::ClientId client_id, Exchange::MEMarketUpdateLFQueue* market_updates,
+            MarketDataConsumer(Common::ClientId client_id, Exchange::MDCMarketUpdateLFQueue* market_updates,
                                 const std::string& iface,
                                 const std::string& snapshot_ip, int snapshot_port,
-                                const std::string& increment_ip, int incremental_port);
+                                const std::string& increment_ip, int incremental_port,
+                                const std::string& increment_b_ip = "", int incremental_b_port = 0,
+                                const std::string& retransmit_ip = "", int retransmit_port = 0);
 
             ~MarketDataConsumer() {
                 stop();
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <string>
+
+#include <sys/mman.h>
+
+#include "common/macros.h"
+#include "exchange/market_data/market_update.h"
+
+namespace Trading
+{
+    // MEMarketUpdates queued up during recovery, in a ring preallocated up front and indexed by sequence number, so queueing never
+    // allocates. Holds the capacity most recent sequence numbers, older ones fall out of the ring as newer ones are queued.
+    // Tracks the run of contiguous sequence numbers ending at the highest one queued, so checking for gaps is O(1).
+    // The ring is mapped zero filled and its pages are only faulted in when first written, so sizing it for the largest possible
+    // snapshot costs memory only for the updates actually queued.
+    class QueuedMarketUpdates final {
+        public:
+            explicit QueuedMarketUpdates(size_t capacity) : capacity_(capacity) {
+                ASSERT(capacity && !(capacity & (capacity - 1)), "QueuedMarketUpdates capacity must be a power of two:" + std::to_string(capacity));
+                auto slots = mmap(nullptr, capacity_ * sizeof(Slot), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+                ASSERT(slots != MAP_FAILED, "Unable to map QueuedMarketUpdates of capacity:" + std::to_string(capacity) + " error:" + std::string(std::strerror(errno)));
+                slots_ = static_cast<Slot*>(slots);
+            }
+
+            ~QueuedMarketUpdates() {
+                munmap(slots_, capacity_ * sizeof(Slot));
+            }
+
+            // Forget everything queued, O(1) as slots from an older epoch read as empty
+            auto clear() noexcept -> void {
+                ++epoch_;
+                empty_ = true;
+            }
+
+            auto empty() const noexcept { return empty_; }
+            auto maxSeq() const noexcept { return max_seq_; }
+            // Lowest sequence number such that [contiguousFrom(), maxSeq()] are all queued
+            auto contiguousFrom() const noexcept { return contiguous_from_; }
+
+            auto contains(size_t seq_num) const noexcept {
+                const auto& slot = slots_[seq_num & (capacity_ - 1)];
+                return !empty_ && slot.epoch_ == epoch_ && slot.seq_num_ == seq_num && seq_num + capacity_ > max_seq_;
+            }
+
+            // Only valid if contains(seq_num)
+            auto at(size_t seq_num) const noexcept -> const Exchange::MEMarketUpdate& {
+                return slots_[seq_num & (capacity_ - 1)].update_;
+            }
+
+            // Queue update under seq_num, replacing a copy queued already. Returns false if seq_num was queued already, or is too
+            // far behind the highest sequence number to be kept.
+            auto insert(size_t seq_num, const Exchange::MEMarketUpdate& update) noexcept -> bool {
+                if(UNLIKELY(!empty_ && seq_num + capacity_ <= max_seq_))
+                    return false;
+
+                const auto duplicate = contains(seq_num);
+                auto& slot = slots_[seq_num & (capacity_ - 1)];
+                slot.epoch_ = epoch_;
+                slot.seq_num_ = seq_num;
+                slot.update_ = update;
+
+                if(empty_) {
+                    empty_ = false;
+                    max_seq_ = contiguous_from_ = seq_num;
+                } else if(seq_num > max_seq_) {
+                    if(seq_num != max_seq_ + 1)
+                        contiguous_from_ = seq_num;
+                    max_seq_ = seq_num;
+                    if(contiguous_from_ + capacity_ <= max_seq_) // the start of the run fell out of the ring
+                        contiguous_from_ = max_seq_ - capacity_ + 1;
+                } else if(seq_num + 1 == contiguous_from_) { // filled the gap below the run, extend it over what was queued before
+                    for(contiguous_from_ = seq_num; contiguous_from_ && contains(contiguous_from_ - 1); --contiguous_from_);
+                }
+
+                return !duplicate;
+            }
+
+            // deleted default, copy & move constructors and assignment-operators
+            QueuedMarketUpdates() = delete;
+            QueuedMarketUpdates(const QueuedMarketUpdates&) = delete;
+            QueuedMarketUpdates(const QueuedMarketUpdates&&) = delete;
+            QueuedMarketUpdates &operator=(const QueuedMarketUpdates&) = delete;
+            QueuedMarketUpdates &operator=(const QueuedMarketUpdates&&) = delete;
+
+        private:
+            // Only ever read when its epoch_ matches, so the zero filled slots of a fresh mapping need no construction
+            struct Slot {
+                size_t epoch_;
+                size_t seq_num_;
+                Exchange::MEMarketUpdate update_;
+            };
+
+            // Slots written before the last clear() have an older epoch_, the first epoch is 1 so untouched slots read as empty
+            const size_t capacity_;
+            Slot* slots_ = nullptr;
+            size_t epoch_ = 1;
+            bool empty_ = true;
+            size_t max_seq_ = 0, contiguous_from_ = 0;
+    };
+} // namespace Trading
@@ -3,11 +3,12 @@
 namespace Trading
 {
     OrderGateway::OrderGateway(ClientId client_id, 
-                Exchange::ClientRequestLFQueue* client_requests, 
+                Exchange::OGWClientRequestLFQueue* client_requests, 
                 Exchange::ClientResponseLFQueue* client_responses,
-                std::string ip, const std::string& iface, int port) 
-                : client_id_(client_id), ip_(ip), port_(port), outgoing_requests_(client_requests), incoming_responses_(client_responses),
-                logger_("trading_order_gateway_" + std::to_string(client_id) + ".log"), tcp_socket_(logger_) {
+                std::string ip, const std::string& iface, int port,
+                Common::TCPBackend tcp_backend, const Common::IOUringCfg& uring_cfg) 
+                : client_id_(client_id), ip_(ip), iface_(iface), port_(port), outgoing_requests_(client_requests), incoming_responses_(client_responses),
+                logger_("trading_order_gateway_" + std::to_string(client_id) + ".log"), tcp_socket_(logger_, tcp_backend, uring_cfg) {
                     tcp_socket_.recv_callback_ = [this](auto socket, auto rx_time) { recvCallback(socket, rx_time); };
                 }
     
@@ -19,10 +20,18 @@ namespace Trading
         {
             tcp_socket_.sendAndRecv();
             for(auto client_request = outgoing_requests_->getNextToRead(); client_request; client_request = outgoing_requests_->getNextToRead()) {
+                // The exchange is not draining the connection, leave requests queued until the outbound ring has room
+                if(UNLIKELY(!tcp_socket_.reserveSend(Exchange::OMSBESchema::MAX_LENGTH)))
+                    break;
                 logger_.log("%:% %() % Sending cid:% seq:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), 
-                client_id_, next_outgoing_seq_num_, client_request->toString());
-                tcp_socket_.send(&next_outgoing_seq_num_, sizeof(next_outgoing_seq_num_));
-                tcp_socket_.send(client_request, sizeof(Exchange::MEClientRequest));
+                client_id_, next_outgoing_seq_num_, client_request->me_client_request_.toString());
+                outgoing_request_.seq_num_ = next_outgoing_seq_num_;
+                outgoing_request_.me_client_request_ = client_request->me_client_request_;
+                outgoing_request_.md_publish_time_ = client_request->md_publish_time_;
+                outgoing_request_.md_recv_time_ = client_request->md_recv_time_;
+                // Only requests triggered by market data are measured, the rest leave the send stamp out of the message
+                outgoing_request_.send_time_ = (client_request->md_recv_time_ ? Common::getCurrentNanos() : 0);
+                tcp_socket_.send(outgoing_buffer_, Exchange::sbeEncode(outgoing_request_, outgoing_buffer_));
                 outgoing_requests_->updateReadIndex();
 
                 next_outgoing_seq_num_++;
@@ -33,33 +42,30 @@ namespace Trading
     // Callback when an incoming client response is read, we perform some checks and fwd it to the lock free queue connected to the trade engine.
     auto OrderGateway::recvCallback(TCPSocket* socket, Nanos rx_time) noexcept -> void {
         logger_.log("%:% %() % Received socket:% len:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-        socket->socket_fd_, socket->next_rcv_valid_index_, rx_time);
+        socket->socket_fd_, socket->inbound_data_.readable(), rx_time);
 
-        if(socket->next_rcv_valid_index_ >= sizeof(Exchange::OMClientResponse)) {
-            size_t i = 0;
-            for(; i + sizeof(Exchange::OMClientResponse) <= socket->next_rcv_valid_index_; i += sizeof(Exchange::OMClientResponse)) {
-                auto response = reinterpret_cast<const Exchange::OMClientResponse*>(socket->inbound_data_.data() + i);
-                logger_.log("%:% %() % Received %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), response->toString());
+        // Messages are decoded in place, a trailing partial message stays in the buffer until the rest of it is received
+        auto& inbound_data = socket->inbound_data_;
+        for(; inbound_data.readable() >= sizeof(Exchange::OMClientResponse); inbound_data.consume(sizeof(Exchange::OMClientResponse))) {
+            auto response = reinterpret_cast<const Exchange::OMClientResponse*>(inbound_data.readPtr());
+            logger_.log("%:% %() % Received %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), response->toString());
 
-                if(response->me_client_response_.client_id_ != client_id_) { // this should never happen unless there's a bug at the exchange
-                    logger_.log("%:% %() % ERROR Incorrect client id. ClientId expected:% received:%.\n", __FILE__, __LINE__, __FUNCTION__, 
-                        Common::getCurrentTimeStr(&time_str_), client_id_, response->me_client_response_.client_id_);
-                    continue;
-                }
-                if(response->seq_num_ != next_exp_seq_num_) {
-                    logger_.log("%:% %() % ERROR Incorrect sequence number. ClientId:% SeqNum expected:% received:%.\n", __FILE__, __LINE__, __FUNCTION__, 
-                        Common::getCurrentTimeStr(&time_str_), client_id_, next_exp_seq_num_, response->seq_num_);
-                    continue;
-                }
+            if(response->me_client_response_.client_id_ != client_id_) { // this should never happen unless there's a bug at the exchange
+                logger_.log("%:% %() % ERROR Incorrect client id. ClientId expected:% received:%.\n", __FILE__, __LINE__, __FUNCTION__, 
+                    Common::getCurrentTimeStr(&time_str_), client_id_, response->me_client_response_.client_id_);
+                continue;
+            }
+            if(response->seq_num_ != next_exp_seq_num_) {
+                logger_.log("%:% %() % ERROR Incorrect sequence number. ClientId:% SeqNum expected:% received:%.\n", __FILE__, __LINE__, __FUNCTION__, 
+                    Common::getCurrentTimeStr(&time_str_), client_id_, next_exp_seq_num_, response->seq_num_);
+                continue;
+            }
 
-                ++next_exp_seq_num_;
+            ++next_exp_seq_num_;
 
-                auto next_write = incoming_responses_->getNextToWriteTo();
-                *next_write = std::move(response->me_client_response_);
-                incoming_responses_->updateWriteIndex();
-            }
-            memcpy(socket->inbound_data_.data(), socket->inbound_data_.data() + i, socket->next_rcv_valid_index_ - i);
-            socket->next_rcv_valid_index_ -= i;
+            auto next_write = incoming_responses_->getNextToWriteTo();
+            *next_write = std::move(response->me_client_response_);
+            incoming_responses_->updateWriteIndex();
         }
     }
 } // namespace Trading
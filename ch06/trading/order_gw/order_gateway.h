@@ -6,6 +6,7 @@
 #include "common/macros.h"
 #include "common/tcp_server.h"
 #include "exchange/order_server/client_request.h"
+#include "exchange/order_server/om_sbe.h"
 #include "exchange/order_server/client_response.h"
 
 namespace Trading
@@ -16,7 +17,7 @@ namespace Trading
             std::string ip_;
             const std::string iface_;
             const int port_ = 0;
-            Exchange::ClientRequestLFQueue* outgoing_requests_ = nullptr;
+            Exchange::OGWClientRequestLFQueue* outgoing_requests_ = nullptr;
             Exchange::ClientResponseLFQueue* incoming_responses_ = nullptr;
             volatile bool run_;
             std::string time_str_;
@@ -26,14 +27,19 @@ namespace Trading
             size_t next_exp_seq_num_ = 1;
             Common::TCPSocket tcp_socket_;
 
+            // Copy of the request being sent, stamped with its send time, and its SBE encoding
+            Exchange::OMClientRequest outgoing_request_;
+            char outgoing_buffer_[Exchange::OMSBESchema::MAX_LENGTH];
+
             auto run() noexcept -> void;
             auto recvCallback(TCPSocket* socket, Nanos rx_time) noexcept -> void;
 
         public:
             OrderGateway(ClientId client_id, 
-                Exchange::ClientRequestLFQueue* client_requests, 
+                Exchange::OGWClientRequestLFQueue* client_requests, 
                 Exchange::ClientResponseLFQueue* client_responses,
-                std::string ip, const std::string& iface, int port);
+                std::string ip, const std::string& iface, int port,
+                Common::TCPBackend tcp_backend = Common::TCPBackend::EPOLL, const Common::IOUringCfg& uring_cfg = {});
             
             ~OrderGateway() {
                 stop();
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "common/macros.h"
+#include "common/types.h"
+
+#include "exchange/market_data/market_update.h"
+
+#include "market_order.h"
+
+namespace Trading
+{
+    constexpr auto Feature_INVALID = std::numeric_limits<double>::quiet_NaN();
+
+    // Signals of one ticker, Feature_INVALID until the book or trades they derive from have been seen.
+    // A cache line per ticker, so a strategy reading them touches nothing else and the engine updating them shares it with no other ticker.
+    struct alignas(64) Features {
+        double weighted_mid_ = Feature_INVALID;         // mid weighted by the top of book quantities, leans towards the thinner side
+        double book_imbalance_ = Feature_INVALID;       // (bid_qty - ask_qty) / (bid_qty + ask_qty) at the top of the book, in [-1, 1]
+        double agg_trade_qty_ratio_ = Feature_INVALID;  // qty of the last trade over the top of book qty it traded against
+        double trade_flow_imbalance_ = Feature_INVALID; // (buy - sell) / (buy + sell) of the decayed aggressor quantities, in [-1, 1]
+        double vwap_ = Feature_INVALID;                 // VWAP of the last VWAP_WINDOW trades
+    };
+    static_assert(sizeof(Features) == 64, "Features must fill exactly one cache line");
+
+    // Updates the Features of every ticker from the BBO of its MarketOrderBook after each book update and from each trade.
+    // Every update is O(1): the BBO is maintained by the book, trade flow decays geometrically and the VWAP window keeps running sums,
+    // so nothing is ever recomputed by scanning the book or the trade history.
+    class FeatureEngine final {
+        public:
+            // Weight of the previous aggressor quantities at every trade
+            static constexpr double TRADE_FLOW_DECAY = 0.9;
+            // Number of trades in the VWAP window
+            static constexpr size_t VWAP_WINDOW = 32;
+
+            FeatureEngine() = default;
+
+            // Called after an order book update has changed bbo, the BBO of ticker_id's book
+            auto onOrderBookUpdate(TickerId ticker_id, const BBO* bbo) noexcept {
+                auto& features = ticker_features_[ticker_id];
+                if(UNLIKELY(bbo->bid_price_ == Price_INVALID || bbo->ask_price_ == Price_INVALID)) {
+                    features.weighted_mid_ = features.book_imbalance_ = Feature_INVALID;
+                    return;
+                }
+
+                const auto bid_qty = static_cast<double>(bbo->bid_qty_), ask_qty = static_cast<double>(bbo->ask_qty_);
+                features.weighted_mid_ = (bbo->bid_price_ * ask_qty + bbo->ask_price_ * bid_qty) / (bid_qty + ask_qty);
+                features.book_imbalance_ = (bid_qty - ask_qty) / (bid_qty + ask_qty);
+            }
+
+            // Called for a trade on ticker_id's book, whose BBO is bbo. Trades precede the updates removing the liquidity they took,
+            // so bbo still holds the quantity the aggressor traded against.
+            auto onTradeUpdate(const Exchange::MEMarketUpdate* market_update, const BBO* bbo) noexcept {
+                auto& features = ticker_features_[market_update->ticker_id_];
+                auto& state = ticker_state_[market_update->ticker_id_];
+
+                const auto passive_qty = (market_update->side_ == Side::BUY ? bbo->ask_qty_ : bbo->bid_qty_);
+                features.agg_trade_qty_ratio_ = (LIKELY(passive_qty != Qty_INVALID && passive_qty) ?
+                                                 static_cast<double>(market_update->qty_) / passive_qty : Feature_INVALID);
+
+                state.buy_qty_ *= TRADE_FLOW_DECAY;
+                state.sell_qty_ *= TRADE_FLOW_DECAY;
+                (market_update->side_ == Side::BUY ? state.buy_qty_ : state.sell_qty_) += market_update->qty_;
+                features.trade_flow_imbalance_ = (state.buy_qty_ - state.sell_qty_) / (state.buy_qty_ + state.sell_qty_);
+
+                // The trade leaving the window is subtracted from the sums, which are integers so they never drift
+                auto& slot = state.vwap_trades_[state.vwap_next_];
+                const auto notional = market_update->price_ * market_update->qty_;
+                state.vwap_notional_ += notional;
+                state.vwap_notional_ -= slot.notional_;
+                state.vwap_qty_ += market_update->qty_;
+                state.vwap_qty_ -= slot.qty_;
+                slot = {notional, market_update->qty_};
+                state.vwap_next_ = (state.vwap_next_ + 1) % VWAP_WINDOW;
+                features.vwap_ = static_cast<double>(state.vwap_notional_) / state.vwap_qty_;
+            }
+
+            auto features(TickerId ticker_id) const noexcept -> const Features* { return &ticker_features_[ticker_id]; }
+
+            // deleted copy & move constructors and assignment-operators
+            FeatureEngine(const FeatureEngine&) = delete;
+            FeatureEngine(const FeatureEngine&&) = delete;
+            FeatureEngine &operator=(const FeatureEngine&) = delete;
+            FeatureEngine &operator=(const FeatureEngine&&) = delete;
+
+        private:
+            std::array<Features, ME_MAX_TICKERS> ticker_features_{};
+
+            // What the trade features are updated from, kept apart so the Features strategies read stay one cache line
+            struct TickerState {
+                double buy_qty_ = 0;
+                double sell_qty_ = 0;
+
+                struct VWAPTrade {
+                    uint64_t notional_ = 0;
+                    Qty qty_ = 0;
+                };
+                std::array<VWAPTrade, VWAP_WINDOW> vwap_trades_{};
+                size_t vwap_next_ = 0;
+                uint64_t vwap_notional_ = 0;
+                uint64_t vwap_qty_ = 0;
+            };
+            std::array<TickerState, ME_MAX_TICKERS> ticker_state_{};
+    };
+} // namespace Trading
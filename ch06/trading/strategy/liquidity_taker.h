@@ -0,0 +1,48 @@
+#pragma once
+
+#include "common/macros.h"
+#include "common/logging.h"
+
+#include "strategy.h"
+#include "order_manager.h"
+
+namespace Trading
+{
+    // Aggressive liquidity taker. When the FeatureEngine's trade flow imbalance of a configured ticker reaches threshold_ in either
+    // direction, sends clip_ at the opposite side's best price to trade with the flow. Whatever does not fill rests only until the
+    // imbalance falls back below threshold_.
+    class LiquidityTaker final : public Strategy<LiquidityTaker> {
+        public:
+            LiquidityTaker(ClientId client_id, Logger* logger, Exchange::OGWClientRequestLFQueue* client_requests, const FeatureEngine* feature_engine,
+                           const TradeEngineCfgHashMap& ticker_cfg)
+                : Strategy(client_id, logger, feature_engine), ticker_cfg_(ticker_cfg),
+                  order_manager_(client_id, logger, client_requests, ticker_cfg) {
+            }
+
+            auto onTradeUpdateImpl(const Exchange::MEMarketUpdate* market_update, MarketOrderBook* book) noexcept {
+                const auto& cfg = ticker_cfg_[market_update->ticker_id_];
+                if(!cfg.clip_)
+                    return;
+
+                const auto imbalance = feature_engine_->features(market_update->ticker_id_)->trade_flow_imbalance_;
+
+                const auto bbo = book->getBBO();
+                if(imbalance >= cfg.threshold_ && bbo->ask_price_ != Price_INVALID)
+                    order_manager_.moveOrders(market_update->ticker_id_, bbo->ask_price_, Price_INVALID, cfg.clip_);
+                else if(imbalance <= -cfg.threshold_ && bbo->bid_price_ != Price_INVALID)
+                    order_manager_.moveOrders(market_update->ticker_id_, Price_INVALID, bbo->bid_price_, cfg.clip_);
+                else
+                    order_manager_.moveOrders(market_update->ticker_id_, Price_INVALID, Price_INVALID, cfg.clip_);
+            }
+
+            auto onOrderUpdateImpl(const Exchange::MEClientResponse* client_response) noexcept {
+                order_manager_.onOrderUpdate(client_response);
+            }
+
+            auto orderManager() const noexcept -> const OrderManager* { return &order_manager_; }
+
+        private:
+            const TradeEngineCfgHashMap ticker_cfg_;
+            OrderManager order_manager_;
+    };
+} // namespace Trading
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "common/macros.h"
+#include "common/logging.h"
+
+#include "strategy.h"
+#include "order_manager.h"
+
+namespace Trading
+{
+    // Passive market maker. Quotes clip_ on both sides of every configured ticker at the best bid and offer, and backs a side off
+    // by a tick when the fair price is less than threshold_ ticks away from it, so it only joins the side the fair price leaves edge on.
+    // The fair price is the FeatureEngine's weighted mid.
+    class MarketMaker final : public Strategy<MarketMaker> {
+        public:
+            MarketMaker(ClientId client_id, Logger* logger, Exchange::OGWClientRequestLFQueue* client_requests, const FeatureEngine* feature_engine,
+                        const TradeEngineCfgHashMap& ticker_cfg)
+                : Strategy(client_id, logger, feature_engine), ticker_cfg_(ticker_cfg),
+                  order_manager_(client_id, logger, client_requests, ticker_cfg) {
+            }
+
+            auto onOrderBookUpdateImpl(TickerId ticker_id, Price, Side, MarketOrderBook* book) noexcept {
+                const auto& cfg = ticker_cfg_[ticker_id];
+                if(!cfg.clip_)
+                    return;
+
+                // Invalid unless both sides of the book have orders
+                const auto fair_price = feature_engine_->features(ticker_id)->weighted_mid_;
+                if(UNLIKELY(std::isnan(fair_price))) {
+                    order_manager_.moveOrders(ticker_id, Price_INVALID, Price_INVALID, cfg.clip_);
+                    return;
+                }
+
+                const auto bbo = book->getBBO();
+                const auto bid_price = bbo->bid_price_ - (fair_price - bbo->bid_price_ >= cfg.threshold_ ? 0 : 1);
+                const auto ask_price = bbo->ask_price_ + (bbo->ask_price_ - fair_price >= cfg.threshold_ ? 0 : 1);
+
+                order_manager_.moveOrders(ticker_id, bid_price, ask_price, cfg.clip_);
+            }
+
+            auto onOrderUpdateImpl(const Exchange::MEClientResponse* client_response) noexcept {
+                order_manager_.onOrderUpdate(client_response);
+            }
+
+            auto orderManager() const noexcept -> const OrderManager* { return &order_manager_; }
+
+        private:
+            const TradeEngineCfgHashMap ticker_cfg_;
+            OrderManager order_manager_;
+    };
+} // namespace Trading
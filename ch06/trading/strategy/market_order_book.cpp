@@ -1,49 +1,50 @@
 #include "market_order_book.h"
-#include "trade_engine.h"
 
 namespace Trading
 {
     MarketOrderBook::MarketOrderBook(TickerId ticker_id, Logger* logger)
     : ticker_id_(ticker_id), orders_at_price_pool_(ME_MAX_PRICE_LEVELS),
-    order_pool_(ME_MAX_ORDER_IDS), logger_(logger) {{
-
-    }}
+    order_pool_(ME_MAX_ORDER_IDS), logger_(logger) {
+        oid_to_order_.fill(nullptr);
+        price_orders_at_price_.fill(nullptr);
+    }
 
     MarketOrderBook::~MarketOrderBook() {
         logger_->log("%:% %() % Orderbook\n%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), toString(false, true));
 
-        trade_engine_ = nullptr;
         bids_by_price_ = asks_by_price_ = nullptr;
         oid_to_order_.fill(nullptr);
     }
 
-    auto MarketOrderBook::onMarketUpdate(const Exchange::MEMarketUpdate* market_update) noexcept -> void {
-        const auto bid_updated = (bids_by_price_ && market_update->side_ == Side::BUY && market_update->price_ >= bids_by_price_->price_);
-        const auto ask_updated = (asks_by_price_ && market_update->side_ == Side::SELL && market_update->price_ >= asks_by_price_->price_);
+    auto MarketOrderBook::onMarketUpdate(const Exchange::MEMarketUpdate* market_update) noexcept -> bool {
+        const auto bid_updated = (market_update->side_ == Side::BUY && (!bids_by_price_ || market_update->price_ >= bids_by_price_->price_));
+        const auto ask_updated = (market_update->side_ == Side::SELL && (!asks_by_price_ || market_update->price_ <= asks_by_price_->price_));
 
         switch (market_update->type_)
         {
-        case Exchange::MarketUpdateType::ADD:
+        case Exchange::MarketUpdateType::ADD: {
             auto order = order_pool_.allocate(market_update->order_id_, market_update->side_, market_update->price_,
                                                 market_update->qty_, market_update->priority_, nullptr, nullptr);
             addOrder(order);
+        }
             break;
         
-        case Exchange::MarketUpdateType::MODIFY:
+        case Exchange::MarketUpdateType::MODIFY: {
             auto order = oid_to_order_.at(market_update->order_id_);
             order->qty_ = market_update->qty_;
+        }
             break;
         
-        case Exchange::MarketUpdateType::CANCEL:
+        case Exchange::MarketUpdateType::CANCEL: {
             auto order = oid_to_order_.at(market_update->order_id_);
             removeOrder(order);
+        }
             break;
 
         case Exchange::MarketUpdateType::TRADE:
-            trade_engine_->onTradeUpdate(market_update, this);
-            return;
+            return false;
         
-        case Exchange::MarketUpdateType::CLEAR:
+        case Exchange::MarketUpdateType::CLEAR: {
             for(auto& order: oid_to_order_)
                 if(order)
                     order_pool_.deallocate(order);
@@ -51,36 +52,43 @@ namespace Trading
 
             if (bids_by_price_)
             {
-                for(auto bid = bids_by_price_->next_entry_; bid != bids_by_price_; bid->next_entry_)
+                for(auto bid = bids_by_price_->next_entry_; bid != bids_by_price_;) {
+                    const auto next_bid = bid->next_entry_;
                     orders_at_price_pool_.deallocate(bid);
+                    bid = next_bid;
+                }
                 orders_at_price_pool_.deallocate(bids_by_price_);
             }
             
             if (asks_by_price_)
             {
-                for(auto ask = asks_by_price_->next_entry_; ask != asks_by_price_; ask->next_entry_)
+                for(auto ask = asks_by_price_->next_entry_; ask != asks_by_price_;) {
+                    const auto next_ask = ask->next_entry_;
                     orders_at_price_pool_.deallocate(ask);
+                    ask = next_ask;
+                }
                 orders_at_price_pool_.deallocate(asks_by_price_);
             }
 
             bids_by_price_ = asks_by_price_ = nullptr;
-
+            price_orders_at_price_.fill(nullptr);
+        }
             break;
         
         case Exchange::MarketUpdateType::INVALID:
         case Exchange::MarketUpdateType::SNAPSHOT_START:
         case Exchange::MarketUpdateType::SNAPSHOT_END:
             break;
-
-        default:
-            break;
         }
 
         updateBBO(bid_updated, ask_updated);
 
-        logger_->log("%:% %() % % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), market_update->toString(), bbo_.toString());
-        
-        trade_engine_->onOrderBookUpdate(market_update->ticker_id_, market_update->price_, market_update->side_, this);
+        // Fields are logged as they are, formatting them to strings would allocate on every update
+        logger_->log("%:% %() % type:% ticker:% oid:% side:% price:% qty:% bbo:%@%X%@%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            static_cast<int>(market_update->type_), market_update->ticker_id_, market_update->order_id_, static_cast<int>(market_update->side_),
+            market_update->price_, market_update->qty_, bbo_.bid_qty_, bbo_.bid_price_, bbo_.ask_qty_, bbo_.ask_price_);
+
+        return true;
     }
 
     auto MarketOrderBook::toString(bool detailed, bool validity_check) const -> std::string {
@@ -120,7 +128,7 @@ namespace Trading
             ss << std::endl;
 
             if(sanity_check) {
-                if((side == Side::SELL && itr->price_ >= last_price) || (side == Side::BUY && itr->price_ <= last_price)) {
+                if((side == Side::SELL && itr->price_ <= last_price) || (side == Side::BUY && itr->price_ >= last_price)) {
                     FATAL("Bids/Asks are not sorted by ascending/descending prices last:" + priceToString(last_price) + " itr:" + itr->toString());
                 }
 
@@ -9,18 +9,14 @@
 
 namespace Trading
 {
-    class TradeEngine;
-
     class MarketOrderBook final {
         public:
             MarketOrderBook(TickerId ticker_id, Logger* logger);
             ~MarketOrderBook();
 
-            auto onMarketUpdate(const Exchange::MEMarketUpdate* market_update) noexcept -> void;
-
-            auto setTradeEngine(TradeEngine* trade_engine) {
-                trade_engine_ = trade_engine;
-            }
+            // Apply market_update to the book, false for trades, which do not modify it. The caller forwards the event to the trading
+            // algorithm, so the book does not need to know its owner's type.
+            auto onMarketUpdate(const Exchange::MEMarketUpdate* market_update) noexcept -> bool;
 
             auto updateBBO(bool update_bid, bool update_ask) noexcept {
                 if (update_bid)
@@ -64,7 +60,6 @@ namespace Trading
         
         private:
             const TickerId ticker_id_;
-            TradeEngine* trade_engine_;
             OrderHashMap oid_to_order_;
             MemPool<MarketOrdersAtPrice> orders_at_price_pool_;
             MarketOrdersAtPrice* bids_by_price_ = nullptr;
@@ -125,8 +120,8 @@ namespace Trading
                         target->prev_entry_->next_entry_ = new_orders_at_price;
                         target->prev_entry_ = new_orders_at_price;
 
-                        if((new_orders_at_price->side_ == Side::SELL && new_orders_at_price->price_ > best_orders_by_price->price_) ||
-                                    (new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ < best_orders_by_price->price_)) {
+                        if((new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ > best_orders_by_price->price_) ||
+                                    (new_orders_at_price->side_ == Side::SELL && new_orders_at_price->price_ < best_orders_by_price->price_)) {
                             target->next_entry_ = (target->next_entry_ ==  best_orders_by_price ? new_orders_at_price : target->next_entry_);
                             (new_orders_at_price->side_ == Side::BUY ? bids_by_price_ : asks_by_price_) = new_orders_at_price; 
                         }
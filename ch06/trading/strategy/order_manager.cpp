@@ -0,0 +1,73 @@
+#include "order_manager.h"
+
+namespace Trading
+{
+    auto OrderManager::onOrderUpdate(const Exchange::MEClientResponse* client_response) noexcept -> void {
+        if(UNLIKELY(client_response->ticker_id_ >= ME_MAX_TICKERS))
+            return;
+        // Cancel rejects carry no side, the order is found by its id instead
+        auto& side_order = ticker_side_order_[client_response->ticker_id_];
+        auto order = (client_response->side_ != Side::INVALID ? &side_order[sideToIndex(client_response->side_)] :
+                      side_order[sideToIndex(Side::BUY)].order_id_ == client_response->client_order_id_ ? &side_order[sideToIndex(Side::BUY)] :
+                      &side_order[sideToIndex(Side::SELL)]);
+        if(UNLIKELY(order->order_id_ != client_response->client_order_id_))
+            return;
+
+        switch (client_response->type_)
+        {
+        case Exchange::ClientResponseType::ACCEPTED:
+            order->order_state_ = OMOrderState::LIVE;
+            break;
+
+        case Exchange::ClientResponseType::CANCELED:
+            order->order_state_ = OMOrderState::DEAD;
+            break;
+
+        case Exchange::ClientResponseType::FILLED:
+            ticker_position_[client_response->ticker_id_] += sideToValue(client_response->side_) * static_cast<int64_t>(client_response->exec_qty_);
+            order->qty_ = client_response->leaves_qty_;
+            if(!order->qty_)
+                order->order_state_ = OMOrderState::DEAD;
+            break;
+
+        // The order was filled before the cancel reached the exchange, its fills have already been processed
+        case Exchange::ClientResponseType::CANCEL_REJECTED:
+            if(order->order_state_ == OMOrderState::PENDING_CANCEL)
+                order->order_state_ = OMOrderState::DEAD;
+            break;
+
+        case Exchange::ClientResponseType::INVALID:
+            break;
+        }
+
+        logger_->log("%:% %() % type:% ticker:% oid:% side:% price:% exec:% leaves:% state:% position:%\n", __FILE__, __LINE__, __FUNCTION__,
+            Common::getCurrentTimeStr(&time_str_), static_cast<int>(client_response->type_), client_response->ticker_id_, client_response->client_order_id_,
+            static_cast<int>(client_response->side_), client_response->price_, client_response->exec_qty_, client_response->leaves_qty_,
+            static_cast<int>(order->order_state_), ticker_position_[client_response->ticker_id_]);
+    }
+
+    auto OrderManager::newOrder(OMOrder* order, TickerId ticker_id, Price price, Side side, Qty qty) noexcept -> void {
+        client_request_ = {Exchange::ClientRequestType::NEW, client_id_, ticker_id, next_order_id_, side, price, qty};
+        sendClientRequest();
+
+        *order = {ticker_id, next_order_id_, side, price, qty, OMOrderState::PENDING_NEW};
+        next_order_id_ = (next_order_id_ + 1 < ME_MAX_ORDER_IDS ? next_order_id_ + 1 : 1);
+    }
+
+    auto OrderManager::cancelOrder(OMOrder* order) noexcept -> void {
+        client_request_ = {Exchange::ClientRequestType::CANCEL, client_id_, order->ticker_id_, order->order_id_, order->side_, order->price_, order->qty_};
+        sendClientRequest();
+
+        order->order_state_ = OMOrderState::PENDING_CANCEL;
+    }
+
+    auto OrderManager::sendClientRequest() noexcept -> void {
+        logger_->log("%:% %() % Sending type:% ticker:% oid:% side:% price:% qty:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            static_cast<int>(client_request_.type_), client_request_.ticker_id_, client_request_.order_id_, static_cast<int>(client_request_.side_),
+            client_request_.price_, client_request_.qty_);
+
+        auto next_write = outgoing_ogw_requests_->getNextToWriteTo();
+        *next_write = {client_request_};
+        outgoing_ogw_requests_->updateWriteIndex();
+    }
+} // namespace Trading
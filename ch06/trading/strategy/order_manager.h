@@ -0,0 +1,93 @@
+#pragma once
+
+#include "common/macros.h"
+#include "common/logging.h"
+
+#include "exchange/order_server/client_request.h"
+#include "exchange/order_server/client_response.h"
+
+#include "om_order.h"
+#include "strategy.h"
+
+namespace Trading
+{
+    // Keeps at most one order per side per ticker for a trading algorithm and moves it to the prices the algorithm asks for.
+    // Requests are only sent when an order has to change: a live order at the requested price is left alone, and nothing is sent
+    // for an order while a request for it awaits the exchange's response, so repeated signals never cause redundant cancel/new traffic.
+    // Tracks the position of every ticker from its fills and never sends an order which could take it past the ticker's max_position_.
+    class OrderManager final {
+        public:
+            OrderManager(ClientId client_id, Logger* logger, Exchange::OGWClientRequestLFQueue* client_requests, const TradeEngineCfgHashMap& ticker_cfg)
+                : client_id_(client_id), ticker_cfg_(ticker_cfg), outgoing_ogw_requests_(client_requests), logger_(logger) {
+            }
+
+            // Update the order a response of the exchange is for, responses for orders this manager did not send are ignored
+            auto onOrderUpdate(const Exchange::MEClientResponse* client_response) noexcept -> void;
+
+            // Move the orders of ticker_id to bid_price and ask_price, Price_INVALID takes a side out of the market
+            auto moveOrders(TickerId ticker_id, Price bid_price, Price ask_price, Qty clip) noexcept {
+                moveOrder(&ticker_side_order_.at(ticker_id).at(sideToIndex(Side::BUY)), ticker_id, bid_price, Side::BUY, clip);
+                moveOrder(&ticker_side_order_.at(ticker_id).at(sideToIndex(Side::SELL)), ticker_id, ask_price, Side::SELL, clip);
+            }
+
+            auto getOMOrderSideHashMap(TickerId ticker_id) const noexcept -> const OMOrderSideHashMap* {
+                return &ticker_side_order_.at(ticker_id);
+            }
+
+            // Signed position of ticker_id, positive when long
+            auto position(TickerId ticker_id) const noexcept { return ticker_position_.at(ticker_id); }
+
+            // deleted default, copy & move constructors and assignment-operators
+            OrderManager() = delete;
+            OrderManager(const OrderManager&) = delete;
+            OrderManager(const OrderManager&&) = delete;
+            OrderManager &operator=(const OrderManager&) = delete;
+            OrderManager &operator=(const OrderManager&&) = delete;
+
+        private:
+            const ClientId client_id_;
+            const TradeEngineCfgHashMap ticker_cfg_;
+
+            OMOrderTickerSideHashMap ticker_side_order_;
+            std::array<int64_t, ME_MAX_TICKERS> ticker_position_{};
+
+            // Client order ids only need to be unique among this client's live orders, so they wrap below ME_MAX_ORDER_IDS
+            OrderId next_order_id_ = 1;
+
+            Exchange::OGWClientRequestLFQueue* outgoing_ogw_requests_ = nullptr;
+            Exchange::MEClientRequest client_request_;
+
+            std::string time_str_;
+            Logger* logger_ = nullptr;
+
+            auto moveOrder(OMOrder* order, TickerId ticker_id, Price price, Side side, Qty qty) noexcept -> void {
+                switch (order->order_state_)
+                {
+                case OMOrderState::LIVE:
+                    if(order->price_ != price)
+                        cancelOrder(order);
+                    break;
+
+                case OMOrderState::INVALID:
+                case OMOrderState::DEAD:
+                    if(LIKELY(price != Price_INVALID) && checkPosition(ticker_id, side, qty))
+                        newOrder(order, ticker_id, price, side, qty);
+                    break;
+
+                case OMOrderState::PENDING_NEW:
+                case OMOrderState::PENDING_CANCEL:
+                    break;
+                }
+            }
+
+            // Whether a fill of qty on side keeps the position of ticker_id within its limit
+            auto checkPosition(TickerId ticker_id, Side side, Qty qty) const noexcept -> bool {
+                const auto position = ticker_position_[ticker_id] + sideToValue(side) * static_cast<int64_t>(qty);
+                return std::abs(position) <= static_cast<int64_t>(ticker_cfg_[ticker_id].max_position_);
+            }
+
+            auto newOrder(OMOrder* order, TickerId ticker_id, Price price, Side side, Qty qty) noexcept -> void;
+            auto cancelOrder(OMOrder* order) noexcept -> void;
+            auto sendClientRequest() noexcept -> void;
+    };
+} // namespace Trading
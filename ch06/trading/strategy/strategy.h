@@ -0,0 +1,113 @@
+#pragma once
+
+#include "common/macros.h"
+#include "common/logging.h"
+#include "common/types.h"
+
+#include "exchange/market_data/market_update.h"
+#include "exchange/order_server/client_request.h"
+#include "exchange/order_server/client_response.h"
+
+#include "market_order_book.h"
+#include "feature_engine.h"
+
+namespace Trading
+{
+    // Per ticker parameters of the trading algorithms, a ticker with a zero clip_ is not traded
+    struct TradeEngineCfg {
+        Qty clip_ = 0;             // size of every order sent
+        double threshold_ = 0;     // signal level the algorithm acts at, its meaning is up to the algorithm
+        Qty max_position_ = 0;     // orders which could take the absolute position past this are not sent
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "TradeEngineCfg{"
+               << "clip:" << qtyToString(clip_) << " "
+               << "thresh:" << threshold_ << " "
+               << "max-pos:" << qtyToString(max_position_)
+               << "}";
+
+            return ss.str();
+        }
+    };
+
+    typedef std::array<TradeEngineCfg, ME_MAX_TICKERS> TradeEngineCfgHashMap;
+
+    // CRTP base of the trading algorithms. TradeEngine<StrategyT> calls these hooks on the concrete StrategyT, which forward to its
+    // *Impl() methods, so the path from a market update to the requests it causes is resolved at compile time and inlined, with no
+    // virtual or std::function calls. StrategyT derives from Strategy<StrategyT> and defines the *Impl() hooks it reacts to,
+    // the ones it does not define fall back to the defaults here, which ignore the event. Strategies which trade send their requests
+    // through an OrderManager of their own, constructed from the request queue TradeEngine passes to every StrategyT.
+    template<typename StrategyT>
+    class Strategy {
+        public:
+            // Called after an order book update has been applied to book
+            auto onOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook* book) noexcept {
+                static_cast<StrategyT*>(this)->onOrderBookUpdateImpl(ticker_id, price, side, book);
+            }
+
+            // Called for a trade on book, trades do not modify the book
+            auto onTradeUpdate(const Exchange::MEMarketUpdate* market_update, MarketOrderBook* book) noexcept {
+                static_cast<StrategyT*>(this)->onTradeUpdateImpl(market_update, book);
+            }
+
+            // Called for every response to this client's requests
+            auto onOrderUpdate(const Exchange::MEClientResponse* client_response) noexcept {
+                static_cast<StrategyT*>(this)->onOrderUpdateImpl(client_response);
+            }
+
+            auto clientId() const noexcept { return client_id_; }
+
+            // deleted default, copy & move constructors and assignment-operators
+            Strategy() = delete;
+            Strategy(const Strategy&) = delete;
+            Strategy(const Strategy&&) = delete;
+            Strategy &operator=(const Strategy&) = delete;
+            Strategy &operator=(const Strategy&&) = delete;
+
+        protected:
+            Strategy(ClientId client_id, Logger* logger, const FeatureEngine* feature_engine)
+                : client_id_(client_id), logger_(logger), feature_engine_(feature_engine) {
+            }
+
+            ~Strategy() = default;
+
+            auto onOrderBookUpdateImpl(TickerId, Price, Side, MarketOrderBook*) noexcept {}
+            auto onTradeUpdateImpl(const Exchange::MEMarketUpdate*, MarketOrderBook*) noexcept {}
+            auto onOrderUpdateImpl(const Exchange::MEClientResponse*) noexcept {}
+
+            const ClientId client_id_;
+            Logger* logger_ = nullptr;
+            std::string time_str_;
+
+            // Signals of every ticker, already updated for the event a hook is called for
+            const FeatureEngine* feature_engine_ = nullptr;
+    };
+
+    // Logs every event and never trades, what a client runs to watch the market
+    class LoggingStrategy final : public Strategy<LoggingStrategy> {
+        public:
+            LoggingStrategy(ClientId client_id, Logger* logger, Exchange::OGWClientRequestLFQueue*, const FeatureEngine* feature_engine)
+                : Strategy(client_id, logger, feature_engine) {
+            }
+
+            auto onOrderBookUpdateImpl(TickerId ticker_id, Price price, Side side, MarketOrderBook* book) noexcept {
+                const auto bbo = book->getBBO();
+                const auto features = feature_engine_->features(ticker_id);
+                logger_->log("%:% %() % ticker:% price:% side:% bbo:%@%X%@% wmid:% imbalance:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                             ticker_id, price, static_cast<int>(side), bbo->bid_qty_, bbo->bid_price_, bbo->ask_qty_, bbo->ask_price_,
+                             features->weighted_mid_, features->book_imbalance_);
+            }
+
+            auto onTradeUpdateImpl(const Exchange::MEMarketUpdate* market_update, MarketOrderBook*) noexcept {
+                const auto features = feature_engine_->features(market_update->ticker_id_);
+                logger_->log("%:% %() % ticker:% side:% price:% qty:% agg-ratio:% flow:% vwap:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                             market_update->ticker_id_, static_cast<int>(market_update->side_), market_update->price_, market_update->qty_,
+                             features->agg_trade_qty_ratio_, features->trade_flow_imbalance_, features->vwap_);
+            }
+
+            auto onOrderUpdateImpl(const Exchange::MEClientResponse* client_response) noexcept {
+                logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), client_response->toString());
+            }
+    };
+} // namespace Trading
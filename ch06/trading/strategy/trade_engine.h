@@ -0,0 +1,134 @@
+#pragma once
+
+#include "common/macros.h"
+#include "common/logging.h"
+#include "common/types.h"
+#include "common/thread_utils.h"
+
+#include "exchange/market_data/market_update.h"
+#include "exchange/order_server/client_request.h"
+#include "exchange/order_server/client_response.h"
+
+#include "market_order_book.h"
+#include "feature_engine.h"
+#include "strategy.h"
+
+namespace Trading
+{
+    // Event loop of a trading client. Busy-polls the market updates from MarketDataConsumer and the client responses from OrderGateway,
+    // applies market updates to the MarketOrderBook of their ticker and the resulting BBO and trades to the FeatureEngine, then forwards
+    // the order book, trade and order events to the Strategy<StrategyT> it owns, which sends its requests to OrderGateway.
+    // Templated on the strategy so its hooks are inlined into the loop. Everything the loop needs is created up front.
+    template<typename StrategyT>
+    class TradeEngine final {
+        public:
+            // strategy_args are passed to the StrategyT constructor after its client id, logger, request queue and feature engine
+            template<typename... StrategyArgs>
+            TradeEngine(ClientId client_id, Exchange::OGWClientRequestLFQueue* client_requests, Exchange::ClientResponseLFQueue* client_responses,
+                        Exchange::MDCMarketUpdateLFQueue* market_updates, StrategyArgs&&... strategy_args)
+                : client_id_(client_id), incoming_ogw_responses_(client_responses), incoming_md_updates_(market_updates),
+                  logger_("trading_engine_" + std::to_string(client_id) + ".log"),
+                  strategy_(client_id, &logger_, client_requests, &feature_engine_, std::forward<StrategyArgs>(strategy_args)...) {
+                for(size_t ticker_id = 0; ticker_id < ticker_order_book_.size(); ++ticker_id)
+                    ticker_order_book_[ticker_id] = new MarketOrderBook(ticker_id, &logger_);
+            }
+
+            ~TradeEngine() {
+                run_ = false;
+
+                using namespace std::literals::chrono_literals;
+                std::this_thread::sleep_for(1s);
+
+                for(auto& order_book: ticker_order_book_) {
+                    delete order_book;
+                    order_book = nullptr;
+                }
+            }
+
+            // Run the event loop on its own thread, pinned to core_id unless it is negative
+            auto start(int core_id = -1) -> void {
+                run_ = true;
+                ASSERT(Common::createAndStartThread(core_id, "Trading/TradeEngine", [this]() { run(); }) != nullptr, "Failed to start TradeEngine thread.");
+            }
+
+            auto stop() -> void {
+                while(incoming_ogw_responses_->size() || incoming_md_updates_->size()) {
+                    logger_.log("%:% %() % Sleeping till all updates are consumed ogw-size:% md-size:%\n", __FILE__, __LINE__, __FUNCTION__,
+                        Common::getCurrentTimeStr(&time_str_), incoming_ogw_responses_->size(), incoming_md_updates_->size());
+
+                    using namespace std::literals::chrono_literals;
+                    std::this_thread::sleep_for(10ms);
+                }
+                run_ = false;
+            }
+
+            // Main loop, order responses are drained before market updates so the strategy sees its own fills before the trades they caused
+            auto run() noexcept -> void {
+                logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+
+                while(run_) {
+                    for(auto client_response = incoming_ogw_responses_->getNextToRead(); client_response; client_response = incoming_ogw_responses_->getNextToRead()) {
+                        strategy_.onOrderUpdate(client_response);
+                        incoming_ogw_responses_->updateReadIndex();
+                        last_event_time_ = Common::getCurrentNanos();
+                    }
+
+                    for(auto md_update = incoming_md_updates_->getNextToRead(); md_update; md_update = incoming_md_updates_->getNextToRead()) {
+                        const auto market_update = &md_update->me_market_update_;
+                        if(LIKELY(market_update->ticker_id_ < ticker_order_book_.size())) {
+                            auto book = ticker_order_book_[market_update->ticker_id_];
+                            if(book->onMarketUpdate(market_update)) {
+                                feature_engine_.onOrderBookUpdate(market_update->ticker_id_, book->getBBO());
+                                strategy_.onOrderBookUpdate(market_update->ticker_id_, market_update->price_, market_update->side_, book);
+                            } else {
+                                feature_engine_.onTradeUpdate(market_update, book->getBBO());
+                                strategy_.onTradeUpdate(market_update, book);
+                            }
+                        }
+                        incoming_md_updates_->updateReadIndex();
+                        last_event_time_ = Common::getCurrentNanos();
+                    }
+                }
+            }
+
+            auto clientId() const noexcept { return client_id_; }
+
+            auto orderBook(TickerId ticker_id) const noexcept { return ticker_order_book_.at(ticker_id); }
+
+            auto strategy() noexcept -> StrategyT* { return &strategy_; }
+
+            auto featureEngine() const noexcept -> const FeatureEngine* { return &feature_engine_; }
+
+            // Time of the last event the loop processed, so owners can tell when the market has gone quiet
+            auto lastEventTime() const noexcept { return last_event_time_; }
+
+            // deleted default, copy & move constructors and assignment-operators
+            TradeEngine() = delete;
+            TradeEngine(const TradeEngine&) = delete;
+            TradeEngine(const TradeEngine&&) = delete;
+            TradeEngine &operator=(const TradeEngine&) = delete;
+            TradeEngine &operator=(const TradeEngine&&) = delete;
+
+        private:
+            const ClientId client_id_;
+
+            // One book per ticker, market updates for any other ticker are dropped
+            MarketOrderBookHashMap ticker_order_book_{};
+
+            // Responses from OrderGateway and market updates from MarketDataConsumer, requests are queued by the strategy
+            Exchange::ClientResponseLFQueue* incoming_ogw_responses_ = nullptr;
+            Exchange::MDCMarketUpdateLFQueue* incoming_md_updates_ = nullptr;
+
+            volatile bool run_ = false;
+            volatile Nanos last_event_time_ = 0;
+
+            std::string time_str_;
+            Logger logger_;
+
+            // Updated before every strategy hook, so the strategy reads the features of the event it is handling
+            FeatureEngine feature_engine_;
+
+            // Constructed after logger_ and feature_engine_, which it uses
+            StrategyT strategy_;
+    };
+} // namespace Trading
@@ -0,0 +1,118 @@
+#include <csignal>
+
+#include "strategy/trade_engine.h"
+#include "strategy/market_maker.h"
+#include "strategy/liquidity_taker.h"
+#include "order_gw/order_gateway.h"
+#include "market_data/market_data_consumer.h"
+
+Common::Logger* logger = nullptr;
+Trading::MarketDataConsumer* market_data_consumer = nullptr;
+Trading::OrderGateway* order_gateway = nullptr;
+
+// Run MarketDataConsumer, OrderGateway and a TradeEngine running StrategyT till the market has been quiet for duration_secs
+template<typename StrategyT, typename... StrategyArgs>
+auto runClient(ClientId client_id, size_t duration_secs, int core_id, int retransmit_port, StrategyArgs&&... strategy_args) {
+    const int sleep_time = 20 * 1000;
+    Exchange::OGWClientRequestLFQueue client_requests(ME_MAX_CLIENT_UPDATES);
+    Exchange::ClientResponseLFQueue client_responses(ME_MAX_CLIENT_UPDATES);
+    Exchange::MDCMarketUpdateLFQueue market_updates(ME_MAX_MARKET_UPDATES);
+
+    std::string time_str;
+    logger->log("%:% %() % Starting Trade Engine client:% core:%...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str), client_id, core_id);
+    auto trade_engine = new Trading::TradeEngine<StrategyT>(client_id, &client_requests, &client_responses, &market_updates,
+                                                            std::forward<StrategyArgs>(strategy_args)...);
+    trade_engine->start(core_id);
+
+    const std::string order_gw_ip = "127.0.0.1";
+    const std::string order_gw_iface = "lo";
+    const int order_gw_port = 12345;
+
+    logger->log("%:% %() % Starting Order Gateway...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
+    order_gateway = new Trading::OrderGateway(client_id, &client_requests, &client_responses, order_gw_ip, order_gw_iface, order_gw_port);
+    order_gateway->start();
+
+    const std::string mkt_data_iface = "lo";
+    const std::string snapshot_ip = "233.252.14.1", incremental_ip = "233.252.14.3", retransmit_ip = "127.0.0.1";
+    const int snapshot_port = 20000, incremental_port = 20001;
+
+    logger->log("%:% %() % Starting Market Data Consumer...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
+    market_data_consumer = new Trading::MarketDataConsumer(client_id, &market_updates, mkt_data_iface, snapshot_ip, snapshot_port,
+                                                           incremental_ip, incremental_port, "", 0, retransmit_ip, retransmit_port);
+    market_data_consumer->start();
+
+    const auto start_time = Common::getCurrentNanos();
+    while(std::max(start_time, static_cast<Nanos>(trade_engine->lastEventTime())) + static_cast<Nanos>(duration_secs) * NANOS_TO_SECS > Common::getCurrentNanos()) {
+        logger->log("%:% %() % Waiting till no activity, been silent for % seconds...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str),
+                    (Common::getCurrentNanos() - std::max(start_time, static_cast<Nanos>(trade_engine->lastEventTime()))) / NANOS_TO_SECS);
+        usleep(sleep_time * 1000);
+    }
+
+    trade_engine->stop();
+    market_data_consumer->stop();
+    order_gateway->stop();
+
+    using namespace std::literals::chrono_literals;
+    std::this_thread::sleep_for(10s);
+
+    delete trade_engine; trade_engine = nullptr;
+    delete market_data_consumer; market_data_consumer = nullptr;
+    delete order_gateway; order_gateway = nullptr;
+}
+
+// Run next to exchange_main, e.g. exchange_main & trading_main --client-id 11 --algo maker & trading_main --client-id 12 --algo taker & load_generator
+// --client-id ID identifies this client to the exchange, --duration SECS stops it once the market has been quiet that long.
+// --core CORE pins the TradeEngine thread, --retransmit-port PORT (0 recovers every gap from a snapshot) sets the gap fill service.
+// --algo log|maker|taker picks the strategy, the LoggingStrategy, MarketMaker or LiquidityTaker, which trades every ticker with
+// --clip QTY, --threshold VALUE and --max-position QTY. Several makers and takers on their own client ids drive a realistic order flow.
+int main(int argc, char** argv) {
+    ClientId client_id = 1;
+    size_t duration_secs = 60;
+    int core_id = -1;
+    int retransmit_port = 12346;
+    std::string algo = "log";
+    Trading::TradeEngineCfg cfg{10, 0.6, 1000};
+    for(int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if(arg == "--client-id" && i + 1 < argc)
+            client_id = strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--duration" && i + 1 < argc)
+            duration_secs = strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--core" && i + 1 < argc)
+            core_id = atoi(argv[++i]);
+        else if(arg == "--retransmit-port" && i + 1 < argc)
+            retransmit_port = atoi(argv[++i]);
+        else if(arg == "--algo" && i + 1 < argc)
+            algo = argv[++i];
+        else if(arg == "--clip" && i + 1 < argc)
+            cfg.clip_ = strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--threshold" && i + 1 < argc)
+            cfg.threshold_ = atof(argv[++i]);
+        else if(arg == "--max-position" && i + 1 < argc)
+            cfg.max_position_ = strtoul(argv[++i], nullptr, 10);
+    }
+    ASSERT(client_id < ME_MAX_NUM_CLIENTS, "ClientId must be below ME_MAX_NUM_CLIENTS:" + std::to_string(ME_MAX_NUM_CLIENTS));
+
+    logger = new Common::Logger("trading_main_" + std::to_string(client_id) + ".log");
+
+    Trading::TradeEngineCfgHashMap ticker_cfg;
+    ticker_cfg.fill(cfg);
+
+    std::string time_str;
+    logger->log("%:% %() % algo:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str), algo, cfg.toString());
+    if(algo == "maker")
+        runClient<Trading::MarketMaker>(client_id, duration_secs, core_id, retransmit_port, ticker_cfg);
+    else if(algo == "taker")
+        runClient<Trading::LiquidityTaker>(client_id, duration_secs, core_id, retransmit_port, ticker_cfg);
+    else if(algo == "log")
+        runClient<Trading::LoggingStrategy>(client_id, duration_secs, core_id, retransmit_port);
+    else
+        FATAL("Unknown --algo:" + algo + ", expected log, maker or taker");
+
+    delete logger; logger = nullptr;
+
+    using namespace std::literals::chrono_literals;
+    std::this_thread::sleep_for(10s);
+
+    exit(EXIT_SUCCESS);
+}